@@ -4,12 +4,25 @@
 #include "Breakable/BreakableActor.h"
 #include "GeometryCollection\GeometryCollectionComponent.h"
 #include "Items\Treasure.h"
+#include "Items/LootSubsystem.h"
 #include "Components\CapsuleComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Loading/AssetPreloadSubsystem.h"
+#include "Breakable/DestructionBudgetSubsystem.h"
+#include "GeometryCollection/GeometryCollection.h"
+#include "GeometryCollection/GeometryCollectionObject.h"
+#include "Persistence/WorldStateSubsystem.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 ABreakableActor::ABreakableActor()
 {
 	PrimaryActorTick.bCanEverTick = false;
 
+	// Nothing changes until the actor breaks, so it sleeps from level load and is only flushed once, when it does.
+	bReplicates = true;
+	NetDormancy = DORM_Initial;
+
 	GeometryCollection = CreateDefaultSubobject<UGeometryCollectionComponent>(TEXT("Geometry Collection"));
 	SetRootComponent(GeometryCollection);
 
@@ -26,11 +39,32 @@ ABreakableActor::ABreakableActor()
 void ABreakableActor::BeginPlay()
 {
 	Super::BeginPlay();
+
+	FullClusterLevel = GeometryCollection->MaxClusterLevel;
+
+	if (!bBroken && ProxyStaticMesh && !FracturedCollection.IsNull())
+		EnterProxyMode();
+
+	if (UDestructionBudgetSubsystem* DestructionBudget = UDestructionBudgetSubsystem::Get(this))
+		DestructionBudget->Register(this);
 }
 
-void ABreakableActor::Tick(float DeltaTime)
+void ABreakableActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	if (UDestructionBudgetSubsystem* DestructionBudget = UDestructionBudgetSubsystem::Get(this))
+		DestructionBudget->Unregister(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ABreakableActor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(ABreakableActor, bBroken, Params);
 }
 
 void ABreakableActor::GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter)
@@ -38,20 +72,187 @@ void ABreakableActor::GetHit_Implementation(const FVector& ImpactPoint, AActor*
 	if (bBroken)
 		return;
 
+	SwapInGeometryCollection();
+
 	bBroken = true;
 
-	UWorld* World = GetWorld();
+	MARK_PROPERTY_DIRTY_FROM_NAME(ABreakableActor, bBroken, this);
+	FlushNetDormancy();
 
-	if (World && TreasureClasses.Num() > 0)
+	if (ULootSubsystem* LootSubsystem = ULootSubsystem::Get(this))
 	{
 		FVector Location = GetActorLocation();
 		Location.Z += 75.f;
 
-		int RandomTreasureIndex = FMath::RandRange(0, TreasureClasses.Num() - 1);
-
-		GetWorld()->SpawnActor<ATreasure>(TreasureClasses[RandomTreasureIndex], Location, GetActorRotation());
+		if (LootTable)
+		{
+			LootSubsystem->RollTable(LootTable, this, Location);
+		}
+		else if (TreasureClasses.Num() > 0)
+		{
+			FRandomStream Stream = LootSubsystem->MakeStream(this);
+			LootSubsystem->AddDrop(TreasureClasses[Stream.RandRange(0, TreasureClasses.Num() - 1)], 0, Location);
+		}
 	}
 
+	OnRep_Broken();
+
+	if (UWorldStateSubsystem* WorldState = UWorldStateSubsystem::Get(this))
+		WorldState->RecordActorState(this);
+}
+
+void ABreakableActor::OnRep_Broken()
+{
+	if (!bBroken)
+		return;
+
+	SwapInGeometryCollection();
+
 	CapsuleCollider->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Ignore);
+
+	if (UDestructionBudgetSubsystem* DestructionBudget = UDestructionBudgetSubsystem::Get(this))
+		DestructionBudget->NotifyBroken(this);
+}
+
+#pragma region Proxy
+
+void ABreakableActor::EnterProxyMode()
+{
+	bProxy = true;
+
+	ProxyMesh = NewObject<UStaticMeshComponent>(this, TEXT("Proxy Mesh"));
+	ProxyMesh->SetStaticMesh(ProxyStaticMesh);
+	ProxyMesh->SetCanEverAffectNavigation(false);
+	ProxyMesh->SetupAttachment(GetRootComponent());
+
+	// The proxy takes over both the weapon overlaps of the collection and the pawn blocking of the capsule.
+	ProxyMesh->SetCollisionResponseToChannels(GeometryCollection->GetCollisionResponseToChannels());
+	ProxyMesh->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Block);
+	ProxyMesh->SetGenerateOverlapEvents(true);
+	ProxyMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+	ProxyMesh->RegisterComponent();
+
+	GeometryCollection->SetVisibility(false);
+	GeometryCollection->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	CapsuleCollider->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	// Every breakable of a type shares one collection asset, so it is streamed in once in the background and held while
+	// any cell with such a breakable is loaded.
+	if (UAssetPreloadSubsystem* PreloadSubsystem = UAssetPreloadSubsystem::Get(this))
+		PreloadSubsystem->PreloadBundle(FName(FracturedCollection.ToString()), { FracturedCollection.ToSoftObjectPath() }, this);
+}
+
+void ABreakableActor::SwapInGeometryCollection()
+{
+	if (!bProxy)
+		return;
+
+	bProxy = false;
+
+	// The component registered without a collection, so it has no physics proxy until its state is rebuilt.
+	if (UGeometryCollection* Collection = UAssetPreloadSubsystem::Resolve(FracturedCollection, this))
+	{
+		GeometryCollection->SetRestCollection(Collection);
+		GeometryCollection->RecreatePhysicsState();
+	}
+
+	const ABreakableActor* Defaults = GetClass()->GetDefaultObject<ABreakableActor>();
+
+	GeometryCollection->SetVisibility(true);
+	GeometryCollection->SetCollisionEnabled(Defaults->GeometryCollection->GetCollisionEnabled());
+	CapsuleCollider->SetCollisionEnabled(Defaults->CapsuleCollider->GetCollisionEnabled());
+
+	ProxyMesh->DestroyComponent();
+	ProxyMesh = nullptr;
+}
+
+#pragma endregion
+
+#pragma region Destruction Budget
+
+void ABreakableActor::SetCoarseFracture(bool bCoarse, int32 CoarseClusterLevel)
+{
+	const int32 ClusterLevel = bCoarse ? FMath::Min(FullClusterLevel, CoarseClusterLevel) : FullClusterLevel;
+
+	bCoarseFracture = bCoarse;
+
+	if (GeometryCollection->MaxClusterLevel == ClusterLevel)
+		return;
+
+	GeometryCollection->MaxClusterLevel = ClusterLevel;
+	GeometryCollection->RecreatePhysicsState();
+}
+
+int32 ABreakableActor::CountDebrisPieces() const
+{
+	const UGeometryCollection* RestCollection = GeometryCollection->GetRestCollection();
+
+	if (RestCollection == nullptr)
+		return 0;
+
+	const TSharedPtr<FGeometryCollection, ESPMode::ThreadSafe> Collection = RestCollection->GetGeometryCollection();
+	const TManagedArray<int32>* Levels = Collection.IsValid() ? Collection->FindAttribute<int32>(TEXT("Level"), FGeometryCollection::TransformGroup) : nullptr;
+
+	if (Levels == nullptr)
+		return RestCollection->NumElements(FGeometryCollection::TransformGroup);
+
+	// Breaking stops at MaxClusterLevel, so the pieces are the clusters at that level plus any shallower leaves.
+	const int32 MaxLevel = GeometryCollection->MaxClusterLevel;
+	int32 NumPieces = 0;
+
+	for (int32 TransformIndex = 0; TransformIndex < Levels->Num(); ++TransformIndex)
+	{
+		const int32 Level = (*Levels)[TransformIndex];
+
+		if (Level == MaxLevel || (Level < MaxLevel && Collection->Children[TransformIndex].Num() == 0))
+			++NumPieces;
+	}
+
+	return NumPieces;
+}
+
+void ABreakableActor::FreezeDebris()
+{
+	// Turns every piece kinematic where it lies: it still renders and blocks, but no longer costs a simulation step.
+	GeometryCollection->ApplyKinematicField(GeometryCollection->Bounds.SphereRadius * 2.f, GeometryCollection->Bounds.Origin);
+}
+
+void ABreakableActor::RemoveDebris()
+{
+	if (HasAuthority())
+	{
+		Destroy();
+		return;
+	}
+
+	// Clients hide their copy until the server's destroy arrives.
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+}
+
+#pragma endregion
+
+FGuid ABreakableActor::GetPersistentGuid() const
+{
+	if (!PersistentGuid.IsValid())
+		PersistentGuid = UWorldStateSubsystem::MakeActorGuid(this);
+
+	return PersistentGuid;
+}
+
+bool ABreakableActor::WritePersistentState(FActorStateRecord& OutRecord) const
+{
+	if (!bBroken)
+		return false;
+
+	OutRecord.Flags = EActorStateFlags::Broken;
+
+	return true;
+}
+
+void ABreakableActor::ApplyPersistentState(const FActorStateRecord& Record)
+{
+	if (Record.HasAnyFlags(EActorStateFlags::Broken))
+		Destroy();
 }
 
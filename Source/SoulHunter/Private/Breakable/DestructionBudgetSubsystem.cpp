@@ -0,0 +1,274 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Breakable/DestructionBudgetSubsystem.h"
+#include "Breakable/BreakableActor.h"
+#include "SoulHunter.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/Engine.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Destruction Budget"), STAT_DestructionBudget, STATGROUP_Game);
+
+namespace DestructionBudget
+{
+	TAutoConsoleVariable<int32> CVarMaxActivePieces(
+		TEXT("sh.Destruction.MaxActivePieces"),
+		256,
+		TEXT("Most broken pieces left simulating at once. Past this, the oldest debris is frozen in place."));
+
+	TAutoConsoleVariable<float> CVarFullDetailDistance(
+		TEXT("sh.Destruction.FullDetailDistance"),
+		2000.f,
+		TEXT("Breakables closer than this to the local view break at their full fracture level, the rest at the coarse one."));
+
+	TAutoConsoleVariable<int32> CVarCoarseClusterLevel(
+		TEXT("sh.Destruction.CoarseClusterLevel"),
+		1,
+		TEXT("Deepest cluster level a coarse breakable breaks down to."));
+
+	TAutoConsoleVariable<float> CVarFreezeDistance(
+		TEXT("sh.Destruction.FreezeDistance"),
+		5000.f,
+		TEXT("Debris further than this from the local view is frozen straight away."));
+
+	TAutoConsoleVariable<float> CVarSettleTime(
+		TEXT("sh.Destruction.SettleTime"),
+		4.f,
+		TEXT("Seconds after breaking at which debris is considered settled and frozen."));
+
+	TAutoConsoleVariable<float> CVarDebrisLifetime(
+		TEXT("sh.Destruction.DebrisLifetime"),
+		20.f,
+		TEXT("Seconds after breaking at which debris is removed."));
+
+	/** Fracture levels are only re-evaluated this often, since changing one rebuilds the breakable's physics state. */
+	constexpr float FractureLevelInterval = .5f;
+
+	/** A breakable has to move this far past the detail distance before it switches back, so it does not flip at the edge. */
+	constexpr float FractureLevelHysteresis = 1.1f;
+}
+
+#pragma region Main
+
+UDestructionBudgetSubsystem* UDestructionBudgetSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+
+	return World ? World->GetSubsystem<UDestructionBudgetSubsystem>() : nullptr;
+}
+
+bool UDestructionBudgetSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UDestructionBudgetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDestructionBudgetSubsystem, STATGROUP_Tickables);
+}
+
+void UDestructionBudgetSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DestructionBudget);
+
+	FractureLevelTimer -= DeltaTime;
+
+	if (FractureLevelTimer <= 0.f)
+	{
+		FractureLevelTimer = DestructionBudget::FractureLevelInterval;
+		UpdateFractureLevels();
+	}
+
+	if (Debris.Num() > 0)
+		UpdateDebris();
+}
+
+void UDestructionBudgetSubsystem::Register(ABreakableActor* Breakable)
+{
+	if (Breakable && !Breakable->IsBroken())
+		IntactBreakables.AddUnique(Breakable);
+}
+
+void UDestructionBudgetSubsystem::Unregister(ABreakableActor* Breakable)
+{
+	IntactBreakables.RemoveSwap(Breakable);
+
+	const int32 DebrisIndex = Debris.IndexOfByPredicate([Breakable](const FDebris& Entry) { return Entry.Breakable == Breakable; });
+
+	if (DebrisIndex == INDEX_NONE)
+		return;
+
+	if (!Debris[DebrisIndex].bFrozen)
+		ActivePieces -= Debris[DebrisIndex].NumPieces;
+
+	Debris.RemoveAt(DebrisIndex);
+}
+
+void UDestructionBudgetSubsystem::NotifyBroken(ABreakableActor* Breakable)
+{
+	if (Breakable == nullptr || !IntactBreakables.Contains(Breakable))
+		return;
+
+	IntactBreakables.RemoveSwap(Breakable);
+
+	FDebris& NewDebris = Debris.AddDefaulted_GetRef();
+	NewDebris.Breakable = Breakable;
+	NewDebris.BreakTime = GetWorld()->GetTimeSeconds();
+	NewDebris.NumPieces = Breakable->CountDebrisPieces();
+
+	ActivePieces += NewDebris.NumPieces;
+	PeakActivePieces = FMath::Max(PeakActivePieces, ActivePieces);
+
+	++NumBroken;
+	NumCoarseBreaks += Breakable->IsCoarseFracture() ? 1 : 0;
+}
+
+void UDestructionBudgetSubsystem::LogReport() const
+{
+	UE_LOG(LogSoulHunter, Display, TEXT("Destruction: %d intact breakables, %d debris actors, %d/%d active pieces (peak %d)"),
+		IntactBreakables.Num(), Debris.Num(), ActivePieces, DestructionBudget::CVarMaxActivePieces.GetValueOnGameThread(), PeakActivePieces);
+
+	UE_LOG(LogSoulHunter, Display, TEXT("  %d broken (%d coarse), frozen %d settled / %d far / %d over budget, %d removed"),
+		NumBroken, NumCoarseBreaks, NumSettledFreezes, NumDistanceFreezes, NumBudgetFreezes, NumRemoved);
+}
+
+#pragma endregion
+
+#pragma region Fracture Level
+
+bool UDestructionBudgetSubsystem::GetViewLocation(FVector& OutLocation) const
+{
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+
+	if (PlayerController == nullptr || !PlayerController->IsLocalController() || PlayerController->PlayerCameraManager == nullptr)
+		return false;
+
+	OutLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+	return true;
+}
+
+void UDestructionBudgetSubsystem::UpdateFractureLevels()
+{
+	FVector ViewLocation;
+	const bool bHasView = GetViewLocation(ViewLocation);
+
+	// Under budget pressure everything that breaks next breaks coarse; a dedicated server has no view and never needs detail.
+	const bool bBudgetPressure = ActivePieces * 2 > DestructionBudget::CVarMaxActivePieces.GetValueOnGameThread();
+	const float FullDetailDistanceSquared = FMath::Square(DestructionBudget::CVarFullDetailDistance.GetValueOnGameThread());
+	const float CoarseDistanceSquared = FullDetailDistanceSquared * FMath::Square(DestructionBudget::FractureLevelHysteresis);
+	const int32 CoarseClusterLevel = DestructionBudget::CVarCoarseClusterLevel.GetValueOnGameThread();
+
+	for (int32 Index = IntactBreakables.Num() - 1; Index >= 0; --Index)
+	{
+		ABreakableActor* Breakable = IntactBreakables[Index].Get();
+
+		if (Breakable == nullptr)
+		{
+			IntactBreakables.RemoveAtSwap(Index);
+			continue;
+		}
+
+		bool bCoarse = !bHasView || bBudgetPressure;
+
+		if (!bCoarse)
+		{
+			const float DistanceSquared = FVector::DistSquared(ViewLocation, Breakable->GetActorLocation());
+			bCoarse = Breakable->IsCoarseFracture() ? DistanceSquared > FullDetailDistanceSquared : DistanceSquared > CoarseDistanceSquared;
+		}
+
+		if (bCoarse != Breakable->IsCoarseFracture())
+			Breakable->SetCoarseFracture(bCoarse, CoarseClusterLevel);
+	}
+}
+
+#pragma endregion
+
+#pragma region Debris
+
+void UDestructionBudgetSubsystem::UpdateDebris()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float SettleTime = DestructionBudget::CVarSettleTime.GetValueOnGameThread();
+	const float DebrisLifetime = DestructionBudget::CVarDebrisLifetime.GetValueOnGameThread();
+	const float FreezeDistanceSquared = FMath::Square(DestructionBudget::CVarFreezeDistance.GetValueOnGameThread());
+
+	FVector ViewLocation;
+	const bool bHasView = GetViewLocation(ViewLocation);
+
+	for (int32 Index = 0; Index < Debris.Num(); ++Index)
+	{
+		FDebris& Entry = Debris[Index];
+		ABreakableActor* Breakable = Entry.Breakable.Get();
+		const double Age = Now - Entry.BreakTime;
+
+		if (Breakable == nullptr || Age >= DebrisLifetime)
+		{
+			if (!Entry.bFrozen)
+				ActivePieces -= Entry.NumPieces;
+
+			// Removed from the list first: destroying the breakable unregisters it.
+			Debris.RemoveAt(Index--);
+
+			if (Breakable)
+			{
+				Breakable->RemoveDebris();
+				++NumRemoved;
+			}
+
+			continue;
+		}
+
+		if (Entry.bFrozen)
+			continue;
+
+		if (Age >= SettleTime)
+		{
+			FreezeDebris(Entry);
+			++NumSettledFreezes;
+		}
+		else if (!bHasView || FVector::DistSquared(ViewLocation, Breakable->GetActorLocation()) > FreezeDistanceSquared)
+		{
+			FreezeDebris(Entry);
+			++NumDistanceFreezes;
+		}
+	}
+
+	const int32 MaxActivePieces = DestructionBudget::CVarMaxActivePieces.GetValueOnGameThread();
+
+	for (int32 Index = 0; Index < Debris.Num() && ActivePieces > MaxActivePieces; ++Index)
+	{
+		if (Debris[Index].bFrozen)
+			continue;
+
+		FreezeDebris(Debris[Index]);
+		++NumBudgetFreezes;
+	}
+}
+
+void UDestructionBudgetSubsystem::FreezeDebris(FDebris& Entry)
+{
+	Entry.bFrozen = true;
+	ActivePieces -= Entry.NumPieces;
+
+	if (ABreakableActor* Breakable = Entry.Breakable.Get())
+		Breakable->FreezeDebris();
+}
+
+#pragma endregion
+
+#pragma region Console Commands
+
+namespace DestructionBudget
+{
+	static FAutoConsoleCommandWithWorld ReportCommand(
+		TEXT("sh.Destruction.Report"),
+		TEXT("Logs intact breakables, debris, active and peak simulated pieces and why debris was frozen or removed."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (const UDestructionBudgetSubsystem* DestructionSubsystem = UDestructionBudgetSubsystem::Get(World))
+				DestructionSubsystem->LogReport();
+		}));
+}
+
+#pragma endregion
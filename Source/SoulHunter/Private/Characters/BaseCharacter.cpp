@@ -1,18 +1,29 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Characters/BaseCharacter.h"
+#include "Characters/CharacterNames.h"
+#include "Characters/HitDirection.h"
+#include "Characters/MontageSectionTable.h"
 #include "Components/BoxComponent.h"
 #include "Components/AttributeComponent.h"
 #include "Items/Weapons/Weapon.h"
 #include "Animation/AnimMontage.h"
 #include "Kismet/KismetSystemLibrary.h"
 #include "Kismet/GameplayStatics.h"
+#include "Loading/AssetPreloadSubsystem.h"
+#include "Diagnostics/CombatTelemetry.h"
+#include "Scalability/GameplayScalability.h"
+#include "Network/LagCompensationSubsystem.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 #pragma region Main
 
-ABaseCharacter::ABaseCharacter()
+ABaseCharacter::ABaseCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
 {
-	PrimaryActorTick.bCanEverTick = true;
+	// Characters have no per-frame work of their own; movement, mesh and subclasses that need it tick separately.
+	PrimaryActorTick.bCanEverTick = false;
 
 	GetMesh()->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
 	GetMesh()->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
@@ -26,6 +37,47 @@ ABaseCharacter::ABaseCharacter()
 void ABaseCharacter::BeginPlay()
 {
 	Super::BeginPlay();
+
+	if (UAssetPreloadSubsystem* PreloadSubsystem = UAssetPreloadSubsystem::Get(this))
+		PreloadSubsystem->PreloadCharacterAssets(GetClass(), this, FStreamableDelegate::CreateUObject(this, &ABaseCharacter::OnPreloadAssetsLoaded));
+	else
+		OnPreloadAssetsLoaded();
+
+	if (ULagCompensationSubsystem* LagCompensation = HasAuthority() ? ULagCompensationSubsystem::Get(this) : nullptr)
+		LagCompensation->Register(this);
+}
+
+void ABaseCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (ULagCompensationSubsystem* LagCompensation = ULagCompensationSubsystem::Get(this))
+		LagCompensation->Unregister(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ABaseCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(ABaseCharacter, EquippedWeapon, Params);
+}
+
+void ABaseCharacter::SetEquippedWeapon(AWeapon* Weapon)
+{
+	EquippedWeapon = Weapon;
+	MARK_PROPERTY_DIRTY_FROM_NAME(ABaseCharacter, EquippedWeapon, this);
+}
+
+void ABaseCharacter::GatherPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const
+{
+	for (const TSoftObjectPtr<UAnimMontage>& Montage : { DeathMontage, AttackMontage, HitReactionMontage })
+	{
+		if (!Montage.IsNull())
+			OutAssets.Add(Montage.ToSoftObjectPath());
+	}
 }
 
 void ABaseCharacter::Death(const FVector& ImpactPoint)
@@ -50,12 +102,8 @@ void ABaseCharacter::StartRagdoll(const FVector& ImpactPoint, const float& Impul
 	GetMesh()->AddImpulse(Impulse, RagdollBaseBone, true);
 
 	GetMesh()->bPauseAnims = true;
-}
-
-void ABaseCharacter::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
 
+	FGameplayScalability::RegisterRagdoll(GetMesh());
 }
 
 float ABaseCharacter::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
@@ -63,20 +111,48 @@ float ABaseCharacter::TakeDamage(float DamageAmount, FDamageEvent const& DamageE
 	if (Attributes)
 		Attributes->ReceiveDamage(DamageAmount);
 
+	SH_COMBAT_TELEMETRY(Damage, DamageCauser ? DamageCauser->GetOwner() : nullptr, this, DamageAmount);
+
 	return DamageAmount;
 }
 
 void ABaseCharacter::GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter)
 {
-	if (IsAlive() && Hitter)
-		DirectionalHitReact(Hitter->GetActorLocation());
-	else
-		Death(Hitter->GetActorLocation());
+	LastHitterLocation = Hitter ? Hitter->GetActorLocation() : ImpactPoint;
+
+	const bool bHitReact = IsAlive() && Hitter;
+
+	if (!bHitReact)
+		Death(LastHitterLocation);
+	else if (!bHitReactDeferred)
+		DirectionalHitReact(LastHitterLocation);
 
 	PlayHitSound(ImpactPoint);
 	SpawnHitParticles(ImpactPoint);
 
 	SetWeaponCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	if (HasAuthority())
+		Multicast_HitEffects(ImpactPoint, LastHitterLocation, Hitter, bHitReact);
+}
+
+void ABaseCharacter::Multicast_HitEffects_Implementation(FVector_NetQuantize ImpactPoint, FVector_NetQuantize HitterLocation, AActor* Hitter, bool bHitReact)
+{
+	// The server played these itself in GetHit.
+	if (HasAuthority())
+		return;
+
+	LastHitterLocation = HitterLocation;
+
+	// The attacking client already played this hit when it predicted it. Hits from anyone else still play.
+	if (ConsumePredictedHit(Hitter))
+		return;
+
+	if (bHitReact)
+		DirectionalHitReact(HitterLocation);
+
+	PlayHitSound(ImpactPoint);
+	SpawnHitParticles(ImpactPoint);
 }
 
 bool ABaseCharacter::IsAlive()
@@ -90,44 +166,97 @@ bool ABaseCharacter::IsAlive()
 
 void ABaseCharacter::DirectionalHitReact(const FVector& ImpactPoint)
 {
-	if (HitReactionMontage == nullptr)
+	if (HitReactionMontage.IsNull())
 		return;
 
-	const FVector Forward = GetActorForwardVector();
+	PlayHitReactMontage(GetHitReactDirection(ImpactPoint));
+}
 
-	const FVector ImpactLowered(ImpactPoint.X, ImpactPoint.Y, GetActorLocation().Z);
-	const FVector ToHit = (ImpactLowered - GetActorLocation()).GetSafeNormal();
+EHitReactDirection ABaseCharacter::GetHitReactDirection(const FVector& ImpactPoint) const
+{
+	return FHitDirectionClassifier::Classify(GetActorForwardVector(), GetActorLocation(), ImpactPoint);
+}
+
+void ABaseCharacter::PlayCrowdHitReactions(TConstArrayView<ABaseCharacter*> HitCharacters, const FVector& HitterLocation)
+{
+	TArray<ABaseCharacter*, TInlineAllocator<32>> Reacting;
+	TArray<FVector, TInlineAllocator<32>> Forwards;
+	TArray<FVector, TInlineAllocator<32>> Locations;
+
+	for (ABaseCharacter* Character : HitCharacters)
+	{
+		if (Character == nullptr || !Character->IsAlive() || Character->HitReactionMontage.IsNull())
+			continue;
 
-	const double CosTheta = FVector::DotProduct(Forward, ToHit);
-	double HitAngle = FMath::RadiansToDegrees(FMath::Acos(CosTheta));
+		Reacting.Add(Character);
+		Forwards.Add(Character->GetActorForwardVector());
+		Locations.Add(Character->GetActorLocation());
+	}
 
-	const FVector CrossProduct = FVector::CrossProduct(Forward, ToHit);
-	if (CrossProduct.Z < 0)
-		HitAngle *= -1.f;
+	TArray<FVector, TInlineAllocator<32>> HitterLocations;
+	HitterLocations.Init(HitterLocation, Reacting.Num());
 
-	FName SectionName = FName("ReactFromBack");
+	TArray<EHitReactDirection, TInlineAllocator<32>> Directions;
+	Directions.SetNumUninitialized(Reacting.Num());
 
-	if (HitAngle >= -45.f && HitAngle < 45.f)
-		SectionName = FName("ReactFromFront");
-	else if (HitAngle >= -135.f && HitAngle < -45.f)
-		SectionName = FName("ReactFromLeft");
-	else if (HitAngle >= 45.f && HitAngle < 135.f)
-		SectionName = FName("ReactFromRight");
+	FHitDirectionClassifier::ClassifyBatch(Forwards, Locations, HitterLocations, Directions);
 
-	PlayHitReactMontage(SectionName);
+	for (int32 Index = 0; Index < Reacting.Num(); ++Index)
+		Reacting[Index]->PlayHitReactMontage(Directions[Index]);
 }
 
-void ABaseCharacter::PlayHitReactMontage(const FName& SectionName)
+void ABaseCharacter::PlayHitReactMontage(EHitReactDirection Direction)
 {
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
+	UAnimMontage* Montage = UAssetPreloadSubsystem::Resolve(HitReactionMontage, this);
 
-	if (AnimInstance && HitReactionMontage)
+	if (AnimInstance && Montage)
 	{
-		AnimInstance->Montage_Play(HitReactionMontage);
-		AnimInstance->Montage_JumpToSection(SectionName, HitReactionMontage);
+		AnimInstance->Montage_Play(Montage);
+		AnimInstance->Montage_JumpToSection(CharacterNames::GetHitReactSection(Direction), Montage);
 	}
 }
 
+void ABaseCharacter::PlayPredictedHitEffects(const FVector& ImpactPoint, const AActor* Hitter)
+{
+	if (!IsAlive() || Hitter == nullptr)
+		return;
+
+	PredictedHits.Add({ Hitter, GetWorld()->GetTimeSeconds() });
+
+	DirectionalHitReact(Hitter->GetActorLocation());
+	PlayHitSound(ImpactPoint);
+	SpawnHitParticles(ImpactPoint);
+}
+
+bool ABaseCharacter::ConsumePredictedHit(const AActor* Hitter)
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	PredictedHits.RemoveAll([Now](const FPredictedHit& Hit) { return Now - Hit.Time >= PredictedHitConfirmWindow; });
+
+	// Oldest first: confirmations arrive in the order the hits were reported.
+	const int32 Index = Hitter ? PredictedHits.IndexOfByPredicate([Hitter](const FPredictedHit& Hit) { return Hit.Hitter == Hitter; }) : INDEX_NONE;
+
+	if (Index == INDEX_NONE)
+		return false;
+
+	PredictedHits.RemoveAt(Index);
+
+	return true;
+}
+
+void ABaseCharacter::CancelPredictedHitEffects(const AActor* Hitter)
+{
+	if (!ConsumePredictedHit(Hitter))
+		return;
+
+	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
+
+	if (AnimInstance && HitReactionMontage.Get())
+		AnimInstance->Montage_Stop(0.2f, HitReactionMontage.Get());
+}
+
 void ABaseCharacter::PlayHitSound(const FVector& ImpactPoint)
 {
 	if (HitSound)
@@ -136,7 +265,7 @@ void ABaseCharacter::PlayHitSound(const FVector& ImpactPoint)
 
 void ABaseCharacter::SpawnHitParticles(const FVector& ImpactPoint)
 {
-	if (HitParticles)
+	if (HitParticles && FGameplayScalability::ClaimHitEffect(this))
 		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), HitParticles, ImpactPoint);
 }
 
@@ -155,53 +284,61 @@ void ABaseCharacter::SetWeaponCollisionEnabled(ECollisionEnabled::Type Collision
 
 int32 ABaseCharacter::PlayMontageRandomSection(UAnimMontage* AnimationMontage)
 {
-	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
-	if (AnimInstance && AnimationMontage)
-	{
-		const int32 TotalSections = AnimationMontage->GetNumSections();
-		int32 SectionSelection = FMath::RandRange(0, TotalSections - 1);
-
-		const FName SectionName = AnimationMontage->GetSectionName(SectionSelection);
-
-		AnimInstance->Montage_Play(AnimationMontage);
-		AnimInstance->Montage_JumpToSection(SectionName, AnimationMontage);
+	int32 NoLastSelection = INDEX_NONE;
 
-		return SectionSelection;
-	}
-	else
-		return -1;
+	return PlayMontageRandomSection(AnimationMontage, NoLastSelection);
 }
 
 int32 ABaseCharacter::PlayMontageRandomSection(UAnimMontage* AnimationMontage, int32& LastSelectedIndex)
 {
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
-	if (AnimInstance && AnimationMontage)
-	{
-		const int32 TotalSections = AnimationMontage->GetNumSections();
-		int32 SectionSelection = FMath::RandRange(0, TotalSections - 1);
 
-		while (SectionSelection == LastSelectedIndex)
-			SectionSelection = FMath::RandRange(0, TotalSections - 1);
+	if (AnimInstance == nullptr || AnimationMontage == nullptr)
+		return INDEX_NONE;
+
+	const FMontageSectionTable& Sections = FMontageSectionTable::Get(AnimationMontage);
+	const int32 SectionSelection = Sections.PickRandomSection(LastSelectedIndex);
+
+	if (SectionSelection == INDEX_NONE)
+		return INDEX_NONE;
 
-		LastSelectedIndex = SectionSelection;
+	LastSelectedIndex = SectionSelection;
 
-		const FName SectionName = AnimationMontage->GetSectionName(SectionSelection);
+	AnimInstance->Montage_Play(AnimationMontage);
+	AnimInstance->Montage_JumpToSection(Sections.GetSectionName(SectionSelection), AnimationMontage);
 
+	return SectionSelection;
+}
+
+void ABaseCharacter::PlayMontageSection(UAnimMontage* AnimationMontage, const FName& SectionName)
+{
+	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
+
+	if (AnimInstance && AnimationMontage)
+	{
 		AnimInstance->Montage_Play(AnimationMontage);
-		AnimInstance->Montage_JumpToSection(SectionName, AnimationMontage);
 
-		return SectionSelection;
+		if (!SectionName.IsNone())
+			AnimInstance->Montage_JumpToSection(SectionName, AnimationMontage);
 	}
+}
+
+void ABaseCharacter::Multicast_PlayMontageSection_Implementation(UAnimMontage* AnimationMontage, FName SectionName)
+{
+	// The server and the owning client started the montage themselves.
+	if (HasAuthority() || IsLocallyControlled())
+		return;
 
-	return -1;
+	PlayMontageSection(AnimationMontage, SectionName);
 }
 
 void ABaseCharacter::StopAttackMontage()
 {
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
 
-	if (AnimInstance)
-		AnimInstance->Montage_Stop(.25f, AttackMontage);
+	// Nothing can be playing a montage that was never loaded.
+	if (AnimInstance && AttackMontage.IsValid())
+		AnimInstance->Montage_Stop(.25f, AttackMontage.Get());
 }
 
 #pragma endregion
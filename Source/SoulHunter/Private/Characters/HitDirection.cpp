@@ -0,0 +1,205 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Characters/HitDirection.h"
+#include "SoulHunter.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/VectorRegister.h"
+
+namespace HitDirection
+{
+	// Below this squared length GetSafeNormal gave a zero vector, which the angle bands put on the right.
+	constexpr float MinPlanarLengthSquared = UE_SMALL_NUMBER;
+
+	/**
+	 * Front:  cos >  cos45, or exactly cos45 on the left (the old band was [-45, 45)).
+	 * Back:   cos < -cos45, or exactly -cos45 on the right.
+	 * Otherwise left when the cross product points down, right when it does not.
+	 * cos > cos45 becomes Dot > 0 && Dot^2 > Length^2 / 2, which needs neither the normal nor Acos.
+	 */
+	FORCEINLINE EHitReactDirection ClassifyPlanar(float Dot, float CrossZ, float LengthSquared)
+	{
+		if (LengthSquared < MinPlanarLengthSquared)
+			return EHitReactDirection::EHRD_Right;
+
+		const float DotSquared = Dot * Dot;
+		const float HalfLengthSquared = .5f * LengthSquared;
+		const bool bLeft = CrossZ < 0.f;
+
+		if (Dot > 0.f && (DotSquared > HalfLengthSquared || (DotSquared == HalfLengthSquared && bLeft)))
+			return EHitReactDirection::EHRD_Front;
+
+		if (Dot < 0.f && (DotSquared > HalfLengthSquared || (DotSquared == HalfLengthSquared && !bLeft)))
+			return EHitReactDirection::EHRD_Back;
+
+		return bLeft ? EHitReactDirection::EHRD_Left : EHitReactDirection::EHRD_Right;
+	}
+
+	FORCEINLINE void PlanarTerms(const FVector& Forward, const FVector& Location, const FVector& HitterLocation, float& OutForwardX, float& OutForwardY, float& OutToHitX, float& OutToHitY)
+	{
+		// The hit is lowered to the character's height, so only the horizontal offset counts.
+		OutForwardX = static_cast<float>(Forward.X);
+		OutForwardY = static_cast<float>(Forward.Y);
+		OutToHitX = static_cast<float>(HitterLocation.X - Location.X);
+		OutToHitY = static_cast<float>(HitterLocation.Y - Location.Y);
+	}
+}
+
+EHitReactDirection FHitDirectionClassifier::Classify(const FVector& Forward, const FVector& Location, const FVector& HitterLocation)
+{
+	float ForwardX, ForwardY, ToHitX, ToHitY;
+	HitDirection::PlanarTerms(Forward, Location, HitterLocation, ForwardX, ForwardY, ToHitX, ToHitY);
+
+	return HitDirection::ClassifyPlanar(
+		ForwardX * ToHitX + ForwardY * ToHitY,
+		ForwardX * ToHitY - ForwardY * ToHitX,
+		ToHitX * ToHitX + ToHitY * ToHitY);
+}
+
+void FHitDirectionClassifier::ClassifyBatch(
+	TConstArrayView<FVector> Forwards,
+	TConstArrayView<FVector> Locations,
+	TConstArrayView<FVector> HitterLocations,
+	TArrayView<EHitReactDirection> OutDirections)
+{
+	const int32 NumHits = OutDirections.Num();
+
+	check(Forwards.Num() == NumHits && Locations.Num() == NumHits && HitterLocations.Num() == NumHits);
+
+	const VectorRegister4Float Zero = VectorZeroFloat();
+	const VectorRegister4Float Half = VectorSetFloat1(.5f);
+	const VectorRegister4Float MinLengthSquared = VectorSetFloat1(HitDirection::MinPlanarLengthSquared);
+
+	int32 Index = 0;
+
+	for (; Index + 4 <= NumHits; Index += 4)
+	{
+		alignas(16) float ForwardX[4], ForwardY[4], ToHitX[4], ToHitY[4];
+
+		for (int32 Lane = 0; Lane < 4; ++Lane)
+			HitDirection::PlanarTerms(Forwards[Index + Lane], Locations[Index + Lane], HitterLocations[Index + Lane], ForwardX[Lane], ForwardY[Lane], ToHitX[Lane], ToHitY[Lane]);
+
+		const VectorRegister4Float FX = VectorLoadAligned(ForwardX);
+		const VectorRegister4Float FY = VectorLoadAligned(ForwardY);
+		const VectorRegister4Float TX = VectorLoadAligned(ToHitX);
+		const VectorRegister4Float TY = VectorLoadAligned(ToHitY);
+
+		const VectorRegister4Float Dot = VectorMultiplyAdd(FX, TX, VectorMultiply(FY, TY));
+		const VectorRegister4Float CrossZ = VectorSubtract(VectorMultiply(FX, TY), VectorMultiply(FY, TX));
+		const VectorRegister4Float LengthSquared = VectorMultiplyAdd(TX, TX, VectorMultiply(TY, TY));
+
+		const VectorRegister4Float DotSquared = VectorMultiply(Dot, Dot);
+		const VectorRegister4Float HalfLengthSquared = VectorMultiply(Half, LengthSquared);
+
+		const VectorRegister4Float Outside = VectorCompareGT(DotSquared, HalfLengthSquared);
+		const VectorRegister4Float OnBoundary = VectorCompareEQ(DotSquared, HalfLengthSquared);
+		const VectorRegister4Float Left = VectorCompareGT(Zero, CrossZ);
+		const VectorRegister4Float Ahead = VectorCompareGT(Dot, Zero);
+		const VectorRegister4Float Behind = VectorCompareGT(Zero, Dot);
+		const VectorRegister4Float Degenerate = VectorCompareGT(MinLengthSquared, LengthSquared);
+
+		const VectorRegister4Float FrontMask = VectorBitwiseAnd(Ahead, VectorBitwiseOr(Outside, VectorBitwiseAnd(OnBoundary, Left)));
+		const VectorRegister4Float BackMask = VectorBitwiseAnd(Behind, VectorBitwiseOr(Outside, VectorBitwiseAnd(OnBoundary, VectorCompareGE(CrossZ, Zero))));
+
+		const int32 FrontBits = VectorMaskBits(FrontMask);
+		const int32 BackBits = VectorMaskBits(BackMask);
+		const int32 LeftBits = VectorMaskBits(Left);
+		const int32 DegenerateBits = VectorMaskBits(Degenerate);
+
+		for (int32 Lane = 0; Lane < 4; ++Lane)
+		{
+			const int32 LaneBit = 1 << Lane;
+
+			if (DegenerateBits & LaneBit)
+				OutDirections[Index + Lane] = EHitReactDirection::EHRD_Right;
+			else if (FrontBits & LaneBit)
+				OutDirections[Index + Lane] = EHitReactDirection::EHRD_Front;
+			else if (BackBits & LaneBit)
+				OutDirections[Index + Lane] = EHitReactDirection::EHRD_Back;
+			else
+				OutDirections[Index + Lane] = (LeftBits & LaneBit) ? EHitReactDirection::EHRD_Left : EHitReactDirection::EHRD_Right;
+		}
+	}
+
+	for (; Index < NumHits; ++Index)
+		OutDirections[Index] = Classify(Forwards[Index], Locations[Index], HitterLocations[Index]);
+}
+
+EHitReactDirection FHitDirectionClassifier::ClassifyReference(const FVector& Forward, const FVector& Location, const FVector& HitterLocation)
+{
+	const FVector ImpactLowered(HitterLocation.X, HitterLocation.Y, Location.Z);
+	const FVector ToHit = (ImpactLowered - Location).GetSafeNormal();
+
+	const double CosTheta = FVector::DotProduct(Forward, ToHit);
+	double HitAngle = FMath::RadiansToDegrees(FMath::Acos(CosTheta));
+
+	const FVector CrossProduct = FVector::CrossProduct(Forward, ToHit);
+	if (CrossProduct.Z < 0)
+		HitAngle *= -1.f;
+
+	if (HitAngle >= -45.f && HitAngle < 45.f)
+		return EHitReactDirection::EHRD_Front;
+	else if (HitAngle >= -135.f && HitAngle < -45.f)
+		return EHitReactDirection::EHRD_Left;
+	else if (HitAngle >= 45.f && HitAngle < 135.f)
+		return EHitReactDirection::EHRD_Right;
+
+	return EHitReactDirection::EHRD_Back;
+}
+
+#pragma region Console Commands
+
+namespace HitDirection
+{
+	static FAutoConsoleCommandWithArgs BenchmarkCommand(
+		TEXT("sh.Combat.BenchmarkHitDirections"),
+		TEXT("Times the Acos, scalar and batched hit direction classifiers: sh.Combat.BenchmarkHitDirections [Hits]."),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const int32 NumHits = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000000;
+
+			TArray<FVector> Forwards;
+			TArray<FVector> Locations;
+			TArray<FVector> HitterLocations;
+			Forwards.Reserve(NumHits);
+			Locations.Reserve(NumHits);
+			HitterLocations.Reserve(NumHits);
+
+			FRandomStream Random(NumHits);
+
+			for (int32 Hit = 0; Hit < NumHits; ++Hit)
+			{
+				Forwards.Add(FRotator(0.f, Random.FRandRange(-180.f, 180.f), 0.f).Vector());
+				Locations.Add(Random.GetUnitVector() * Random.FRandRange(0.f, 10000.f));
+				HitterLocations.Add(Locations.Last() + Random.GetUnitVector() * Random.FRandRange(1.f, 500.f));
+			}
+
+			TArray<EHitReactDirection> Directions;
+			Directions.SetNumUninitialized(NumHits);
+
+			double StartTime = FPlatformTime::Seconds();
+
+			for (int32 Hit = 0; Hit < NumHits; ++Hit)
+				Directions[Hit] = FHitDirectionClassifier::ClassifyReference(Forwards[Hit], Locations[Hit], HitterLocations[Hit]);
+
+			const double ReferenceSeconds = FPlatformTime::Seconds() - StartTime;
+			StartTime = FPlatformTime::Seconds();
+
+			for (int32 Hit = 0; Hit < NumHits; ++Hit)
+				Directions[Hit] = FHitDirectionClassifier::Classify(Forwards[Hit], Locations[Hit], HitterLocations[Hit]);
+
+			const double ScalarSeconds = FPlatformTime::Seconds() - StartTime;
+			StartTime = FPlatformTime::Seconds();
+
+			FHitDirectionClassifier::ClassifyBatch(Forwards, Locations, HitterLocations, Directions);
+
+			const double BatchSeconds = FPlatformTime::Seconds() - StartTime;
+
+			UE_LOG(LogSoulHunter, Display, TEXT("Hit directions, %d hits: Acos %.2f ns, scalar %.2f ns, batch %.2f ns per hit"),
+				NumHits,
+				ReferenceSeconds * 1000000000.0 / NumHits,
+				ScalarSeconds * 1000000000.0 / NumHits,
+				BatchSeconds * 1000000000.0 / NumHits);
+		}));
+}
+
+#pragma endregion
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Characters/MontageSectionTable.h"
+#include "Animation/AnimMontage.h"
+#include "UObject/ObjectKey.h"
+
+namespace MontageSectionTable
+{
+	static TMap<TObjectKey<UAnimMontage>, FMontageSectionTable> Tables;
+	static const FMontageSectionTable EmptyTable;
+}
+
+const FMontageSectionTable& FMontageSectionTable::Get(const UAnimMontage* Montage)
+{
+	if (Montage == nullptr)
+		return MontageSectionTable::EmptyTable;
+
+	FMontageSectionTable& Table = MontageSectionTable::Tables.FindOrAdd(Montage);
+
+	// Sections can be added or removed while editing, so the editor checks the table is still current.
+	const bool bStale = WITH_EDITOR ? Table.SectionNames.Num() != Montage->GetNumSections() : Table.SectionNames.IsEmpty();
+
+	if (bStale)
+	{
+		Table.SectionNames.Reset(Montage->GetNumSections());
+
+		for (int32 Index = 0; Index < Montage->GetNumSections(); ++Index)
+			Table.SectionNames.Add(Montage->GetSectionName(Index));
+	}
+
+	return Table;
+}
+
+int32 FMontageSectionTable::PickRandomSection(int32 ExcludedIndex) const
+{
+	const int32 NumSections = SectionNames.Num();
+
+	if (NumSections == 0)
+		return INDEX_NONE;
+
+	if (NumSections == 1 || !IsValidIndex(ExcludedIndex))
+		return FMath::RandRange(0, NumSections - 1);
+
+	// Pick among the other sections and step over the excluded one.
+	const int32 Selection = FMath::RandRange(0, NumSections - 2);
+
+	return Selection >= ExcludedIndex ? Selection + 1 : Selection;
+}
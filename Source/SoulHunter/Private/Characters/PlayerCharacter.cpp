@@ -1,6 +1,8 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Characters/PlayerCharacter.h"
+#include "Characters/CharacterNames.h"
+#include "Characters/MontageSectionTable.h"
 
 #include "Components\InputComponent.h"
 #include "EnhancedInputComponent.h"
@@ -18,24 +20,35 @@
 #include "Components\BoxComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "Components/AttributeComponent.h"
+#include "Components/SoulHunterMovementComponent.h"
+#include "Components/PickupCollectorComponent.h"
 #include "HUD/PlayerHUD.h"
 #include "HUD/PlayerOverlay.h"
 #include "LockOnTargetComponent.h"
-#include "TargetHandlers/WeightedTargetHandler.h"
+#include "Combat/SoulHunterTargetHandler.h"
 #include "Components/ActorComponent.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "Persistence/WorldStateSubsystem.h"
+#include "Loading/AssetPreloadSubsystem.h"
+#include "Network/NetworkStats.h"
+#include "SoulHunter.h"
+#include "SoulHunterDebug.h"
+#include "Scalability/GameplayScalability.h"
+#include "Diagnostics/CombatTelemetry.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 #pragma region Main
 
-APlayerCharacter::APlayerCharacter()
+APlayerCharacter::APlayerCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<USoulHunterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
-	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
-
 	bUseControllerRotationPitch = false;
 	bUseControllerRotationRoll = false;
 	bUseControllerRotationYaw = false;
 
+	SoulHunterMovement = Cast<USoulHunterMovementComponent>(GetCharacterMovement());
+
 	GetCharacterMovement()->bOrientRotationToMovement = true;
 	GetCharacterMovement()->RotationRate = FRotator(0.f, 600.f, 0.f);
 
@@ -51,55 +64,94 @@ APlayerCharacter::APlayerCharacter()
 
 	AutoPossessPlayer = EAutoReceiveInput::Player0;
 
+	PickupCollector = CreateDefaultSubobject<UPickupCollectorComponent>(TEXT("PickupCollector"));
+
 	LockOnTarget = CreateDefaultSubobject<ULockOnTargetComponent>(TEXT("LockOnTarget"));
 
-	auto* MyTargetHandler = CreateDefaultSubobject<UWeightedTargetHandler>(TEXT("TargetHandler"));
+	auto* MyTargetHandler = CreateDefaultSubobject<USoulHunterTargetHandler>(TEXT("TargetHandler"));
 	LockOnTarget->SetDefaultTargetHandler(MyTargetHandler);
 }
 
-void APlayerCharacter::BeginPlay()
+void APlayerCharacter::PostLoad()
 {
-	Super::BeginPlay();
+	Super::PostLoad();
 
-	APlayerController* PlayerController = Cast<APlayerController>(GetController());
-	if (PlayerController)
+#if WITH_EDITORONLY_DATA
+	const APlayerCharacter* Template = Cast<APlayerCharacter>(GetArchetype());
+	const float TemplateRunningSpeed = Template ? Template->RunningSpeed_DEPRECATED : 500.f;
+	const float TemplateSprintingSpeed = Template ? Template->SprintingSpeed_DEPRECATED : 800.f;
+
+	// Only values set on this object move, so instances keep inheriting whatever their template migrated.
+	if (SoulHunterMovement && (RunningSpeed_DEPRECATED != TemplateRunningSpeed || SprintingSpeed_DEPRECATED != TemplateSprintingSpeed))
 	{
-		if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer()))
-		{
-			Subsystem->AddMappingContext(MappingContext, 0);
-		}
+		if (RunningSpeed_DEPRECATED != TemplateRunningSpeed)
+			SoulHunterMovement->MaxWalkSpeed = RunningSpeed_DEPRECATED;
 
-		InitializePlayerOverlay(PlayerController);
+		if (SprintingSpeed_DEPRECATED != TemplateSprintingSpeed)
+			SoulHunterMovement->SetMaxSprintSpeed(SprintingSpeed_DEPRECATED);
+
+		UE_LOG(LogSoulHunter, Log, TEXT("%s: moved running and sprinting speed onto %s, resave to keep them"),
+			*GetPathName(), *SoulHunterMovement->GetName());
 	}
+#endif
+}
 
-	Tags.Add(FName("EngageableTarget"));
+void APlayerCharacter::BeginPlay()
+{
+	Super::BeginPlay();
 
-	if (Attributes)
-		SprintingTimerDelegate.BindUFunction(this, FName("DepleteStaminaFromSprinting"), Attributes->GetSprintCost());
+	InitializeLocalPlayer();
+
+	Tags.Add(CharacterNames::EngageableTargetTag);
+
+	// Arm and Disarm attach by these names on every call, so a missing socket is reported once here instead.
+	for (const FName& SocketName : { CharacterNames::RightHandSocket, CharacterNames::SpineSocket, WeaponSocket })
+	{
+		if (!GetMesh()->DoesSocketExist(SocketName))
+			UE_LOG(LogSoulHunter, Warning, TEXT("%s: mesh has no socket %s"), *GetName(), *SocketName.ToString());
+	}
 
 	LockOnTarget->OnTargetLocked.AddDynamic(this, &APlayerCharacter::OnTargetLocked);
 	LockOnTarget->OnTargetUnlocked.AddDynamic(this, &APlayerCharacter::OnTargetUnlocked);
 }
 
-void APlayerCharacter::Tick(float DeltaTime)
+void APlayerCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	if (UWorldStateSubsystem* WorldState = HasAuthority() ? UWorldStateSubsystem::Get(this) : nullptr)
+		WorldState->CapturePlayerState(PlayerSaveKey, Attributes);
 
-	if (Attributes && PlayerOverlay)
-	{
-		Attributes->RegenStamina(DeltaTime);
-		PlayerOverlay->SetStaminaBarPercent(Attributes->GetStaminaPercent());
-	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void APlayerCharacter::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	// Attributes are restored per player, so this waits until the pawn knows whose it is.
+	PlayerSaveKey = UWorldStateSubsystem::GetPlayerKey(NewController);
+
+	if (UWorldStateSubsystem* WorldState = UWorldStateSubsystem::Get(this))
+		WorldState->RestorePlayerState(PlayerSaveKey, Attributes);
 }
 
-float APlayerCharacter::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+void APlayerCharacter::PawnClientRestart()
 {
-	Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
+	Super::PawnClientRestart();
 
-	if (PlayerOverlay && Attributes)
-		PlayerOverlay->SetHealthBarPercent(Attributes->GetHealthPercent());
+	// On a client the controller usually arrives after BeginPlay.
+	if (HasActorBegunPlay())
+		InitializeLocalPlayer();
+}
+
+void APlayerCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	return DamageAmount;
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(APlayerCharacter, CharacterState, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(APlayerCharacter, ActionState, Params);
 }
 
 void APlayerCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -132,7 +184,8 @@ void APlayerCharacter::GetHit_Implementation(const FVector& ImpactPoint, AActor*
 {
 	Super::GetHit_Implementation(ImpactPoint, Hitter);
 
-	ActionState = EActionState::EAS_HitReact;
+	if (ActionState != EActionState::EAS_Dead)
+		SetActionState(EActionState::EAS_HitReact);
 }
 
 void APlayerCharacter::SetOverlappingItem(AItem* Item)
@@ -143,30 +196,52 @@ void APlayerCharacter::SetOverlappingItem(AItem* Item)
 void APlayerCharacter::AddSouls(ASoul* Soul)
 {
 	if (Attributes)
-	{
 		Attributes->AddSouls(Soul->GetSouls());
-		PlayerOverlay->SetSoulsCountText(Attributes->GetSouls());
-	}
 }
 
 void APlayerCharacter::AddGold(ATreasure* Treasure)
 {
 	if (Attributes)
-	{
 		Attributes->AddGold(Treasure->GetGold());
-		PlayerOverlay->SetGoldCountText(Attributes->GetGold());
-	}
 }
 
 void APlayerCharacter::Death(const FVector& ImpactPoint)
 {
-	ActionState = EActionState::EAS_Dead;
-	Tags.Add(FName("Dead"));
+	SH_COMBAT_TELEMETRY(Death, this, nullptr);
+
+	SetActionState(EActionState::EAS_Dead);
+	Tags.Add(CharacterNames::DeadTag);
 
-	StartRagdoll(ImpactPoint, 1500.f);
+	StartRagdoll(ImpactPoint, FGameplayScalability::GetRagdollImpulse());
 	DropWeapon();
 }
 
+void APlayerCharacter::SetCharacterState(ECharacterState NewState)
+{
+	CharacterState = NewState;
+	MARK_PROPERTY_DIRTY_FROM_NAME(APlayerCharacter, CharacterState, this);
+}
+
+void APlayerCharacter::SetActionState(EActionState NewState)
+{
+	SH_COMBAT_TELEMETRY(StateTransition, this, nullptr, 0.f, static_cast<uint8>(NewState));
+
+	ActionState = NewState;
+	MARK_PROPERTY_DIRTY_FROM_NAME(APlayerCharacter, ActionState, this);
+}
+
+void APlayerCharacter::OnRep_ActionState()
+{
+	// Death is decided by the server; clients only get to play the ragdoll.
+	if (ActionState == EActionState::EAS_Dead && !ActorHasTag(CharacterNames::DeadTag))
+	{
+		Tags.Add(CharacterNames::DeadTag);
+
+		StartRagdoll(LastHitterLocation, FGameplayScalability::GetRagdollImpulse());
+		DropWeapon();
+	}
+}
+
 void APlayerCharacter::DropWeapon()
 {
 	if (EquippedWeapon)
@@ -178,7 +253,7 @@ void APlayerCharacter::DropWeapon()
 
 void APlayerCharacter::BackToUnoccupiedState()
 {
-	ActionState = EActionState::EAS_Unoccupied;
+	SetActionState(EActionState::EAS_Unoccupied);
 
 	if (LockOnTarget->IsTargetLocked())
 	{
@@ -187,6 +262,22 @@ void APlayerCharacter::BackToUnoccupiedState()
 	}
 }
 
+void APlayerCharacter::InitializeLocalPlayer()
+{
+	APlayerController* PlayerController = Cast<APlayerController>(GetController());
+
+	if (PlayerController == nullptr || !PlayerController->IsLocalController())
+		return;
+
+	if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer()))
+	{
+		Subsystem->AddMappingContext(MappingContext, 0);
+	}
+
+	if (PlayerOverlay == nullptr)
+		InitializePlayerOverlay(PlayerController);
+}
+
 void APlayerCharacter::InitializePlayerOverlay(APlayerController* PlayerController)
 {
 	APlayerHUD* PlayerHUD = Cast<APlayerHUD>(PlayerController->GetHUD());
@@ -194,16 +285,25 @@ void APlayerCharacter::InitializePlayerOverlay(APlayerController* PlayerControll
 	{
 		PlayerOverlay = PlayerHUD->GetPlayerOverlay();
 
-		if (PlayerOverlay)
+		if (PlayerOverlay && Attributes)
 		{
-			PlayerOverlay->SetHealthBarPercent(Attributes->GetHealthPercent());
-			PlayerOverlay->SetStaminaBarPercent(1.f);
-			PlayerOverlay->SetGoldCountText(0);
-			PlayerOverlay->SetSoulsCountText(0);
+			Attributes->OnAttributesChanged.AddUObject(this, &APlayerCharacter::RefreshPlayerOverlay);
+			RefreshPlayerOverlay();
 		}
 	}
 }
 
+void APlayerCharacter::RefreshPlayerOverlay()
+{
+	if (PlayerOverlay == nullptr || Attributes == nullptr)
+		return;
+
+	PlayerOverlay->SetHealthBarPercent(Attributes->GetHealthPercent());
+	PlayerOverlay->SetStaminaBarPercent(Attributes->GetStaminaPercent());
+	PlayerOverlay->SetGoldCountText(Attributes->GetGold());
+	PlayerOverlay->SetSoulsCountText(Attributes->GetSouls());
+}
+
 #pragma endregion
 
 #pragma region Locomotion
@@ -242,10 +342,27 @@ void APlayerCharacter::Look(const FInputActionValue& Value)
 
 void APlayerCharacter::InteractKeyPressed()
 {
-	UE_LOG(LogTemp, Warning, TEXT("Interact Key Pressed"));
+	SH_DEBUG_LOG(Interaction, TEXT("%s: interact pressed, overlapping %s"), *GetName(), *GetNameSafe(OverlappingItem));
+
+	// Arming and disarming are predicted locally, picking up a weapon waits for the server.
+	Interact();
+
+	if (!HasAuthority())
+		Server_Interact();
+}
 
+void APlayerCharacter::Server_Interact_Implementation()
+{
+	Interact();
+}
+
+void APlayerCharacter::Interact()
+{
 	if (AWeapon* OverlappingWeapon = Cast<AWeapon>(OverlappingItem))
 	{
+		if (!HasAuthority())
+			return;
+
 		if (EquippedWeapon)
 			EquippedWeapon->Destroy();
 
@@ -253,31 +370,37 @@ void APlayerCharacter::InteractKeyPressed()
 	}
 	else
 	{
+		FName SectionName;
+
 		if (CanDisarm())
 		{
-			PlayArmDisarmMontage(FName("Disarm"));
-
-			ActionState = EActionState::EAS_Occupied;
-			CharacterState = ECharacterState::ECS_Unequipped;
+			SectionName = CharacterNames::DisarmSection;
+			SetCharacterState(ECharacterState::ECS_Unequipped);
 		}
 		else if (CanArm())
 		{
-			PlayArmDisarmMontage(FName("Arm"));
-			
-			ActionState = EActionState::EAS_Occupied;
-			CharacterState = ECharacterState::ECS_EquippedOneHandedWeapon;
+			SectionName = CharacterNames::ArmSection;
+			SetCharacterState(ECharacterState::ECS_EquippedOneHandedWeapon);
 		}
+		else
+			return;
+
+		PlayArmDisarmMontage(SectionName);
+		SetActionState(EActionState::EAS_Occupied);
+
+		if (HasAuthority())
+			Multicast_PlayMontageSection(ArmDisarmMontage, SectionName);
 	}
 }
 
 void APlayerCharacter::EquipWeapon(AWeapon* OverlappingWeapon)
 {
 	OverlappingWeapon->Equip(GetMesh(), WeaponSocket, this, this);
-	CharacterState = ECharacterState::ECS_EquippedOneHandedWeapon;
+	SetCharacterState(ECharacterState::ECS_EquippedOneHandedWeapon);
 
 	OverlappingItem = nullptr;
 
-	EquippedWeapon = OverlappingWeapon;
+	SetEquippedWeapon(OverlappingWeapon);
 }
 
 #pragma endregion
@@ -286,11 +409,68 @@ void APlayerCharacter::EquipWeapon(AWeapon* OverlappingWeapon)
 
 void APlayerCharacter::Attack()
 {
-	if (CanAttack())
+	if (!CanAttack())
+		return;
+
+	UAnimMontage* Montage = UAssetPreloadSubsystem::Resolve(AttackMontage, this);
+	const int32 SectionIndex = PlayMontageRandomSection(Montage, LastSelectedAttackMontageSection);
+
+	SetActionState(EActionState::EAS_Attacking);
+
+	if (!HasAuthority())
 	{
-		PlayMontageRandomSection(AttackMontage, LastSelectedAttackMontageSection);
-		ActionState = EActionState::EAS_Attacking;
+		Server_Attack(SectionIndex);
+		return;
 	}
+
+	if (EquippedWeapon)
+		EquippedWeapon->BeginSwing();
+
+	if (SectionIndex != INDEX_NONE)
+		Multicast_PlayMontageSection(Montage, FMontageSectionTable::Get(Montage).GetSectionName(SectionIndex));
+}
+
+void APlayerCharacter::Server_Attack_Implementation(int32 SectionIndex)
+{
+	UAnimMontage* Montage = UAssetPreloadSubsystem::Resolve(AttackMontage, this);
+
+	const FMontageSectionTable& Sections = FMontageSectionTable::Get(Montage);
+
+	if (!CanAttack() || Montage == nullptr || !Sections.IsValidIndex(SectionIndex))
+		return;
+
+	const FName SectionName = Sections.GetSectionName(SectionIndex);
+
+	LastSelectedAttackMontageSection = SectionIndex;
+	PlayMontageSection(Montage, SectionName);
+
+	SetActionState(EActionState::EAS_Attacking);
+
+	if (EquippedWeapon)
+		EquippedWeapon->BeginSwing();
+
+	Multicast_PlayMontageSection(Montage, SectionName);
+}
+
+void APlayerCharacter::Server_ReportWeaponHit_Implementation(AWeapon* Weapon, AActor* HitActor, FVector_NetQuantize ImpactPoint, double ViewTime)
+{
+	const bool bAccepted =
+		Weapon && Weapon == EquippedWeapon &&
+		ActionState != EActionState::EAS_Dead &&
+		Weapon->ValidateReportedHit(HitActor, ImpactPoint, ViewTime);
+
+	FNetworkStats::RecordReportedHit(bAccepted);
+
+	if (bAccepted)
+		Weapon->ApplyHit(HitActor, ImpactPoint);
+	else
+		Client_RejectWeaponHit(HitActor);
+}
+
+void APlayerCharacter::Client_RejectWeaponHit_Implementation(AActor* HitActor)
+{
+	if (ABaseCharacter* HitCharacter = Cast<ABaseCharacter>(HitActor))
+		HitCharacter->CancelPredictedHitEffects(this);
 }
 
 bool APlayerCharacter::CanAttack()
@@ -303,7 +483,7 @@ void APlayerCharacter::Arm()
 {
 	if (EquippedWeapon)
 	{
-		EquippedWeapon->AttackMeshToSocket(GetMesh(), FName("RightHandSocket"));
+		EquippedWeapon->AttackMeshToSocket(GetMesh(), CharacterNames::RightHandSocket);
 	}
 }
 
@@ -311,7 +491,7 @@ void APlayerCharacter::Disarm()
 {
 	if (EquippedWeapon)
 	{
-		EquippedWeapon->AttackMeshToSocket(GetMesh(), FName("SpineSocket"));
+		EquippedWeapon->AttackMeshToSocket(GetMesh(), CharacterNames::SpineSocket);
 	}
 }
 
@@ -341,79 +521,47 @@ void APlayerCharacter::PlayArmDisarmMontage(const FName& SectionName)
 
 void APlayerCharacter::Dodge()
 {
-	float DodgeCost = 0;
-
-	if (Attributes)
-		DodgeCost = Attributes->GetDodgeCost();
+	// The movement component turns the character, spends the stamina and calls back into PerformDodge as part of a
+	// predicted move, which the server repeats when it receives that move.
+	if (CanDodge())
+		SoulHunterMovement->RequestDodge();
+}
 
-	if (ActionState != EActionState::EAS_Unoccupied || !HasEnoughStamina(DodgeCost)) return;
+bool APlayerCharacter::CanDodge()
+{
+	return ActionState == EActionState::EAS_Unoccupied &&
+		   DodgeMontage &&
+		   Attributes && HasEnoughStamina(Attributes->GetDodgeCost());
+}
 
+void APlayerCharacter::PerformDodge()
+{
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
 
-	if (AnimInstance && DodgeMontage)
-	{
-		if (LockOnTarget->IsTargetLocked())
-		{
-			GetCharacterMovement()->bOrientRotationToMovement = true;
-			GetCharacterMovement()->bUseControllerDesiredRotation = false;
-		}
-
-
-		FVector CurrentAcceleration = GetCharacterMovement()->GetCurrentAcceleration();
-
-		if (!CurrentAcceleration.IsNearlyZero())
-		{
-			FVector AccelerationNormal = CurrentAcceleration.GetSafeNormal();
-
-			FRotator NewRotation = UKismetMathLibrary::MakeRotFromX(AccelerationNormal);
+	if (AnimInstance == nullptr)
+		return;
 
-			SetActorRotation(NewRotation);
-		}
+	if (LockOnTarget->IsTargetLocked())
+	{
+		GetCharacterMovement()->bOrientRotationToMovement = true;
+		GetCharacterMovement()->bUseControllerDesiredRotation = false;
+	}
 
-		AnimInstance->Montage_Play(DodgeMontage);
-		ActionState = EActionState::EAS_Occupied;
+	AnimInstance->Montage_Play(DodgeMontage);
+	SetActionState(EActionState::EAS_Occupied);
 
-		if (Attributes && PlayerOverlay)
-		{
-			Attributes->UseStamina(DodgeCost);
-			PlayerOverlay->SetStaminaBarPercent(Attributes->GetStaminaPercent());
-		}
-	}
+	if (HasAuthority())
+		Multicast_PlayMontageSection(DodgeMontage, NAME_None);
 }
 
 void APlayerCharacter::StartSprinting()
 {
-	float SprintCost = 0;
-
-	if (Attributes)
-		SprintCost = Attributes->GetSprintCost();
-
-	if (ActionState != EActionState::EAS_Unoccupied || !HasEnoughStamina(SprintCost)) return;
-
-	GetCharacterMovement()->MaxWalkSpeed = SprintingSpeed;
-
-	GetWorldTimerManager().SetTimer(SprintingTimer, SprintingTimerDelegate, .05f, true);
+	SoulHunterMovement->SetWantsToSprint(true);
 }
 
 void APlayerCharacter::EndSprinting()
 {
-	GetCharacterMovement()->MaxWalkSpeed = RunningSpeed;
-	GetWorldTimerManager().ClearTimer(SprintingTimer);
-}
-
-void APlayerCharacter::DepleteStaminaFromSprinting(float StaminaToDeplete)
-{
-	if (ActionState != EActionState::EAS_Unoccupied || !HasEnoughStamina(StaminaToDeplete))
-		EndSprinting();
-
-	if (GetCharacterMovement()->GetCurrentAcceleration().IsNearlyZero(3.f))
-		EndSprinting();
-
-	if (Attributes && PlayerOverlay)
-	{
-		Attributes->UseStamina(StaminaToDeplete);
-		PlayerOverlay->SetStaminaBarPercent(Attributes->GetStaminaPercent());
-	}
+	SoulHunterMovement->SetWantsToSprint(false);
 }
 
 void APlayerCharacter::ToggleLockOnTarget()
@@ -433,6 +581,8 @@ void APlayerCharacter::LockOnLeft()
 
 void APlayerCharacter::OnTargetLocked(UTargetComponent* Target, FName Socket)
 {
+	LockedTarget = Target;
+
 	GetCharacterMovement()->bOrientRotationToMovement = false;
 	GetCharacterMovement()->bUseControllerDesiredRotation = true;
 
@@ -442,6 +592,8 @@ void APlayerCharacter::OnTargetLocked(UTargetComponent* Target, FName Socket)
 
 void APlayerCharacter::OnTargetUnlocked(UTargetComponent* Target, FName Socket)
 {
+	LockedTarget = nullptr;
+
 	GetCharacterMovement()->bOrientRotationToMovement = true;
 	GetCharacterMovement()->bUseControllerDesiredRotation = false;
 
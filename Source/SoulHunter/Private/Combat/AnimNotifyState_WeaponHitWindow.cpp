@@ -0,0 +1,249 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Combat/AnimNotifyState_WeaponHitWindow.h"
+#include "Characters/BaseCharacter.h"
+#include "Characters/CharacterNames.h"
+#include "Items/Weapons/Weapon.h"
+#include "SoulHunter.h"
+#include "Animation/AnimInstance.h"
+#include "Animation/AnimMontage.h"
+#include "Animation/AnimSequence.h"
+#include "Components/SkeletalMeshComponent.h"
+
+#if WITH_EDITOR
+#include "Animation/AnimData/IAnimationDataModel.h"
+#include "Engine/SkeletalMeshSocket.h"
+#include "UObject/ObjectSaveContext.h"
+#endif
+
+DECLARE_CYCLE_STAT(TEXT("Weapon Hit Window"), STAT_WeaponHitWindow, STATGROUP_Game);
+
+UAnimNotifyState_WeaponHitWindow::UAnimNotifyState_WeaponHitWindow()
+{
+	WeaponSocket = CharacterNames::RightHandSocket;
+
+#if WITH_EDITORONLY_DATA
+	NotifyColor = FColor(200, 60, 60);
+#endif
+}
+
+FString UAnimNotifyState_WeaponHitWindow::GetNotifyName_Implementation() const
+{
+	return TEXT("Weapon Hit Window");
+}
+
+#pragma region Runtime
+
+AWeapon* UAnimNotifyState_WeaponHitWindow::GetDetectingWeapon(const USkeletalMeshComponent* MeshComp)
+{
+	const ABaseCharacter* Character = MeshComp ? Cast<ABaseCharacter>(MeshComp->GetOwner()) : nullptr;
+	AWeapon* Weapon = Character ? Character->GetEquippedWeapon() : nullptr;
+
+	return Weapon && Weapon->DetectsHits() ? Weapon : nullptr;
+}
+
+void UAnimNotifyState_WeaponHitWindow::NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration, const FAnimNotifyEventReference& EventReference)
+{
+	Super::NotifyBegin(MeshComp, Animation, TotalDuration, EventReference);
+
+	if (AWeapon* Weapon = GetDetectingWeapon(MeshComp))
+		Weapon->ResetHitIgnoreActors();
+}
+
+void UAnimNotifyState_WeaponHitWindow::NotifyTick(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float FrameDeltaTime, const FAnimNotifyEventReference& EventReference)
+{
+	Super::NotifyTick(MeshComp, Animation, FrameDeltaTime, EventReference);
+
+	SCOPE_CYCLE_COUNTER(STAT_WeaponHitWindow);
+
+	AWeapon* Weapon = GetDetectingWeapon(MeshComp);
+
+	if (Weapon == nullptr)
+		return;
+
+	const UAnimInstance* AnimInstance = MeshComp->GetAnimInstance();
+	const UAnimMontage* Montage = Cast<UAnimMontage>(Animation);
+
+	// The baked trajectory only holds for the montage and socket it was sampled for.
+	const bool bUseTrajectory = Trajectory.Num() > 0 && Montage && AnimInstance &&
+		Weapon->GetRootComponent()->GetAttachSocketName() == WeaponSocket;
+
+	if (!bUseTrajectory)
+	{
+		Weapon->TraceHitWindow(MeshComp->GetSocketTransform(WeaponSocket));
+		return;
+	}
+
+	// Sweeps fill the stretch of the window since last frame, ending at the current montage position.
+	const float Position = AnimInstance->Montage_GetPosition(Montage);
+	const float Elapsed = FMath::Abs(FrameDeltaTime * AnimInstance->Montage_GetPlayRate(Montage));
+	const int32 NumSweeps = FMath::Clamp(FMath::CeilToInt(Elapsed / SampleInterval), 1, MaxSweepsPerFrame);
+
+	const FTransform& ComponentTransform = MeshComp->GetComponentTransform();
+
+	// A fast swing can cut through several characters in one frame; their reactions are classified together.
+	Weapon->BeginHitBatch();
+
+	for (int32 Sweep = NumSweeps - 1; Sweep >= 0; --Sweep)
+	{
+		FTransform SocketTransform;
+
+		if (SampleTrajectory(Position - Elapsed * Sweep / NumSweeps, SocketTransform))
+			Weapon->TraceHitWindow(SocketTransform * ComponentTransform);
+	}
+
+	Weapon->EndHitBatch();
+}
+
+bool UAnimNotifyState_WeaponHitWindow::SampleTrajectory(float Time, FTransform& OutSocketTransform) const
+{
+	if (Trajectory.Num() == 0)
+		return false;
+
+	const float Sample = FMath::Clamp((Time - TrajectoryStartTime) / SampleInterval, 0.f, float(Trajectory.Num() - 1));
+	const int32 Index = FMath::FloorToInt(Sample);
+
+	if (Index >= Trajectory.Num() - 1)
+	{
+		OutSocketTransform = Trajectory.Last();
+		return true;
+	}
+
+	OutSocketTransform.Blend(Trajectory[Index], Trajectory[Index + 1], Sample - Index);
+	return true;
+}
+
+#pragma endregion
+
+#pragma region Baking
+
+#if WITH_EDITOR
+
+void UAnimNotifyState_WeaponHitWindow::PostLoad()
+{
+	Super::PostLoad();
+
+	TArray<FGuid> SourceGuids;
+	GetTrajectorySourceGuids(SourceGuids);
+
+	// Animations edited since the montage was saved would otherwise be swept along their old trajectory until it is resaved.
+	if (SourceGuids != TrajectorySourceGuids)
+	{
+		UE_LOG(LogSoulHunter, Log, TEXT("%s: animations changed since the hit window was baked, re-baking"), *GetOuter()->GetName());
+		BakeTrajectory();
+	}
+}
+
+void UAnimNotifyState_WeaponHitWindow::PreSave(FObjectPreSaveContext SaveContext)
+{
+	Super::PreSave(SaveContext);
+
+	BakeTrajectory();
+}
+
+void UAnimNotifyState_WeaponHitWindow::BakeTrajectory()
+{
+	Trajectory.Reset();
+	GetTrajectorySourceGuids(TrajectorySourceGuids);
+
+	const UAnimMontage* Montage = Cast<UAnimMontage>(GetOuter());
+	const USkeleton* Skeleton = Montage ? Montage->GetSkeleton() : nullptr;
+
+	if (Skeleton == nullptr || Montage->SlotAnimTracks.Num() == 0)
+		return;
+
+	const FAnimNotifyEvent* NotifyEvent = Montage->Notifies.FindByPredicate([this](const FAnimNotifyEvent& Event) { return Event.NotifyStateClass == this; });
+
+	if (NotifyEvent == nullptr)
+		return;
+
+	const FReferenceSkeleton& ReferenceSkeleton = Skeleton->GetReferenceSkeleton();
+
+	FName BoneName = WeaponSocket;
+	FTransform SocketOffset = FTransform::Identity;
+
+	if (const USkeletalMeshSocket* Socket = Skeleton->FindSocket(WeaponSocket))
+	{
+		BoneName = Socket->BoneName;
+		SocketOffset = Socket->GetSocketLocalTransform();
+	}
+
+	const int32 SocketBoneIndex = ReferenceSkeleton.FindBoneIndex(BoneName);
+
+	if (SocketBoneIndex == INDEX_NONE)
+	{
+		UE_LOG(LogSoulHunter, Warning, TEXT("%s: skeleton %s has no socket or bone %s, hits fall back to live socket reads"),
+			*Montage->GetName(), *Skeleton->GetName(), *WeaponSocket.ToString());
+		return;
+	}
+
+	const FAnimTrack& Track = Montage->SlotAnimTracks[0].AnimTrack;
+	const float WindowStart = NotifyEvent->GetTriggerTime();
+	const float WindowEnd = NotifyEvent->GetEndTriggerTime();
+
+	TrajectoryStartTime = WindowStart;
+
+	for (float Time = WindowStart; ; Time = FMath::Min(Time + SampleInterval, WindowEnd))
+	{
+		const FAnimSegment* Segment = Track.GetSegmentAtTime(Time);
+		const UAnimSequence* Sequence = Segment ? Cast<UAnimSequence>(Segment->GetAnimReference()) : nullptr;
+
+		if (Sequence == nullptr)
+		{
+			Trajectory.Reset();
+			return;
+		}
+
+		const float SequenceTime = Segment->ConvertTrackPosToAnimPos(Time);
+		FTransform SocketTransform = SocketOffset;
+
+		for (int32 BoneIndex = SocketBoneIndex; BoneIndex != INDEX_NONE; BoneIndex = ReferenceSkeleton.GetParentIndex(BoneIndex))
+		{
+			FTransform BoneTransform = ReferenceSkeleton.GetRefBonePose()[BoneIndex];
+
+			// Root motion is taken out of the pose and moves the actor instead, so the root stays at its reference pose.
+			if (BoneIndex != 0 || !Sequence->HasRootMotion())
+				Sequence->GetBoneTransform(BoneTransform, FSkeletonPoseBoneIndex(BoneIndex), SequenceTime, false);
+
+			SocketTransform = SocketTransform * BoneTransform;
+		}
+
+		Trajectory.Add(SocketTransform);
+
+		if (Time >= WindowEnd)
+			break;
+	}
+}
+
+void UAnimNotifyState_WeaponHitWindow::GetTrajectorySourceGuids(TArray<FGuid>& OutGuids) const
+{
+	OutGuids.Reset();
+
+	const UAnimMontage* Montage = Cast<UAnimMontage>(GetOuter());
+
+	if (Montage == nullptr || Montage->SlotAnimTracks.Num() == 0)
+		return;
+
+	const FAnimNotifyEvent* NotifyEvent = Montage->Notifies.FindByPredicate([this](const FAnimNotifyEvent& Event) { return Event.NotifyStateClass == this; });
+
+	if (NotifyEvent == nullptr)
+		return;
+
+	for (const FAnimSegment& Segment : Montage->SlotAnimTracks[0].AnimTrack.AnimSegments)
+	{
+		UAnimSequence* Sequence = Cast<UAnimSequence>(Segment.GetAnimReference());
+
+		if (Sequence == nullptr || Segment.StartPos > NotifyEvent->GetEndTriggerTime() || Segment.GetEndPos() < NotifyEvent->GetTriggerTime())
+			continue;
+
+		// Called from PostLoad, where the sequence may be loaded but not yet post-loaded.
+		Sequence->ConditionalPostLoad();
+
+		if (const IAnimationDataModel* DataModel = Sequence->GetDataModel())
+			OutGuids.Add(DataModel->GenerateGuid());
+	}
+}
+
+#endif
+
+#pragma endregion
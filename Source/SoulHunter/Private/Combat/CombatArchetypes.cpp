@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Combat/CombatArchetypes.h"
+#include "Combat/CombatStatTables.h"
+#include "SoulHunter.h"
+
+#if WITH_EDITOR
+
+void UEnemyArchetype::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	FCombatStatTables::Get().Recompile(this);
+}
+
+void UWeaponArchetype::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	FCombatStatTables::Get().Recompile(this);
+}
+
+void UStaminaArchetype::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	FCombatStatTables::Get().Recompile(this);
+}
+
+#endif
+
+#if WITH_EDITORONLY_DATA
+
+namespace CombatArchetypes
+{
+	template<typename ArchetypeType, typename StatsType>
+	ArchetypeType* Migrate(UObject* Owner, const StatsType& Legacy, const StatsType& TemplateLegacy)
+	{
+		if (StatsType::StaticStruct()->CompareScriptStruct(&Legacy, &TemplateLegacy, PPF_None))
+			return nullptr;
+
+		const FName Name = MakeUniqueObjectName(Owner, ArchetypeType::StaticClass(), TEXT("MigratedArchetype"));
+
+		ArchetypeType* Migrated = NewObject<ArchetypeType>(Owner, Name, Owner->GetMaskedFlags(RF_PropagateToSubObjects));
+		Migrated->Stats = Legacy;
+
+		UE_LOG(LogSoulHunter, Display, TEXT("%s: moved tuning from deprecated properties into %s, resave %s to keep it"),
+			*Owner->GetPathName(), *Migrated->GetName(), *GetNameSafe(Owner->GetOutermost()));
+
+		return Migrated;
+	}
+}
+
+UEnemyArchetype* FCombatArchetypeMigration::Migrate(UObject* Owner, const FEnemyStats& Legacy, const FEnemyStats& TemplateLegacy)
+{
+	return CombatArchetypes::Migrate<UEnemyArchetype>(Owner, Legacy, TemplateLegacy);
+}
+
+UWeaponArchetype* FCombatArchetypeMigration::Migrate(UObject* Owner, const FWeaponStats& Legacy, const FWeaponStats& TemplateLegacy)
+{
+	return CombatArchetypes::Migrate<UWeaponArchetype>(Owner, Legacy, TemplateLegacy);
+}
+
+UStaminaArchetype* FCombatArchetypeMigration::Migrate(UObject* Owner, const FStaminaStats& Legacy, const FStaminaStats& TemplateLegacy)
+{
+	return CombatArchetypes::Migrate<UStaminaArchetype>(Owner, Legacy, TemplateLegacy);
+}
+
+#endif
@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Combat/CombatStatTables.h"
+#include "SoulHunter.h"
+#include "HAL/IConsoleManager.h"
+
+namespace CombatStatTables
+{
+	template<typename ArchetypeType, typename RowType, typename CompileType>
+	int32 FindOrCompile(const ArchetypeType* Archetype, TMap<TObjectKey<ArchetypeType>, int32>& Indices, TArray<RowType>& Rows, CompileType Compile)
+	{
+		if (Archetype == nullptr)
+			return 0;
+
+		if (const int32* ExistingIndex = Indices.Find(Archetype))
+			return *ExistingIndex;
+
+		const int32 NewIndex = Rows.Add(Compile(Archetype->Stats));
+		Indices.Add(Archetype, NewIndex);
+
+		return NewIndex;
+	}
+
+	template<typename ArchetypeType, typename RowType, typename CompileType>
+	void Recompile(const ArchetypeType* Archetype, const TMap<TObjectKey<ArchetypeType>, int32>& Indices, TArray<RowType>& Rows, CompileType Compile)
+	{
+		// Assets nobody has used yet are compiled on first use anyway.
+		if (const int32* ExistingIndex = Archetype ? Indices.Find(Archetype) : nullptr)
+			Rows[*ExistingIndex] = Compile(Archetype->Stats);
+	}
+
+	template<typename StatsType>
+	StatsType CompileAsIs(const StatsType& Stats)
+	{
+		return Stats;
+	}
+}
+
+FCombatStatTables& FCombatStatTables::Get()
+{
+	static FCombatStatTables Tables;
+	return Tables;
+}
+
+FCombatStatTables::FCombatStatTables()
+{
+	EnemyRows.Add(CompileEnemyRow(FEnemyStats()));
+	WeaponRows.Add(FWeaponStats());
+	StaminaRows.Add(FStaminaStats());
+}
+
+FEnemyStatRow FCombatStatTables::CompileEnemyRow(const FEnemyStats& Stats)
+{
+	FEnemyStatRow Row;
+	Row.Stats = Stats;
+	Row.PatrolRadiusSquared = FMath::Square(Stats.PatrolRadius);
+	Row.CombatRadiusSquared = FMath::Square(Stats.CombatRadius);
+	Row.AttackRadiusSquared = FMath::Square(Stats.AttackRadius);
+	Row.SightRadiusSquared = FMath::Square(Stats.PawnSightRadius);
+	Row.CosPeripheralVision = FMath::Cos(FMath::DegreesToRadians(Stats.PawnPeripheralVisionAngle));
+
+	return Row;
+}
+
+int32 FCombatStatTables::FindOrCompile(const UEnemyArchetype* Archetype)
+{
+	return CombatStatTables::FindOrCompile(Archetype, EnemyIndices, EnemyRows, &FCombatStatTables::CompileEnemyRow);
+}
+
+int32 FCombatStatTables::FindOrCompile(const UWeaponArchetype* Archetype)
+{
+	return CombatStatTables::FindOrCompile(Archetype, WeaponIndices, WeaponRows, &CombatStatTables::CompileAsIs<FWeaponStats>);
+}
+
+int32 FCombatStatTables::FindOrCompile(const UStaminaArchetype* Archetype)
+{
+	return CombatStatTables::FindOrCompile(Archetype, StaminaIndices, StaminaRows, &CombatStatTables::CompileAsIs<FStaminaStats>);
+}
+
+void FCombatStatTables::Recompile(const UEnemyArchetype* Archetype)
+{
+	CombatStatTables::Recompile(Archetype, EnemyIndices, EnemyRows, &FCombatStatTables::CompileEnemyRow);
+}
+
+void FCombatStatTables::Recompile(const UWeaponArchetype* Archetype)
+{
+	CombatStatTables::Recompile(Archetype, WeaponIndices, WeaponRows, &CombatStatTables::CompileAsIs<FWeaponStats>);
+}
+
+void FCombatStatTables::Recompile(const UStaminaArchetype* Archetype)
+{
+	CombatStatTables::Recompile(Archetype, StaminaIndices, StaminaRows, &CombatStatTables::CompileAsIs<FStaminaStats>);
+}
+
+void FCombatStatTables::LogReport() const
+{
+	UE_LOG(LogSoulHunter, Display, TEXT("Combat stat tables: %d enemy rows (%d bytes each), %d weapon rows (%d bytes each), %d stamina rows (%d bytes each)"),
+		EnemyRows.Num(), static_cast<int32>(sizeof(FEnemyStatRow)),
+		WeaponRows.Num(), static_cast<int32>(sizeof(FWeaponStats)),
+		StaminaRows.Num(), static_cast<int32>(sizeof(FStaminaStats)));
+
+	for (const TPair<TObjectKey<UEnemyArchetype>, int32>& IndexPair : EnemyIndices)
+		UE_LOG(LogSoulHunter, Display, TEXT("  enemy   %3d  %s"), IndexPair.Value, *GetNameSafe(IndexPair.Key.ResolveObjectPtr()));
+
+	for (const TPair<TObjectKey<UWeaponArchetype>, int32>& IndexPair : WeaponIndices)
+		UE_LOG(LogSoulHunter, Display, TEXT("  weapon  %3d  %s"), IndexPair.Value, *GetNameSafe(IndexPair.Key.ResolveObjectPtr()));
+
+	for (const TPair<TObjectKey<UStaminaArchetype>, int32>& IndexPair : StaminaIndices)
+		UE_LOG(LogSoulHunter, Display, TEXT("  stamina %3d  %s"), IndexPair.Value, *GetNameSafe(IndexPair.Key.ResolveObjectPtr()));
+}
+
+namespace CombatStatTables
+{
+	static FAutoConsoleCommand ReportCommand(
+		TEXT("sh.Combat.StatTables"),
+		TEXT("Lists the compiled combat stat rows and the archetype asset each one came from."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FCombatStatTables::Get().LogReport();
+		}));
+}
@@ -0,0 +1,224 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Combat/LockOnCandidateSubsystem.h"
+#include "Enemy/Enemy.h"
+#include "Characters/CharacterNames.h"
+#include "SoulHunter.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/Engine.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Lock-On Screen Candidates"), STAT_LockOnScreenCandidates, STATGROUP_Game);
+
+#pragma region Main
+
+ULockOnCandidateSubsystem* ULockOnCandidateSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+
+	return World ? World->GetSubsystem<ULockOnCandidateSubsystem>() : nullptr;
+}
+
+bool ULockOnCandidateSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId ULockOnCandidateSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULockOnCandidateSubsystem, STATGROUP_Tickables);
+}
+
+void ULockOnCandidateSubsystem::Tick(float DeltaTime)
+{
+	// Only moved enemies change bucket; most frames this is one cell compare per candidate.
+	for (auto It = Candidates.CreateIterator(); It; ++It)
+	{
+		FCandidate& Candidate = *It;
+		const AEnemy* Enemy = Candidate.Enemy.Get();
+
+		if (Enemy == nullptr)
+		{
+			RemoveFromCell(It.GetIndex(), Candidate.Cell);
+			It.RemoveCurrent();
+			continue;
+		}
+
+		const FIntPoint Cell = GetCell(Enemy->GetActorLocation());
+
+		if (Cell == Candidate.Cell)
+			continue;
+
+		RemoveFromCell(It.GetIndex(), Candidate.Cell);
+		Cells.FindOrAdd(Cell).Add(It.GetIndex());
+		Candidate.Cell = Cell;
+	}
+
+	// Indices of destroyed enemies were dropped above, so stale map keys are cleaned up lazily here.
+	if (CandidateIndices.Num() != Candidates.Num())
+	{
+		for (auto It = CandidateIndices.CreateIterator(); It; ++It)
+		{
+			if (!Candidates.IsValidIndex(It.Value()) || Candidates[It.Value()].Enemy.Get() != It.Key().ResolveObjectPtr())
+				It.RemoveCurrent();
+		}
+	}
+
+	bCacheValid = false;
+}
+
+void ULockOnCandidateSubsystem::AddCandidate(AEnemy* Enemy)
+{
+	// Lock-on is a local player feature; a dedicated server never queries it.
+	if (Enemy == nullptr || GetWorld()->GetNetMode() == NM_DedicatedServer || CandidateIndices.Contains(Enemy))
+		return;
+
+	FCandidate Candidate;
+	Candidate.Enemy = Enemy;
+	Candidate.Target = Enemy->GetTargetComponent();
+	Candidate.Cell = GetCell(Enemy->GetActorLocation());
+
+	const int32 CandidateIndex = Candidates.Add(Candidate);
+	CandidateIndices.Add(Enemy, CandidateIndex);
+	Cells.FindOrAdd(Candidate.Cell).Add(CandidateIndex);
+
+	bCacheValid = false;
+}
+
+void ULockOnCandidateSubsystem::RemoveCandidate(AEnemy* Enemy)
+{
+	int32 CandidateIndex = INDEX_NONE;
+
+	if (!CandidateIndices.RemoveAndCopyValue(Enemy, CandidateIndex))
+		return;
+
+	RemoveFromCell(CandidateIndex, Candidates[CandidateIndex].Cell);
+	Candidates.RemoveAt(CandidateIndex);
+
+	bCacheValid = false;
+}
+
+void ULockOnCandidateSubsystem::RemoveFromCell(int32 CandidateIndex, const FIntPoint& Cell)
+{
+	TArray<int32>* CellCandidates = Cells.Find(Cell);
+
+	if (CellCandidates == nullptr)
+		return;
+
+	CellCandidates->RemoveSingleSwap(CandidateIndex, false);
+
+	if (CellCandidates->Num() == 0)
+		Cells.Remove(Cell);
+}
+
+TConstArrayView<FLockOnCandidateView> ULockOnCandidateSubsystem::GetScreenCandidates(const APlayerController* PlayerController, const FVector& Origin, float Radius)
+{
+	SCOPE_CYCLE_COUNTER(STAT_LockOnScreenCandidates);
+
+	if (bCacheValid && CachedFrame == GFrameCounter && CachedController == PlayerController && CachedRadius == Radius &&
+		CachedOrigin.Equals(Origin))
+		return CachedViews;
+
+	CachedViews.Reset();
+	CachedController = PlayerController;
+	CachedFrame = GFrameCounter;
+	CachedOrigin = Origin;
+	CachedRadius = Radius;
+	bCacheValid = true;
+
+	if (PlayerController == nullptr)
+		return CachedViews;
+
+	int32 ViewportWidth = 0;
+	int32 ViewportHeight = 0;
+	PlayerController->GetViewportSize(ViewportWidth, ViewportHeight);
+
+	if (ViewportWidth <= 0 || ViewportHeight <= 0)
+		return CachedViews;
+
+	const FVector2D ViewportScale(1.f / ViewportWidth, 1.f / ViewportHeight);
+	const float RadiusSquared = FMath::Square(Radius);
+	const FIntPoint MinCell = GetCell(Origin - FVector(Radius));
+	const FIntPoint MaxCell = GetCell(Origin + FVector(Radius));
+
+	for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+	{
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+		{
+			const TArray<int32>* CellCandidates = Cells.Find(FIntPoint(CellX, CellY));
+
+			if (CellCandidates == nullptr)
+				continue;
+
+			for (const int32 CandidateIndex : *CellCandidates)
+			{
+				const FCandidate& Candidate = Candidates[CandidateIndex];
+				const AEnemy* Enemy = Candidate.Enemy.Get();
+
+				if (Enemy == nullptr || Candidate.Target == nullptr)
+					continue;
+
+				const float DistanceSquared = FVector::DistSquared(Enemy->GetActorLocation(), Origin);
+
+				if (DistanceSquared > RadiusSquared)
+					continue;
+
+				const FVector Location = Enemy->GetMesh()->GetSocketLocation(CharacterNames::TargetWidgetSocket);
+				FVector2D ScreenPosition;
+
+				if (!PlayerController->ProjectWorldLocationToScreen(Location, ScreenPosition, true))
+					continue;
+
+				ScreenPosition *= ViewportScale;
+
+				if (ScreenPosition.X < 0.f || ScreenPosition.X > 1.f || ScreenPosition.Y < 0.f || ScreenPosition.Y > 1.f)
+					continue;
+
+				FLockOnCandidateView& View = CachedViews.AddDefaulted_GetRef();
+				View.Target = Candidate.Target;
+				View.Location = Location;
+				View.ScreenPosition = ScreenPosition;
+				View.DistanceSquared = DistanceSquared;
+			}
+		}
+	}
+
+	return CachedViews;
+}
+
+void ULockOnCandidateSubsystem::RecordQuery(double Seconds) const
+{
+	++NumQueries;
+	QuerySeconds += Seconds;
+	MaxQuerySeconds = FMath::Max(MaxQuerySeconds, Seconds);
+}
+
+void ULockOnCandidateSubsystem::LogReport() const
+{
+	UE_LOG(LogSoulHunter, Display, TEXT("Lock-on: %d candidates in %d cells, %d on screen at the last query"),
+		Candidates.Num(), Cells.Num(), CachedViews.Num());
+
+	UE_LOG(LogSoulHunter, Display, TEXT("  %lld target searches, %.3f us average, %.3f us worst"),
+		NumQueries,
+		NumQueries > 0 ? QuerySeconds * 1000000.0 / NumQueries : 0.0,
+		MaxQuerySeconds * 1000000.0);
+}
+
+#pragma endregion
+
+#pragma region Console Commands
+
+namespace LockOnCandidates
+{
+	static FAutoConsoleCommandWithWorld ReportCommand(
+		TEXT("sh.LockOn.Report"),
+		TEXT("Logs the lock-on candidate count, grid occupancy and the average and worst target search cost."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (const ULockOnCandidateSubsystem* CandidateSubsystem = ULockOnCandidateSubsystem::Get(World))
+				CandidateSubsystem->LogReport();
+		}));
+}
+
+#pragma endregion
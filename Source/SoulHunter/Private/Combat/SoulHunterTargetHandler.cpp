@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Combat/SoulHunterTargetHandler.h"
+#include "Combat/LockOnCandidateSubsystem.h"
+#include "Characters/PlayerCharacter.h"
+#include "Characters/CharacterNames.h"
+#include "GameFramework/PlayerController.h"
+
+FTargetInfo USoulHunterTargetHandler::FindTarget_Implementation(FVector2D PlayerInput)
+{
+	const APlayerCharacter* PlayerCharacter = GetTypedOuter<APlayerCharacter>();
+	const APlayerController* PlayerController = PlayerCharacter ? Cast<APlayerController>(PlayerCharacter->GetController()) : nullptr;
+	ULockOnCandidateSubsystem* CandidateSubsystem = ULockOnCandidateSubsystem::Get(PlayerCharacter);
+
+	if (PlayerController == nullptr || CandidateSubsystem == nullptr)
+		return Super::FindTarget_Implementation(PlayerInput);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	const TConstArrayView<FLockOnCandidateView> Candidates =
+		CandidateSubsystem->GetScreenCandidates(PlayerController, PlayerCharacter->GetActorLocation(), CaptureRadius);
+
+	UTargetComponent* CurrentTarget = PlayerCharacter->GetLockedTarget();
+	const bool bSwitching = CurrentTarget && !PlayerInput.IsNearlyZero();
+
+	// Switching is measured from the current target; a fresh lock from the middle of the screen.
+	FVector2D From(.5f, .5f);
+	const FVector2D Direction = bSwitching ? FVector2D(PlayerInput.X, -PlayerInput.Y).GetSafeNormal() : FVector2D::ZeroVector;
+
+	if (bSwitching)
+	{
+		for (const FLockOnCandidateView& Candidate : Candidates)
+		{
+			if (Candidate.Target == CurrentTarget)
+			{
+				From = Candidate.ScreenPosition;
+				break;
+			}
+		}
+	}
+
+	const float InvCaptureRadius = 1.f / FMath::Max(CaptureRadius, 1.f);
+	const FLockOnCandidateView* BestCandidate = nullptr;
+	float BestScore = TNumericLimits<float>::Max();
+
+	for (const FLockOnCandidateView& Candidate : Candidates)
+	{
+		if (bSwitching && Candidate.Target == CurrentTarget)
+			continue;
+
+		const FVector2D Offset = Candidate.ScreenPosition - From;
+		const float ScreenDistance = Offset.Size();
+		float Score = ScreenCenterWeight * ScreenDistance + DistanceWeight * FMath::Sqrt(Candidate.DistanceSquared) * InvCaptureRadius;
+
+		if (bSwitching)
+		{
+			const float Alignment = ScreenDistance > UE_KINDA_SMALL_NUMBER ? FVector2D::DotProduct(Offset / ScreenDistance, Direction) : 0.f;
+
+			if (Alignment < MinSwitchAlignment)
+				continue;
+
+			Score *= 2.f - Alignment;
+		}
+
+		if (Score < BestScore)
+		{
+			BestScore = Score;
+			BestCandidate = &Candidate;
+		}
+	}
+
+	CandidateSubsystem->RecordQuery(FPlatformTime::Seconds() - StartTime);
+
+	if (BestCandidate == nullptr)
+		return bSwitching ? FTargetInfo(CurrentTarget, CharacterNames::TargetWidgetSocket) : FTargetInfo::NULL_TARGET;
+
+	return FTargetInfo(BestCandidate->Target, CharacterNames::TargetWidgetSocket);
+}
@@ -2,10 +2,39 @@
 
 
 #include "Components/AttributeComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 UAttributeComponent::UAttributeComponent()
 {
 	PrimaryComponentTick.bCanEverTick = false;
+
+	SetIsReplicatedByDefault(true);
+}
+
+void UAttributeComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams SharedParams;
+	SharedParams.bIsPushBased = true;
+
+	// Health is needed by everyone for health bars, the rest only drives the owning player's HUD.
+	DOREPLIFETIME_WITH_PARAMS_FAST(UAttributeComponent, CurrentHealth, SharedParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UAttributeComponent, MaxHealth, SharedParams);
+
+	FDoRepLifetimeParams OwnerParams;
+	OwnerParams.bIsPushBased = true;
+	OwnerParams.Condition = COND_OwnerOnly;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(UAttributeComponent, MaxStamina, OwnerParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UAttributeComponent, Gold, OwnerParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UAttributeComponent, Souls, OwnerParams);
+}
+
+void UAttributeComponent::OnRep_Attributes()
+{
+	OnAttributesChanged.Broadcast();
 }
 
 void UAttributeComponent::BeginPlay()
@@ -13,14 +42,43 @@ void UAttributeComponent::BeginPlay()
 	Super::BeginPlay();
 }
 
+void UAttributeComponent::PostLoad()
+{
+	Super::PostLoad();
+
+#if WITH_EDITORONLY_DATA
+	const UAttributeComponent* Template = Cast<UAttributeComponent>(GetArchetype());
+
+	if (UStaminaArchetype* Migrated = FCombatArchetypeMigration::Migrate(this, GetDeprecatedStats(), Template ? Template->GetDeprecatedStats() : FStaminaStats()))
+		StaminaArchetype = Migrated;
+#endif
+}
+
+#if WITH_EDITORONLY_DATA
+
+FStaminaStats UAttributeComponent::GetDeprecatedStats() const
+{
+	FStaminaStats Stats;
+	Stats.DodgeCost = DodgeCost_DEPRECATED;
+	Stats.SprintCost = SprintCost_DEPRECATED / .05f;
+	Stats.StaminaRegenRate = StaminaRegenRate_DEPRECATED;
+
+	return Stats;
+}
+
+#endif
+
 void UAttributeComponent::ReceiveDamage(float Damage)
 {
 	CurrentHealth = FMath::Clamp(CurrentHealth - Damage, 0, MaxHealth);
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(UAttributeComponent, CurrentHealth, this);
+	OnAttributesChanged.Broadcast();
 }
 
 void UAttributeComponent::UseStamina(float StaminaCost)
 {
-	CurrentStamina = FMath::Clamp(CurrentStamina - StaminaCost, 0, MaxStamina);
+	SetStamina(CurrentStamina - StaminaCost);
 }
 
 float UAttributeComponent::GetHealthPercent()
@@ -41,20 +99,65 @@ bool UAttributeComponent::IsAlive()
 void UAttributeComponent::AddSouls(int32 SoulsAmount)
 {
 	Souls += SoulsAmount;
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(UAttributeComponent, Souls, this);
+	OnAttributesChanged.Broadcast();
 }
 
 void UAttributeComponent::AddGold(int32 GoldAmount)
 {
 	Gold += GoldAmount;
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(UAttributeComponent, Gold, this);
+	OnAttributesChanged.Broadcast();
 }
 
-void UAttributeComponent::RegenStamina(float DeltaTime)
+void UAttributeComponent::SetStamina(float NewStamina)
 {
-	CurrentStamina = FMath::Clamp(CurrentStamina + StaminaRegenRate * DeltaTime, 0.f, MaxStamina);
+	NewStamina = FMath::Clamp(NewStamina, 0.f, MaxStamina);
+
+	// Stamina changes every move, so a full bar must not keep refreshing the HUD.
+	if (NewStamina == CurrentStamina)
+		return;
+
+	CurrentStamina = NewStamina;
+	OnAttributesChanged.Broadcast();
 }
 
-void UAttributeComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+void UAttributeComponent::ResetVitals()
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	CurrentHealth = MaxHealth;
+	CurrentStamina = MaxStamina;
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(UAttributeComponent, CurrentHealth, this);
+	OnAttributesChanged.Broadcast();
 }
 
+FAttributeSnapshot UAttributeComponent::WriteSnapshot() const
+{
+	FAttributeSnapshot Snapshot;
+	Snapshot.Health = CurrentHealth;
+	Snapshot.Stamina = CurrentStamina;
+	Snapshot.Gold = Gold;
+	Snapshot.Souls = Souls;
+
+	return Snapshot;
+}
+
+void UAttributeComponent::ApplySnapshot(const FAttributeSnapshot& Snapshot)
+{
+	// A snapshot taken on death should not carry the player into the next level dead.
+	if (Snapshot.Health > 0.f)
+		CurrentHealth = FMath::Min(Snapshot.Health, MaxHealth);
+
+	CurrentStamina = FMath::Clamp(Snapshot.Stamina, 0.f, MaxStamina);
+	Gold = Snapshot.Gold;
+	Souls = Snapshot.Souls;
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(UAttributeComponent, CurrentHealth, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(UAttributeComponent, Gold, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(UAttributeComponent, Souls, this);
+	OnAttributesChanged.Broadcast();
+}
+
+
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Components/PickupCollectorComponent.h"
+#include "Items/Item.h"
+#include "Items/PickupSubsystem.h"
+#include "Diagnostics/TickAudit.h"
+
+UPickupCollectorComponent::UPickupCollectorComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+void UPickupCollectorComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	SH_TICK_AUDIT_SCOPE();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	const UPickupSubsystem* PickupSubsystem = UPickupSubsystem::Get(this);
+
+	if (PickupSubsystem == nullptr)
+		return;
+
+	AActor* Owner = GetOwner();
+
+	// Simulated proxies would collect on the word of a replicated position the server has not judged yet.
+	if (Owner->GetLocalRole() == ROLE_SimulatedProxy)
+		return;
+
+	const FVector Origin = Owner->GetActorLocation();
+
+	NearbyPickups.Reset();
+	PickupSubsystem->QueryPickups(Origin, MagnetRadius, NearbyPickups);
+
+	const float CollectRadiusSquared = FMath::Square(CollectRadius);
+
+	// Collecting removes the pickup from the index, which is safe here since NearbyPickups is our own copy.
+	for (AItem* Item : NearbyPickups)
+	{
+		if (FVector::DistSquared(Origin, Item->GetActorLocation()) <= CollectRadiusSquared)
+			Item->Collect(Owner);
+		else
+			Item->MoveTowardsCollector(Origin, MagnetSpeed * DeltaTime);
+	}
+}
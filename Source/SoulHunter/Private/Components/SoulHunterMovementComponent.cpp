@@ -0,0 +1,332 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Components/SoulHunterMovementComponent.h"
+#include "Components/AttributeComponent.h"
+#include "Characters/PlayerCharacter.h"
+#include "Network/NetworkStats.h"
+#include "GameFramework/Character.h"
+
+#pragma region Saved Moves
+
+class FSavedMove_SoulHunter : public FSavedMove_Character
+{
+public:
+
+	typedef FSavedMove_Character Super;
+
+	virtual void Clear() override
+	{
+		Super::Clear();
+
+		bSavedWantsToSprint = false;
+		bSavedWantsToDodge = false;
+		StartStamina = 0.f;
+		SavedStamina = 0.f;
+	}
+
+	virtual uint8 GetCompressedFlags() const override
+	{
+		uint8 Flags = Super::GetCompressedFlags();
+
+		if (bSavedWantsToSprint)
+			Flags |= FLAG_Custom_0;
+
+		if (bSavedWantsToDodge)
+			Flags |= FLAG_Custom_1;
+
+		return Flags;
+	}
+
+	virtual void SetMoveFor(ACharacter* Character, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override
+	{
+		Super::SetMoveFor(Character, InDeltaTime, NewAccel, ClientData);
+
+		const USoulHunterMovementComponent* Movement = Cast<USoulHunterMovementComponent>(Character->GetCharacterMovement());
+
+		bSavedWantsToSprint = Movement->bWantsToSprint;
+		bSavedWantsToDodge = Movement->bWantsToDodge;
+		StartStamina = Movement->GetStamina();
+	}
+
+	virtual void PostUpdate(ACharacter* Character, EPostUpdateMode PostUpdateMode) override
+	{
+		Super::PostUpdate(Character, PostUpdateMode);
+
+		SavedStamina = Cast<USoulHunterMovementComponent>(Character->GetCharacterMovement())->GetStamina();
+	}
+
+	virtual void CombineWith(const FSavedMove_Character* OldMove, ACharacter* Character, APlayerController* PlayerController, const FVector& OldStartLocation) override
+	{
+		Super::CombineWith(OldMove, Character, PlayerController, OldStartLocation);
+
+		// The combined move is simulated again from the old move's start, so its stamina is rewound along with the position.
+		const float OldStartStamina = static_cast<const FSavedMove_SoulHunter*>(OldMove)->StartStamina;
+
+		Cast<USoulHunterMovementComponent>(Character->GetCharacterMovement())->SetStamina(OldStartStamina);
+		StartStamina = OldStartStamina;
+	}
+
+	uint8 bSavedWantsToSprint : 1;
+	uint8 bSavedWantsToDodge : 1;
+
+	float StartStamina = 0.f;
+	float SavedStamina = 0.f;
+};
+
+class FNetworkPredictionData_Client_SoulHunter : public FNetworkPredictionData_Client_Character
+{
+public:
+
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_SoulHunter(const UCharacterMovementComponent& ClientMovement)
+		: Super(ClientMovement)
+	{
+	}
+
+	virtual FSavedMovePtr AllocateNewMove() override
+	{
+		return FSavedMovePtr(new FSavedMove_SoulHunter());
+	}
+};
+
+#pragma endregion
+
+#pragma region Network Data
+
+namespace SoulHunterMovement
+{
+	// Stamina travels as tenths in 16 bits, well inside the correction tolerance.
+	void SerializeStamina(FArchive& Ar, float& Stamina)
+	{
+		uint16 Quantized = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(Stamina * 10.f), 0, static_cast<int32>(MAX_uint16)));
+		Ar << Quantized;
+
+		if (Ar.IsLoading())
+			Stamina = Quantized / 10.f;
+	}
+}
+
+void FSoulHunterNetworkMoveData::ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType)
+{
+	FCharacterNetworkMoveData::ClientFillNetworkMoveData(ClientMove, MoveType);
+
+	Stamina = static_cast<const FSavedMove_SoulHunter&>(ClientMove).SavedStamina;
+}
+
+bool FSoulHunterNetworkMoveData::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType)
+{
+	FCharacterNetworkMoveData::Serialize(CharacterMovement, Ar, PackageMap, MoveType);
+
+	SoulHunterMovement::SerializeStamina(Ar, Stamina);
+
+	return !Ar.IsError();
+}
+
+FSoulHunterNetworkMoveDataContainer::FSoulHunterNetworkMoveDataContainer()
+{
+	NewMoveData = &MoveData[0];
+	PendingMoveData = &MoveData[1];
+	OldMoveData = &MoveData[2];
+}
+
+void FSoulHunterMoveResponseDataContainer::ServerFillResponseData(const UCharacterMovementComponent& CharacterMovement, const FClientAdjustment& PendingAdjustment)
+{
+	FCharacterMoveResponseDataContainer::ServerFillResponseData(CharacterMovement, PendingAdjustment);
+
+	Stamina = static_cast<const USoulHunterMovementComponent&>(CharacterMovement).GetStamina();
+}
+
+bool FSoulHunterMoveResponseDataContainer::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap)
+{
+	if (!FCharacterMoveResponseDataContainer::Serialize(CharacterMovement, Ar, PackageMap))
+		return false;
+
+	// Acknowledgements only carry a timestamp, so stamina rides along with corrections only.
+	if (IsCorrection())
+		SoulHunterMovement::SerializeStamina(Ar, Stamina);
+
+	return !Ar.IsError();
+}
+
+#pragma endregion
+
+#pragma region Main
+
+USoulHunterMovementComponent::USoulHunterMovementComponent()
+{
+	MaxWalkSpeed = 500.f;
+
+	bWantsToSprint = false;
+	bWantsToDodge = false;
+	bIsSprinting = false;
+	bPendingPositionCorrection = false;
+
+	SetNetworkMoveDataContainer(MoveDataContainer);
+	SetMoveResponseDataContainer(MoveResponseDataContainer);
+}
+
+float USoulHunterMovementComponent::GetMaxSpeed() const
+{
+	if (bIsSprinting && IsMovingOnGround())
+		return MaxSprintSpeed;
+
+	return Super::GetMaxSpeed();
+}
+
+void USoulHunterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	bWantsToSprint = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+	bWantsToDodge = (Flags & FSavedMove_Character::FLAG_Custom_1) != 0;
+}
+
+FNetworkPredictionData_Client* USoulHunterMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		USoulHunterMovementComponent* MutableThis = const_cast<USoulHunterMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_SoulHunter(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+float USoulHunterMovementComponent::GetStamina() const
+{
+	const UAttributeComponent* Attributes = GetAttributes();
+
+	return Attributes ? Attributes->GetStamina() : 0.f;
+}
+
+void USoulHunterMovementComponent::SetStamina(float NewStamina)
+{
+	if (UAttributeComponent* Attributes = GetAttributes())
+		Attributes->SetStamina(NewStamina);
+}
+
+APlayerCharacter* USoulHunterMovementComponent::GetPlayerOwner() const
+{
+	return Cast<APlayerCharacter>(CharacterOwner);
+}
+
+UAttributeComponent* USoulHunterMovementComponent::GetAttributes() const
+{
+	const APlayerCharacter* PlayerOwner = GetPlayerOwner();
+
+	return PlayerOwner ? PlayerOwner->GetAttributes() : nullptr;
+}
+
+#pragma endregion
+
+#pragma region Movement
+
+void USoulHunterMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	if (bWantsToDodge)
+	{
+		bWantsToDodge = false;
+		PerformDodge();
+	}
+
+	bIsSprinting = CanSprint();
+}
+
+void USoulHunterMovementComponent::UpdateCharacterStateAfterMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateAfterMovement(DeltaSeconds);
+
+	const UAttributeComponent* Attributes = GetAttributes();
+
+	if (Attributes == nullptr)
+		return;
+
+	// Stamina is advanced by the moves themselves rather than by timers, so replaying a move gives the same result.
+	float StaminaDelta = Attributes->GetStaminaRegenRate() * DeltaSeconds;
+
+	if (bIsSprinting)
+		StaminaDelta -= Attributes->GetSprintCost() * DeltaSeconds;
+
+	SetStamina(GetStamina() + StaminaDelta);
+}
+
+bool USoulHunterMovementComponent::CanSprint() const
+{
+	const APlayerCharacter* PlayerOwner = GetPlayerOwner();
+
+	return bWantsToSprint &&
+		   PlayerOwner && PlayerOwner->IsUnoccupied() &&
+		   GetStamina() > 0.f &&
+		   !Acceleration.IsNearlyZero(3.f);
+}
+
+void USoulHunterMovementComponent::PerformDodge()
+{
+	APlayerCharacter* PlayerOwner = GetPlayerOwner();
+	UAttributeComponent* Attributes = GetAttributes();
+
+	if (PlayerOwner == nullptr || Attributes == nullptr)
+		return;
+
+	// A replayed move repeats a dodge the client already committed to, its action state has moved on since.
+	const bool bReplaying = CharacterOwner->bClientUpdating;
+
+	if (!bReplaying && !PlayerOwner->CanDodge())
+		return;
+
+	FRotator DodgeRotation = UpdatedComponent->GetComponentRotation();
+
+	if (!Acceleration.IsNearlyZero())
+		DodgeRotation = FRotator(0.f, Acceleration.Rotation().Yaw, 0.f);
+
+	MoveUpdatedComponent(FVector::ZeroVector, DodgeRotation, false);
+
+	Attributes->UseStamina(Attributes->GetDodgeCost());
+
+	if (!bReplaying)
+		PlayerOwner->PerformDodge();
+}
+
+bool USoulHunterMovementComponent::ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientLoc, const FVector& RelativeClientLoc, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode)
+{
+	if (Super::ServerCheckClientError(ClientTimeStamp, DeltaTime, Accel, ClientLoc, RelativeClientLoc, ClientMovementBase, ClientBaseBoneName, ClientMovementMode))
+	{
+		bPendingPositionCorrection = true;
+		return true;
+	}
+
+	const FSoulHunterNetworkMoveData* MoveData = static_cast<const FSoulHunterNetworkMoveData*>(GetCurrentNetworkMoveData());
+
+	return MoveData && FMath::Abs(MoveData->Stamina - GetStamina()) > StaminaErrorTolerance;
+}
+
+void USoulHunterMovementComponent::SendClientAdjustment()
+{
+	const FNetworkPredictionData_Server_Character* ServerData = HasPredictionData_Server() ? GetPredictionData_Server_Character() : nullptr;
+	const bool bCorrectionPending = ServerData && ServerData->PendingAdjustment.TimeStamp > 0.f && !ServerData->PendingAdjustment.bAckGoodMove;
+
+	Super::SendClientAdjustment();
+
+	// Errors found between sends fold into one adjustment, which is cleared once it goes out.
+	if (ServerData == nullptr || ServerData->PendingAdjustment.TimeStamp > 0.f)
+		return;
+
+	if (bCorrectionPending)
+		FNetworkStats::RecordMoveCorrection(!bPendingPositionCorrection);
+
+	bPendingPositionCorrection = false;
+}
+
+void USoulHunterMovementComponent::ClientHandleMoveResponse(const FCharacterMoveResponseDataContainer& MoveResponse)
+{
+	// Set before the saved moves are replayed on top of the corrected state.
+	if (MoveResponse.IsCorrection())
+		SetStamina(static_cast<const FSoulHunterMoveResponseDataContainer&>(MoveResponse).Stamina);
+
+	Super::ClientHandleMoveResponse(MoveResponse);
+}
+
+#pragma endregion
@@ -0,0 +1,196 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Diagnostics/ActorFootprint.h"
+#include "SoulHunter.h"
+#include "Enemy/Enemy.h"
+#include "Items/Weapons/Weapon.h"
+#include "Items/Soul.h"
+#include "Items/Treasure.h"
+#include "Breakable/BreakableActor.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "UObject/UObjectHash.h"
+
+#pragma region Main
+
+TArray<UClass*> FActorFootprint::GetDefaultClasses()
+{
+	return { AEnemy::StaticClass(), AWeapon::StaticClass(), ASoul::StaticClass(), ATreasure::StaticClass(), ABreakableActor::StaticClass() };
+}
+
+TArray<FActorFootprint> FActorFootprint::MeasureClasses(TConstArrayView<UClass*> ActorClasses)
+{
+	TArray<FActorFootprint> Footprints;
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("FootprintWorld"));
+
+	if (World == nullptr)
+		return Footprints;
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	for (UClass* ActorClass : ActorClasses)
+	{
+		FActorFootprint Footprint;
+
+		if (SpawnAndMeasure(World, ActorClass, Footprint))
+			Footprints.Add(MoveTemp(Footprint));
+		else
+			UE_LOG(LogSoulHunter, Warning, TEXT("Footprint: could not spawn %s"), *GetNameSafe(ActorClass));
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return Footprints;
+}
+
+bool FActorFootprint::SpawnAndMeasure(UWorld* World, UClass* ActorClass, FActorFootprint& OutFootprint)
+{
+	if (ActorClass == nullptr || !ActorClass->IsChildOf<AActor>() || ActorClass->HasAnyClassFlags(CLASS_Abstract))
+		return false;
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParameters.ObjectFlags |= RF_Transient;
+
+	AActor* Actor = World->SpawnActor<AActor>(ActorClass, FTransform::Identity, SpawnParameters);
+
+	if (Actor == nullptr)
+		return false;
+
+	MeasureActor(Actor, OutFootprint);
+
+	World->DestroyActor(Actor);
+
+	return true;
+}
+
+void FActorFootprint::MeasureActor(AActor* Actor, FActorFootprint& OutFootprint)
+{
+	// What BeginPlay would register. Tick functions that start disabled stay disabled and are not counted.
+	Actor->RegisterAllActorTickFunctions(true, true);
+
+	TArray<UObject*> Objects;
+	GetObjectsWithOuter(Actor, Objects, true);
+	Objects.Insert(Actor, 0);
+
+	OutFootprint.ClassName = Actor->GetClass()->GetName();
+
+	for (UObject* Object : Objects)
+	{
+		FArchiveCountMem CountMem(Object);
+
+		FObjectFootprint& ObjectFootprint = OutFootprint.Objects.AddDefaulted_GetRef();
+		ObjectFootprint.Name = Object->GetName();
+		ObjectFootprint.ClassName = Object->GetClass()->GetName();
+		ObjectFootprint.Bytes = Object->GetClass()->GetStructureSize() + CountMem.GetMax();
+
+		const FTickFunction* TickFunction = nullptr;
+
+		if (UActorComponent* Component = Cast<UActorComponent>(Object))
+		{
+			ObjectFootprint.bComponent = true;
+			TickFunction = &Component->PrimaryComponentTick;
+			++OutFootprint.NumComponents;
+		}
+		else if (Object == Actor)
+		{
+			TickFunction = &Actor->PrimaryActorTick;
+		}
+
+		ObjectFootprint.bTicks = TickFunction && TickFunction->IsTickFunctionRegistered() && TickFunction->IsTickFunctionEnabled();
+
+		++OutFootprint.NumObjects;
+		OutFootprint.NumTickFunctions += ObjectFootprint.bTicks ? 1 : 0;
+		OutFootprint.InstanceBytes += Object->GetClass()->GetStructureSize();
+		OutFootprint.AllocatedBytes += CountMem.GetMax();
+	}
+}
+
+#pragma endregion
+
+#pragma region Output
+
+void FActorFootprint::LogTable(TConstArrayView<FActorFootprint> Footprints, bool bVerbose)
+{
+	UE_LOG(LogSoulHunter, Display, TEXT("%-32s %8s %10s %6s %10s %10s %10s"),
+		TEXT("Class"), TEXT("Objects"), TEXT("Components"), TEXT("Ticks"), TEXT("Instance"), TEXT("Allocated"), TEXT("Total"));
+
+	for (const FActorFootprint& Footprint : Footprints)
+	{
+		UE_LOG(LogSoulHunter, Display, TEXT("%-32s %8d %10d %6d %10lld %10lld %10lld"),
+			*Footprint.ClassName,
+			Footprint.NumObjects,
+			Footprint.NumComponents,
+			Footprint.NumTickFunctions,
+			Footprint.InstanceBytes,
+			Footprint.AllocatedBytes,
+			Footprint.GetTotalBytes());
+
+		if (!bVerbose)
+			continue;
+
+		for (const FObjectFootprint& Object : Footprint.Objects)
+		{
+			UE_LOG(LogSoulHunter, Display, TEXT("    %-40s %-36s %8lld%s"),
+				*Object.Name, *Object.ClassName, Object.Bytes, Object.bTicks ? TEXT("  ticks") : TEXT(""));
+		}
+	}
+}
+
+FString FActorFootprint::ToCsv(TConstArrayView<FActorFootprint> Footprints)
+{
+	FString Csv = TEXT("Class,Objects,Components,TickFunctions,InstanceBytes,AllocatedBytes,TotalBytes\n");
+
+	for (const FActorFootprint& Footprint : Footprints)
+	{
+		Csv += FString::Printf(TEXT("%s,%d,%d,%d,%lld,%lld,%lld\n"),
+			*Footprint.ClassName,
+			Footprint.NumObjects,
+			Footprint.NumComponents,
+			Footprint.NumTickFunctions,
+			Footprint.InstanceBytes,
+			Footprint.AllocatedBytes,
+			Footprint.GetTotalBytes());
+	}
+
+	return Csv;
+}
+
+#pragma endregion
+
+#pragma region Console Commands
+
+namespace ActorFootprint
+{
+	static FAutoConsoleCommandWithArgs ReportCommand(
+		TEXT("sh.Footprint.Report"),
+		TEXT("Spawns gameplay actor classes into a throwaway world and logs their object counts, bytes and tick functions: ")
+		TEXT("sh.Footprint.Report [Verbose] [ClassPath...]. Without class paths the C++ gameplay classes are measured."),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			bool bVerbose = false;
+			TArray<UClass*> ActorClasses;
+
+			for (const FString& Arg : Args)
+			{
+				if (Arg.Equals(TEXT("Verbose"), ESearchCase::IgnoreCase))
+					bVerbose = true;
+				else if (UClass* ActorClass = LoadClass<AActor>(nullptr, *Arg))
+					ActorClasses.Add(ActorClass);
+				else
+					UE_LOG(LogSoulHunter, Warning, TEXT("Footprint: %s is not an actor class"), *Arg);
+			}
+
+			if (ActorClasses.Num() == 0)
+				ActorClasses = FActorFootprint::GetDefaultClasses();
+
+			FActorFootprint::LogTable(FActorFootprint::MeasureClasses(ActorClasses), bVerbose);
+		}));
+}
+
+#pragma endregion
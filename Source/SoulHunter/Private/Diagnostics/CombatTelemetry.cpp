@@ -0,0 +1,339 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Diagnostics/CombatTelemetry.h"
+#include "SoulHunter.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DelayedAutoRegister.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "UObject/ObjectKey.h"
+
+DECLARE_CYCLE_STAT(TEXT("Combat Telemetry Record"), STAT_CombatTelemetryRecord, STATGROUP_Game);
+
+std::atomic<bool> FCombatTelemetry::bRecording(false);
+
+namespace CombatTelemetry
+{
+	/** Events one thread can hold between flushes. A power of two, so ring positions wrap with a mask. */
+	constexpr uint32 RingCapacity = 4096;
+
+	constexpr float FlushInterval = .5f;
+
+	/**
+	 * An event as it waits in a ring. Objects are kept as raw keys, which cost two loads to build, and the writer thread
+	 * swaps them for the compact ids of FCombatTelemetryRecord.
+	 */
+	struct FPendingEvent
+	{
+		float Time;
+		ECombatTelemetryEvent Type;
+		uint8 Detail;
+		FObjectKey Source;
+		FObjectKey Target;
+		float Value;
+	};
+
+	/** Written by its own thread only; read and emptied by the writer thread only. */
+	struct FThreadRing
+	{
+		FPendingEvent Events[RingCapacity];
+		std::atomic<uint32> Head{ 0 };
+		std::atomic<uint32> Tail{ 0 };
+		std::atomic<uint32> NumDropped{ 0 };
+	};
+
+	/** Rings outlive their threads, so a thread that exits mid-session still has its last events written. */
+	FCriticalSection RingsLock;
+	TArray<FThreadRing*> Rings;
+	thread_local FThreadRing* LocalRing = nullptr;
+
+	double StartSeconds = 0.0;
+
+	class FWriter : public FRunnable
+	{
+	public:
+
+		explicit FWriter(IFileHandle* InFile)
+			: File(InFile)
+		{
+			WakeEvent = FPlatformProcess::GetSynchEventFromPool();
+		}
+
+		virtual ~FWriter() override
+		{
+			FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		}
+
+		virtual uint32 Run() override
+		{
+			while (!bStopping.load())
+			{
+				WakeEvent->Wait(FTimespan::FromSeconds(FlushInterval));
+				Drain();
+			}
+
+			Drain();
+			delete File;
+
+			return 0;
+		}
+
+		virtual void Stop() override
+		{
+			bStopping.store(true);
+			WakeEvent->Trigger();
+		}
+
+		int64 NumWritten = 0;
+		int64 NumDropped = 0;
+
+	private:
+
+		void Drain()
+		{
+			TArray<FThreadRing*, TInlineAllocator<16>> RingsToDrain;
+			{
+				FScopeLock Lock(&RingsLock);
+				RingsToDrain.Append(Rings);
+			}
+
+			for (FThreadRing* Ring : RingsToDrain)
+			{
+				const uint32 Tail = Ring->Tail.load(std::memory_order_relaxed);
+				const uint32 Head = Ring->Head.load(std::memory_order_acquire);
+
+				for (uint32 Position = Tail; Position != Head; ++Position)
+				{
+					const FPendingEvent& Pending = Ring->Events[Position & (RingCapacity - 1)];
+
+					FCombatTelemetryRecord& Event = Buffer.AddDefaulted_GetRef();
+					Event.Time = Pending.Time;
+					Event.Type = Pending.Type;
+					Event.Detail = Pending.Detail;
+					Event.SourceId = GetObjectId(Pending.Source);
+					Event.TargetId = GetObjectId(Pending.Target);
+					Event.Value = Pending.Value;
+				}
+
+				Ring->Tail.store(Head, std::memory_order_release);
+				NumDropped += Ring->NumDropped.exchange(0, std::memory_order_relaxed);
+			}
+
+			if (Buffer.Num() == 0)
+				return;
+
+			File->Write(reinterpret_cast<const uint8*>(Buffer.GetData()), Buffer.Num() * sizeof(FCombatTelemetryRecord));
+			NumWritten += Buffer.Num();
+			Buffer.Reset();
+		}
+
+		/**
+		 * Object unique ids are recycled once an object is collected, so a dead enemy and the soul spawned after it could
+		 * share one. Keys carry the slot's serial number as well, so each object gets its own id. Only the writer thread
+		 * touches the map, and it goes away with the writer at the end of the session.
+		 */
+		uint32 GetObjectId(const FObjectKey& Key)
+		{
+			if (Key == FObjectKey())
+				return 0;
+
+			uint32& Id = ObjectIds.FindOrAdd(Key, 0);
+
+			if (Id == 0)
+				Id = NextObjectId++;
+
+			return Id;
+		}
+
+		IFileHandle* File;
+		FEvent* WakeEvent;
+		std::atomic<bool> bStopping{ false };
+		TArray<FCombatTelemetryRecord> Buffer;
+		TMap<FObjectKey, uint32> ObjectIds;
+		uint32 NextObjectId = 1;
+	};
+
+	FWriter* Writer = nullptr;
+	FRunnableThread* WriterThread = nullptr;
+	FString FilePath;
+}
+
+#pragma region Recording
+
+bool FCombatTelemetry::Start(const FString& Path)
+{
+	using namespace CombatTelemetry;
+
+	if (Writer)
+		return false;
+
+	FilePath = Path.IsEmpty()
+		? FPaths::ProjectSavedDir() / TEXT("Telemetry") / FString::Printf(TEXT("Combat-%s.bin"), *FDateTime::Now().ToString())
+		: Path;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FilePath));
+
+	IFileHandle* File = PlatformFile.OpenWrite(*FilePath);
+
+	if (File == nullptr)
+	{
+		UE_LOG(LogSoulHunter, Error, TEXT("Telemetry: could not open %s"), *FilePath);
+		return false;
+	}
+
+	FCombatTelemetryHeader Header;
+	Header.StartTicks = FDateTime::UtcNow().GetTicks();
+	File->Write(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+
+	// Whatever was left in the rings by the last session is skipped.
+	{
+		FScopeLock Lock(&RingsLock);
+
+		for (FThreadRing* Ring : Rings)
+			Ring->Tail.store(Ring->Head.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+	StartSeconds = FPlatformTime::Seconds();
+
+	Writer = new FWriter(File);
+	WriterThread = FRunnableThread::Create(Writer, TEXT("CombatTelemetryWriter"), 0, TPri_BelowNormal);
+
+	bRecording.store(true);
+
+	UE_LOG(LogSoulHunter, Display, TEXT("Telemetry: recording combat events to %s"), *FilePath);
+	return true;
+}
+
+void FCombatTelemetry::Stop()
+{
+	using namespace CombatTelemetry;
+
+	if (Writer == nullptr)
+		return;
+
+	bRecording.store(false);
+
+	// Kill waits for Run to return, which drains one last time and closes the file.
+	WriterThread->Kill(true);
+
+	UE_LOG(LogSoulHunter, Display, TEXT("Telemetry: wrote %lld combat events to %s, dropped %lld"), Writer->NumWritten, *FilePath, Writer->NumDropped);
+
+	delete WriterThread;
+	delete Writer;
+	WriterThread = nullptr;
+	Writer = nullptr;
+}
+
+void FCombatTelemetry::Record(ECombatTelemetryEvent Type, const UObject* Source, const UObject* Target, float Value, uint8 Detail)
+{
+	using namespace CombatTelemetry;
+
+	SCOPE_CYCLE_COUNTER(STAT_CombatTelemetryRecord);
+
+	FThreadRing* Ring = LocalRing;
+
+	if (Ring == nullptr)
+	{
+		Ring = new FThreadRing();
+		LocalRing = Ring;
+
+		FScopeLock Lock(&RingsLock);
+		Rings.Add(Ring);
+	}
+
+	const uint32 Head = Ring->Head.load(std::memory_order_relaxed);
+
+	if (Head - Ring->Tail.load(std::memory_order_acquire) >= RingCapacity)
+	{
+		Ring->NumDropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	FPendingEvent& Event = Ring->Events[Head & (RingCapacity - 1)];
+	Event.Time = float(FPlatformTime::Seconds() - StartSeconds);
+	Event.Type = Type;
+	Event.Detail = Detail;
+	Event.Source = FObjectKey(Source);
+	Event.Target = FObjectKey(Target);
+	Event.Value = Value;
+
+	Ring->Head.store(Head + 1, std::memory_order_release);
+}
+
+#pragma endregion
+
+#pragma region Reading
+
+bool FCombatTelemetry::ReadFile(const FString& Path, FCombatTelemetryHeader& OutHeader, TArray<FCombatTelemetryRecord>& OutRecords)
+{
+	TArray<uint8> Bytes;
+
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path) || Bytes.Num() < int32(sizeof(FCombatTelemetryHeader)))
+		return false;
+
+	FMemory::Memcpy(&OutHeader, Bytes.GetData(), sizeof(FCombatTelemetryHeader));
+
+	if (OutHeader.Magic != FCombatTelemetryHeader::ExpectedMagic || OutHeader.Version != FCombatTelemetryHeader::CurrentVersion ||
+		OutHeader.RecordSize != sizeof(FCombatTelemetryRecord))
+		return false;
+
+	// A session that was killed mid-write can end in a partial record, which is left out.
+	const int32 NumRecords = (Bytes.Num() - sizeof(FCombatTelemetryHeader)) / sizeof(FCombatTelemetryRecord);
+
+	OutRecords.SetNumUninitialized(NumRecords);
+	FMemory::Memcpy(OutRecords.GetData(), Bytes.GetData() + sizeof(FCombatTelemetryHeader), NumRecords * sizeof(FCombatTelemetryRecord));
+
+	return true;
+}
+
+const TCHAR* FCombatTelemetry::GetEventName(ECombatTelemetryEvent Type)
+{
+	switch (Type)
+	{
+	case ECombatTelemetryEvent::Hit: return TEXT("Hit");
+	case ECombatTelemetryEvent::Damage: return TEXT("Damage");
+	case ECombatTelemetryEvent::Death: return TEXT("Death");
+	case ECombatTelemetryEvent::Pickup: return TEXT("Pickup");
+	case ECombatTelemetryEvent::Drop: return TEXT("Drop");
+	case ECombatTelemetryEvent::StateTransition: return TEXT("StateTransition");
+	case ECombatTelemetryEvent::Trace: return TEXT("Trace");
+	default: return TEXT("Unknown");
+	}
+}
+
+#pragma endregion
+
+#pragma region Console Commands
+
+namespace CombatTelemetry
+{
+	static FAutoConsoleCommandWithArgs StartCommand(
+		TEXT("sh.Telemetry.Start"),
+		TEXT("Starts recording combat events: sh.Telemetry.Start [Path]. Defaults to Saved/Telemetry."),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			FCombatTelemetry::Start(Args.Num() > 0 ? Args[0] : FString());
+		}));
+
+	static FAutoConsoleCommand StopCommand(
+		TEXT("sh.Telemetry.Stop"),
+		TEXT("Stops recording combat events and closes the log."),
+		FConsoleCommandDelegate::CreateStatic(&FCombatTelemetry::Stop));
+
+	static FDelayedAutoRegisterHelper CommandLineStart(EDelayedRegisterRunPhase::EndOfEngineInit, []()
+	{
+		if (FParse::Param(FCommandLine::Get(), TEXT("CombatTelemetry")))
+			FCombatTelemetry::Start();
+
+		FCoreDelegates::OnPreExit.AddStatic(&FCombatTelemetry::Stop);
+	});
+}
+
+#pragma endregion
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Diagnostics/CombatTelemetryCommandlet.h"
+#include "Diagnostics/CombatTelemetry.h"
+#include "SoulHunter.h"
+#include "Algo/StableSort.h"
+#include "Containers/StaticArray.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+UCombatTelemetryCommandlet::UCombatTelemetryCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UCombatTelemetryCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamValues;
+	ParseCommandLine(*Params, Tokens, Switches, ParamValues);
+
+	const FString* InputPath = ParamValues.Find(TEXT("Input"));
+
+	if (InputPath == nullptr)
+	{
+		UE_LOG(LogSoulHunter, Error, TEXT("Telemetry: -Input=<log> is required"));
+		return 1;
+	}
+
+	FCombatTelemetryHeader Header;
+	TArray<FCombatTelemetryRecord> Records;
+
+	if (!FCombatTelemetry::ReadFile(*InputPath, Header, Records))
+	{
+		UE_LOG(LogSoulHunter, Error, TEXT("Telemetry: %s is missing or not a combat telemetry log"), **InputPath);
+		return 1;
+	}
+
+	// Each thread's events arrive in order, but threads are drained one after another.
+	Algo::StableSortBy(Records, &FCombatTelemetryRecord::Time);
+
+	FString Csv = TEXT("Time,Event,Detail,Source,Target,Value\n");
+	Csv.Reserve(Csv.Len() + Records.Num() * 48);
+
+	constexpr int32 NumEventTypes = static_cast<int32>(ECombatTelemetryEvent::Count);
+	TArray<TStaticArray<int32, NumEventTypes>> PerMinute;
+
+	for (const FCombatTelemetryRecord& Record : Records)
+	{
+		const int32 EventIndex = FMath::Min(static_cast<int32>(Record.Type), NumEventTypes - 1);
+
+		Csv += FString::Printf(TEXT("%.3f,%s,%u,%u,%u,%g\n"),
+			Record.Time, FCombatTelemetry::GetEventName(Record.Type), Record.Detail, Record.SourceId, Record.TargetId, Record.Value);
+
+		const int32 Minute = FMath::Max(FMath::FloorToInt(Record.Time / 60.f), 0);
+
+		while (PerMinute.Num() <= Minute)
+		{
+			TStaticArray<int32, NumEventTypes>& Counts = PerMinute.AddDefaulted_GetRef();
+
+			for (int32& Count : Counts)
+				Count = 0;
+		}
+
+		++PerMinute[Minute][EventIndex];
+	}
+
+	const FString* OutputParam = ParamValues.Find(TEXT("Output"));
+	const FString OutputPath = OutputParam ? *OutputParam : FPaths::ChangeExtension(*InputPath, TEXT("csv"));
+
+	if (!FFileHelper::SaveStringToFile(Csv, *OutputPath))
+	{
+		UE_LOG(LogSoulHunter, Error, TEXT("Telemetry: could not write %s"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogSoulHunter, Display, TEXT("Telemetry: %d events from a session started %s (UTC), written to %s"),
+		Records.Num(), *FDateTime(Header.StartTicks).ToString(), *OutputPath);
+
+	FString HeaderLine = TEXT("  Minute");
+
+	for (int32 EventIndex = 0; EventIndex < NumEventTypes; ++EventIndex)
+		HeaderLine += FString::Printf(TEXT(" %15s"), FCombatTelemetry::GetEventName(static_cast<ECombatTelemetryEvent>(EventIndex)));
+
+	UE_LOG(LogSoulHunter, Display, TEXT("%s"), *HeaderLine);
+
+	for (int32 Minute = 0; Minute < PerMinute.Num(); ++Minute)
+	{
+		FString Line = FString::Printf(TEXT("  %6d"), Minute);
+
+		for (const int32 Count : PerMinute[Minute])
+			Line += FString::Printf(TEXT(" %15d"), Count);
+
+		UE_LOG(LogSoulHunter, Display, TEXT("%s"), *Line);
+	}
+
+	return 0;
+}
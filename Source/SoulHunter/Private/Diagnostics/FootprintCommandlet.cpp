@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Diagnostics/FootprintCommandlet.h"
+#include "Diagnostics/ActorFootprint.h"
+#include "SoulHunter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+UFootprintCommandlet::UFootprintCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UFootprintCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamValues;
+	ParseCommandLine(*Params, Tokens, Switches, ParamValues);
+
+	TArray<UClass*> ActorClasses = FActorFootprint::GetDefaultClasses();
+
+	for (const FFootprintBudget& Budget : Budgets)
+	{
+		if (UClass* ActorClass = Budget.ActorClass.LoadSynchronous())
+			ActorClasses.AddUnique(ActorClass);
+		else
+			UE_LOG(LogSoulHunter, Error, TEXT("Footprint: budgeted class %s could not be loaded"), *Budget.ActorClass.ToString());
+	}
+
+	if (const FString* ClassList = ParamValues.Find(TEXT("Classes")))
+	{
+		TArray<FString> ClassPaths;
+		ClassList->ParseIntoArray(ClassPaths, TEXT("+"));
+
+		for (const FString& ClassPath : ClassPaths)
+		{
+			if (UClass* ActorClass = LoadClass<AActor>(nullptr, *ClassPath))
+				ActorClasses.AddUnique(ActorClass);
+			else
+				UE_LOG(LogSoulHunter, Error, TEXT("Footprint: %s is not an actor class"), *ClassPath);
+		}
+	}
+
+	const TArray<FActorFootprint> Footprints = FActorFootprint::MeasureClasses(ActorClasses);
+	FActorFootprint::LogTable(Footprints, Switches.Contains(TEXT("Verbose")));
+
+	const FString* OutputParam = ParamValues.Find(TEXT("Output"));
+	const FString OutputPath = OutputParam ? *OutputParam : FPaths::ProjectSavedDir() / TEXT("Footprint") / TEXT("Footprint.csv");
+
+	if (!FFileHelper::SaveStringToFile(FActorFootprint::ToCsv(Footprints), *OutputPath))
+		UE_LOG(LogSoulHunter, Error, TEXT("Footprint: could not write %s"), *OutputPath);
+
+	int32 NumOverBudget = 0;
+
+	for (const FFootprintBudget& Budget : Budgets)
+	{
+		const UClass* ActorClass = Budget.ActorClass.Get();
+		const FActorFootprint* Footprint = ActorClass
+			? Footprints.FindByPredicate([ActorClass](const FActorFootprint& Entry) { return Entry.ClassName == ActorClass->GetName(); })
+			: nullptr;
+
+		if (Footprint == nullptr)
+		{
+			++NumOverBudget;
+			continue;
+		}
+
+		const bool bOverObjects = Budget.MaxObjects > 0 && Footprint->NumObjects > Budget.MaxObjects;
+		const bool bOverBytes = Budget.MaxBytes > 0 && Footprint->GetTotalBytes() > Budget.MaxBytes;
+		const bool bOverTicks = Budget.MaxTickFunctions > 0 && Footprint->NumTickFunctions > Budget.MaxTickFunctions;
+
+		if (!bOverObjects && !bOverBytes && !bOverTicks)
+			continue;
+
+		UE_LOG(LogSoulHunter, Error, TEXT("Footprint: %s is over budget (objects %d/%d, bytes %lld/%lld, ticks %d/%d)"),
+			*Footprint->ClassName,
+			Footprint->NumObjects, Budget.MaxObjects,
+			Footprint->GetTotalBytes(), Budget.MaxBytes,
+			Footprint->NumTickFunctions, Budget.MaxTickFunctions);
+
+		++NumOverBudget;
+	}
+
+	return NumOverBudget > 0 ? 1 : 0;
+}
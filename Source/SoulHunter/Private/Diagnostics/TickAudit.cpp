@@ -0,0 +1,163 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Diagnostics/TickAudit.h"
+#include "SoulHunter.h"
+#include "Containers/Ticker.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+bool FTickAudit::bRecording = false;
+int32 FTickAudit::NumFrames = 0;
+TMap<const UClass*, double> FTickAudit::ClassSeconds;
+int32 FTickAuditScope::Depth = 0;
+
+namespace TickAudit
+{
+	const FName ReceiveTickName(TEXT("ReceiveTick"));
+
+	struct FTickRow
+	{
+		FString ClassName;
+		const TCHAR* Kind = TEXT("");
+		int32 NumRegistered = 0;
+		int32 NumEnabled = 0;
+		ETickingGroup TickGroup = TG_PrePhysics;
+		float TickInterval = 0.f;
+		double Seconds = -1.0;
+		bool bEmpty = false;
+	};
+
+	/** Only this module's actors are checked for empty ticks, engine classes do their work where the audit cannot see it. */
+	bool IsGameplayClass(const UClass* Class)
+	{
+		while (Class && !Class->HasAnyClassFlags(CLASS_Native))
+			Class = Class->GetSuperClass();
+
+		return Class && Class->GetOutermost()->GetName() == TEXT("/Script/SoulHunter");
+	}
+
+	void AddTickFunction(TMap<const UClass*, FTickRow>& Rows, const UClass* Class, const TCHAR* Kind, const FTickFunction& TickFunction)
+	{
+		if (!TickFunction.IsTickFunctionRegistered())
+			return;
+
+		FTickRow& Row = Rows.FindOrAdd(Class);
+		Row.ClassName = Class->GetName();
+		Row.Kind = Kind;
+		Row.TickGroup = TickFunction.TickGroup;
+		Row.TickInterval = TickFunction.TickInterval;
+		++Row.NumRegistered;
+		Row.NumEnabled += TickFunction.IsTickFunctionEnabled() ? 1 : 0;
+	}
+}
+
+#pragma region Main
+
+void FTickAudit::Start(UWorld* World, float Seconds)
+{
+	if (bRecording || World == nullptr)
+		return;
+
+	bRecording = true;
+	NumFrames = 0;
+	ClassSeconds.Reset();
+
+	UE_LOG(LogSoulHunter, Display, TEXT("Tick audit: recording for %.1f seconds"), Seconds);
+
+	TWeakObjectPtr<UWorld> WeakWorld = World;
+	const double EndTime = FPlatformTime::Seconds() + Seconds;
+
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakWorld, EndTime](float DeltaTime)
+	{
+		++NumFrames;
+
+		if (FPlatformTime::Seconds() < EndTime)
+			return true;
+
+		bRecording = false;
+
+		if (WeakWorld.IsValid())
+			LogReport(WeakWorld.Get());
+
+		return false;
+	}));
+}
+
+void FTickAudit::Record(const UClass* Class, double Seconds)
+{
+	ClassSeconds.FindOrAdd(Class) += Seconds;
+}
+
+void FTickAudit::LogReport(UWorld* World)
+{
+	TMap<const UClass*, TickAudit::FTickRow> Rows;
+
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		const AActor* Actor = *It;
+		TickAudit::AddTickFunction(Rows, Actor->GetClass(), TEXT("Actor"), Actor->PrimaryActorTick);
+
+		for (const UActorComponent* Component : Actor->GetComponents())
+		{
+			if (Component)
+				TickAudit::AddTickFunction(Rows, Component->GetClass(), TEXT("Component"), Component->PrimaryComponentTick);
+		}
+	}
+
+	for (TPair<const UClass*, TickAudit::FTickRow>& RowPair : Rows)
+	{
+		TickAudit::FTickRow& Row = RowPair.Value;
+
+		if (const double* Seconds = ClassSeconds.Find(RowPair.Key))
+			Row.Seconds = *Seconds;
+
+		Row.bEmpty = Row.NumEnabled > 0 && Row.Seconds < 0.0 && RowPair.Key->IsChildOf<AActor>() &&
+			TickAudit::IsGameplayClass(RowPair.Key) && !RowPair.Key->IsFunctionImplementedInScript(TickAudit::ReceiveTickName);
+	}
+
+	Rows.ValueSort([](const TickAudit::FTickRow& A, const TickAudit::FTickRow& B)
+	{
+		return A.Seconds != B.Seconds ? A.Seconds > B.Seconds : A.NumEnabled > B.NumEnabled;
+	});
+
+	const UEnum* TickGroupEnum = StaticEnum<ETickingGroup>();
+	const int32 Frames = FMath::Max(NumFrames, 1);
+
+	UE_LOG(LogSoulHunter, Display, TEXT("Tick audit over %d frames:"), NumFrames);
+	UE_LOG(LogSoulHunter, Display, TEXT("  %-36s %-9s %10s %7s %-20s %8s %10s"),
+		TEXT("Class"), TEXT("Kind"), TEXT("Registered"), TEXT("Enabled"), TEXT("Group"), TEXT("Interval"), TEXT("ms/frame"));
+
+	for (const TPair<const UClass*, TickAudit::FTickRow>& RowPair : Rows)
+	{
+		const TickAudit::FTickRow& Row = RowPair.Value;
+
+		UE_LOG(LogSoulHunter, Display, TEXT("  %-36s %-9s %10d %7d %-20s %8.3f %10s%s"),
+			*Row.ClassName,
+			Row.Kind,
+			Row.NumRegistered,
+			Row.NumEnabled,
+			*TickGroupEnum->GetNameStringByValue(Row.TickGroup),
+			Row.TickInterval,
+			Row.Seconds >= 0.0 ? *FString::Printf(TEXT("%.4f"), Row.Seconds * 1000.0 / Frames) : TEXT("-"),
+			Row.bEmpty ? TEXT("  EMPTY TICK") : TEXT(""));
+	}
+}
+
+#pragma endregion
+
+#pragma region Console Commands
+
+namespace TickAudit
+{
+	static FAutoConsoleCommandWithWorldAndArgs AuditCommand(
+		TEXT("sh.Tick.Audit"),
+		TEXT("Records gameplay tick costs for a while, then lists every registered tick function and flags empty ticks: sh.Tick.Audit [Seconds]."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			const float Seconds = Args.Num() > 0 ? FMath::Max(FCString::Atof(*Args[0]), .1f) : 5.f;
+			FTickAudit::Start(World, Seconds);
+		}));
+}
+
+#pragma endregion
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Enemy/EncounterSpawner.h"
+#include "Enemy/EncounterSubsystem.h"
+#include "Characters/CharacterNames.h"
+#include "Components/BoxComponent.h"
+#include "GameFramework/Pawn.h"
+
+AEncounterSpawner::AEncounterSpawner()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	Trigger = CreateDefaultSubobject<UBoxComponent>(TEXT("Trigger"));
+	SetRootComponent(Trigger);
+
+	Trigger->SetBoxExtent(FVector(500.f, 500.f, 200.f));
+	Trigger->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
+	Trigger->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
+}
+
+void AEncounterSpawner::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Encounter enemies are spawned by the server and replicate to clients like any other enemy.
+	if (GetNetMode() == NM_Client)
+		return;
+
+	Trigger->OnComponentBeginOverlap.AddDynamic(this, &AEncounterSpawner::OnTriggerOverlap);
+
+	if (UEncounterSubsystem* EncounterSubsystem = GetWorld()->GetSubsystem<UEncounterSubsystem>())
+		EncounterSubsystem->PrewarmEncounter(this);
+}
+
+void AEncounterSpawner::OnTriggerOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+	if (bTriggered || Encounter == nullptr || OtherActor == nullptr || !OtherActor->ActorHasTag(CharacterNames::EngageableTargetTag))
+		return;
+
+	if (UEncounterSubsystem* EncounterSubsystem = GetWorld()->GetSubsystem<UEncounterSubsystem>())
+	{
+		bTriggered = true;
+		EncounterSubsystem->StartEncounter(this, Cast<APawn>(OtherActor));
+	}
+}
+
+FTransform AEncounterSpawner::GetSpawnTransform(int32 SpawnIndex) const
+{
+	if (SpawnPoints.Num() > 0)
+	{
+		const AActor* SpawnPoint = SpawnPoints[SpawnIndex % SpawnPoints.Num()];
+
+		if (SpawnPoint)
+			return SpawnPoint->GetActorTransform();
+	}
+
+	// Golden-angle spiral, so any number of enemies spreads evenly without overlapping.
+	const float Angle = SpawnIndex * 2.39996323f;
+	const float Radius = ScatterRadius * FMath::Sqrt((SpawnIndex + .5f) / 64.f);
+	const FVector Offset(FMath::Cos(Angle) * Radius, FMath::Sin(Angle) * Radius, 0.f);
+
+	return FTransform(GetActorRotation(), GetActorLocation() + Offset);
+}
@@ -0,0 +1,390 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Enemy/EncounterSubsystem.h"
+#include "Enemy/EncounterDataAsset.h"
+#include "Enemy/EncounterSpawner.h"
+#include "Enemy/Enemy.h"
+#include "Loading/AssetPreloadSubsystem.h"
+#include "SoulHunter.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Encounter Tick"), STAT_EncounterTick, STATGROUP_Game);
+
+namespace Encounter
+{
+	TAutoConsoleVariable<float> CVarSpawnBudgetMs(
+		TEXT("sh.Encounter.SpawnBudgetMs"),
+		2.f,
+		TEXT("Milliseconds per frame spent on encounter spawn steps. At least one step runs per frame while a wave is queued."));
+
+	const TCHAR* StageNames[] = { TEXT("Construct"), TEXT("Weapon"), TEXT("Possess"), TEXT("Widget"), TEXT("Activate") };
+
+	float Percentile(const TArray<float>& SortedSamples, float Fraction)
+	{
+		if (SortedSamples.Num() == 0)
+			return 0.f;
+
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Fraction * SortedSamples.Num()) - 1, 0, SortedSamples.Num() - 1);
+
+		return SortedSamples[Index];
+	}
+
+	void AddSample(TArray<float>& Samples, int32 SampleIndex, int32 MaxSamples, float Value)
+	{
+		if (Samples.Num() < MaxSamples)
+			Samples.Add(Value);
+		else
+			Samples[SampleIndex] = Value;
+	}
+}
+
+#pragma region Main
+
+bool UEncounterSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UEncounterSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEncounterSubsystem, STATGROUP_Tickables);
+}
+
+void UEncounterSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EncounterTick);
+
+	for (int32 EncounterIndex = 0; EncounterIndex < Encounters.Num(); ++EncounterIndex)
+		UpdateEncounter(EncounterIndex, DeltaTime);
+
+	if (GetNumQueuedWaveJobs() == 0 && PrewarmJobs.Num() == 0)
+		return;
+
+	const double BudgetMs = Encounter::CVarSpawnBudgetMs.GetValueOnGameThread();
+	const double FrameStart = FPlatformTime::Seconds();
+
+	auto ElapsedMs = [FrameStart]() { return (FPlatformTime::Seconds() - FrameStart) * 1000.0; };
+
+	bool bRanWaveStage = false;
+
+	// Wave spawns always make progress, even when a single step is over budget.
+	while (GetNumQueuedWaveJobs() > 0 && (!bRanWaveStage || ElapsedMs() < BudgetMs))
+	{
+		bRanWaveStage = true;
+
+		if (RunStage(WaveJobs[NextWaveJob], false))
+			++NextWaveJob;
+	}
+
+	if (NextWaveJob > 0 && GetNumQueuedWaveJobs() == 0)
+	{
+		WaveJobs.Reset();
+		NextWaveJob = 0;
+	}
+
+	// Prewarming only uses what is left of an otherwise idle frame.
+	while (GetNumQueuedWaveJobs() == 0 && PrewarmJobs.Num() > 0 && ElapsedMs() < BudgetMs)
+	{
+		if (RunStage(PrewarmJobs.Last(), true))
+			PrewarmJobs.Pop(false);
+	}
+
+	if (bRanWaveStage)
+	{
+		Encounter::AddSample(FrameCostSamples, NextFrameSampleIndex, MaxCostSamples, ElapsedMs());
+		NextFrameSampleIndex = (NextFrameSampleIndex + 1) % MaxCostSamples;
+	}
+}
+
+void UEncounterSubsystem::PrewarmEncounter(AEncounterSpawner* Spawner)
+{
+	const UEncounterDataAsset* EncounterData = Spawner ? Spawner->GetEncounter() : nullptr;
+
+	if (EncounterData == nullptr)
+		return;
+
+	TArray<TSubclassOf<AEnemy>> EnemyClasses;
+	EncounterData->GetEnemyClasses(EnemyClasses);
+
+	UAssetPreloadSubsystem* PreloadSubsystem = UAssetPreloadSubsystem::Get(this);
+
+	for (const TSubclassOf<AEnemy>& EnemyClass : EnemyClasses)
+	{
+		if (PreloadSubsystem)
+			PreloadSubsystem->PreloadCharacterAssets(EnemyClass, Spawner);
+
+		const TArray<TWeakObjectPtr<AEnemy>>* Pool = Pools.Find(EnemyClass);
+		const int32 NumToBuild = EncounterData->PoolPrewarmPerClass - (Pool ? Pool->Num() : 0);
+
+		for (int32 Index = 0; Index < NumToBuild; ++Index)
+		{
+			FSpawnJob& Job = PrewarmJobs.AddDefaulted_GetRef();
+			Job.EnemyClass = EnemyClass;
+			Job.SpawnTransform = Spawner->GetActorTransform();
+			Job.Spawner = Spawner;
+		}
+	}
+}
+
+void UEncounterSubsystem::StartEncounter(AEncounterSpawner* Spawner, APawn* Instigator)
+{
+	if (Spawner == nullptr || Spawner->GetEncounter() == nullptr)
+		return;
+
+	FActiveEncounter& NewEncounter = Encounters.AddDefaulted_GetRef();
+	NewEncounter.Spawner = Spawner;
+	NewEncounter.Target = Instigator;
+}
+
+bool UEncounterSubsystem::ReleaseEnemy(AEnemy* Enemy)
+{
+	if (Enemy == nullptr || !PooledEnemies.Contains(Enemy))
+		return false;
+
+	Enemy->DeactivateForPool();
+	Pools.FindOrAdd(Enemy->GetClass()).Add(Enemy);
+
+	return true;
+}
+
+void UEncounterSubsystem::LogSpawnStats() const
+{
+	auto LogRow = [](const TCHAR* Label, TArray<float> Samples)
+	{
+		Samples.Sort();
+
+		UE_LOG(LogSoulHunter, Display, TEXT("  %-10s n=%4d  p50 %6.3f  p90 %6.3f  p99 %6.3f  max %6.3f ms"),
+			Label,
+			Samples.Num(),
+			Encounter::Percentile(Samples, .5f),
+			Encounter::Percentile(Samples, .9f),
+			Encounter::Percentile(Samples, .99f),
+			Samples.Num() > 0 ? Samples.Last() : 0.f);
+	};
+
+	int32 NumPooled = 0;
+
+	for (const TPair<UClass*, TArray<TWeakObjectPtr<AEnemy>>>& PoolPair : Pools)
+		NumPooled += PoolPair.Value.Num();
+
+	UE_LOG(LogSoulHunter, Display, TEXT("Encounter spawn cost (budget %.2f ms, %d wave jobs queued, %d prewarm jobs queued, %d enemies pooled)"),
+		Encounter::CVarSpawnBudgetMs.GetValueOnGameThread(), GetNumQueuedWaveJobs(), PrewarmJobs.Num(), NumPooled);
+
+	LogRow(TEXT("Enemy"), TotalCostSamples);
+
+	for (int32 StageIndex = 0; StageIndex < static_cast<int32>(ESpawnStage::Count); ++StageIndex)
+		LogRow(Encounter::StageNames[StageIndex], StageCostSamples[StageIndex]);
+
+	LogRow(TEXT("Frame"), FrameCostSamples);
+}
+
+#pragma endregion
+
+#pragma region Spawn Jobs
+
+bool UEncounterSubsystem::RunStage(FSpawnJob& Job, bool bPrewarm)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	const ESpawnStage Stage = Job.Stage;
+
+	AEnemy* Enemy = Job.Enemy.Get();
+	bool bFinished = false;
+
+	if (Stage != ESpawnStage::Construct && Enemy == nullptr)
+	{
+		// The enemy was destroyed mid-build; drop the job.
+		if (Encounters.IsValidIndex(Job.EncounterIndex))
+			--Encounters[Job.EncounterIndex].PendingSpawns;
+
+		return true;
+	}
+
+	switch (Stage)
+	{
+	case ESpawnStage::Construct:
+	{
+		TArray<TWeakObjectPtr<AEnemy>>* Pool = bPrewarm ? nullptr : Pools.Find(Job.EnemyClass);
+
+		while (Pool && Pool->Num() > 0 && Enemy == nullptr)
+			Enemy = Pool->Pop(false).Get();
+
+		const AEncounterSpawner* Spawner = Job.Spawner.Get();
+		const TArray<AActor*> NoPatrolTargets;
+		const TArray<AActor*>& PatrolTargets = Spawner ? Spawner->GetPatrolTargets() : NoPatrolTargets;
+
+		// Pooled enemies were fully built when they were prewarmed, possibly for another spawner.
+		if (Enemy)
+		{
+			Enemy->ReactivateFromPool(Job.SpawnTransform, PatrolTargets);
+			Job.Enemy = Enemy;
+			Job.Stage = ESpawnStage::Activate;
+			break;
+		}
+
+		Enemy = GetWorld()->SpawnActorDeferred<AEnemy>(Job.EnemyClass, Job.SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+
+		if (Enemy == nullptr)
+		{
+			if (Encounters.IsValidIndex(Job.EncounterIndex))
+				--Encounters[Job.EncounterIndex].PendingSpawns;
+
+			return true;
+		}
+
+		Enemy->PrepareStagedSpawn(PatrolTargets);
+		Enemy->SetReturnToPool(true);
+		Enemy->FinishSpawning(Job.SpawnTransform);
+
+		if (bPrewarm)
+			Enemy->DeactivateForPool();
+
+		PooledEnemies.Add(Enemy);
+
+		Job.Enemy = Enemy;
+		Job.Stage = ESpawnStage::Weapon;
+		break;
+	}
+	case ESpawnStage::Weapon:
+		Enemy->SpawnDefaultWeapon();
+		Job.Stage = ESpawnStage::Possess;
+		break;
+	case ESpawnStage::Possess:
+		if (Enemy->GetController() == nullptr)
+			Enemy->SpawnDefaultController();
+
+		Job.Stage = ESpawnStage::Widget;
+		break;
+	case ESpawnStage::Widget:
+		Enemy->CreateHealthBarWidget();
+		Job.Stage = ESpawnStage::Activate;
+		break;
+	case ESpawnStage::Activate:
+		if (bPrewarm)
+		{
+			// Deactivated again so the weapon spawned in the meantime is hidden with its owner.
+			Enemy->DeactivateForPool();
+			Pools.FindOrAdd(Job.EnemyClass).Add(Enemy);
+		}
+		else
+		{
+			Enemy->ActivateSpawned(Job.Target.Get());
+
+			if (Encounters.IsValidIndex(Job.EncounterIndex))
+			{
+				FActiveEncounter& ActiveEncounter = Encounters[Job.EncounterIndex];
+				ActiveEncounter.AliveEnemies.Add(Enemy);
+				--ActiveEncounter.PendingSpawns;
+			}
+		}
+
+		bFinished = true;
+		break;
+	default:
+		bFinished = true;
+		break;
+	}
+
+	Job.StageMilliseconds[static_cast<int32>(Stage)] += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	if (bFinished && !bPrewarm)
+		RecordSpawnCost(Job);
+
+	return bFinished;
+}
+
+void UEncounterSubsystem::RecordSpawnCost(const FSpawnJob& Job)
+{
+	double TotalMs = 0.0;
+
+	for (int32 StageIndex = 0; StageIndex < static_cast<int32>(ESpawnStage::Count); ++StageIndex)
+	{
+		TotalMs += Job.StageMilliseconds[StageIndex];
+		Encounter::AddSample(StageCostSamples[StageIndex], NextSampleIndex, MaxCostSamples, Job.StageMilliseconds[StageIndex]);
+	}
+
+	Encounter::AddSample(TotalCostSamples, NextSampleIndex, MaxCostSamples, TotalMs);
+	NextSampleIndex = (NextSampleIndex + 1) % MaxCostSamples;
+}
+
+#pragma endregion
+
+#pragma region Encounters
+
+void UEncounterSubsystem::UpdateEncounter(int32 EncounterIndex, float DeltaTime)
+{
+	FActiveEncounter& ActiveEncounter = Encounters[EncounterIndex];
+
+	const AEncounterSpawner* Spawner = ActiveEncounter.Spawner.Get();
+	const UEncounterDataAsset* EncounterData = Spawner ? Spawner->GetEncounter() : nullptr;
+
+	if (EncounterData == nullptr || ActiveEncounter.NextWave >= EncounterData->Waves.Num())
+		return;
+
+	ActiveEncounter.AliveEnemies.RemoveAllSwap([](const TWeakObjectPtr<AEnemy>& Enemy)
+	{
+		return !Enemy.IsValid() || Enemy->GetEnemyState() == EEnemyState::EES_Dead;
+	});
+
+	if (ActiveEncounter.WaveDelayRemaining < 0.f)
+	{
+		const FEncounterWave& Wave = EncounterData->Waves[ActiveEncounter.NextWave];
+		const bool bPreviousWaveCleared = ActiveEncounter.PendingSpawns == 0 && ActiveEncounter.AliveEnemies.Num() == 0;
+
+		if (ActiveEncounter.NextWave > 0 && Wave.bWaitForPreviousWave && !bPreviousWaveCleared)
+			return;
+
+		ActiveEncounter.WaveDelayRemaining = Wave.StartDelay;
+	}
+
+	ActiveEncounter.WaveDelayRemaining -= DeltaTime;
+
+	if (ActiveEncounter.WaveDelayRemaining <= 0.f)
+	{
+		ActiveEncounter.WaveDelayRemaining = -1.f;
+		QueueWave(EncounterIndex);
+	}
+}
+
+void UEncounterSubsystem::QueueWave(int32 EncounterIndex)
+{
+	FActiveEncounter& ActiveEncounter = Encounters[EncounterIndex];
+	const AEncounterSpawner* Spawner = ActiveEncounter.Spawner.Get();
+	const FEncounterWave& Wave = Spawner->GetEncounter()->Waves[ActiveEncounter.NextWave++];
+
+	for (const FEncounterSpawnEntry& Entry : Wave.Spawns)
+	{
+		if (Entry.EnemyClass == nullptr)
+			continue;
+
+		for (int32 Index = 0; Index < Entry.Count; ++Index)
+		{
+			FSpawnJob& Job = WaveJobs.AddDefaulted_GetRef();
+			Job.EnemyClass = Entry.EnemyClass;
+			Job.SpawnTransform = Spawner->GetSpawnTransform(ActiveEncounter.NextSpawnIndex++);
+			Job.Spawner = ActiveEncounter.Spawner;
+			Job.Target = ActiveEncounter.Target;
+			Job.EncounterIndex = EncounterIndex;
+
+			++ActiveEncounter.PendingSpawns;
+		}
+	}
+}
+
+#pragma endregion
+
+#pragma region Console Commands
+
+namespace Encounter
+{
+	static FAutoConsoleCommandWithWorld SpawnStatsCommand(
+		TEXT("sh.Encounter.SpawnStats"),
+		TEXT("Prints spawn cost percentiles per enemy, per spawn step and per frame."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (const UEncounterSubsystem* EncounterSubsystem = World ? World->GetSubsystem<UEncounterSubsystem>() : nullptr)
+				EncounterSubsystem->LogSpawnStats();
+		}));
+}
+
+#pragma endregion
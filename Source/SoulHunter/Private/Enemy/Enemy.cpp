@@ -1,22 +1,40 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Enemy/Enemy.h"
+#include "Enemy/PatrolCrowdSubsystem.h"
+#include "Enemy/EncounterSubsystem.h"
+#include "Characters/CharacterNames.h"
+#include "Characters/MontageSectionTable.h"
+#include "Combat/LockOnCandidateSubsystem.h"
 #include "AIController.h"
 #include "Components\SkeletalMeshComponent.h"
 #include "Components\CapsuleComponent.h"
+#include "Animation/AnimInstance.h"
 #include "Components/AttributeComponent.h"
 #include "Perception/PawnSensingComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "HUD/HealthBarComponent.h"
 #include "Items/Weapons/Weapon.h"
 #include "Items/Soul.h"
+#include "Items/LootSubsystem.h"
+#include "Persistence/WorldStateSubsystem.h"
+#include "Loading/AssetPreloadSubsystem.h"
+#include "Diagnostics/TickAudit.h"
+#include "Diagnostics/CombatTelemetry.h"
+#include "SoulHunterDebug.h"
+#include "Scalability/GameplayScalability.h"
 #include "TargetComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 #pragma region Main
 
 AEnemy::AEnemy()
 {
+	// The tick only polls the AI's patrol and combat decisions; ten times a second is plenty and keeps crowds cheap.
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+	PrimaryActorTick.TickInterval = .1f;
 
 	GetCapsuleComponent()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore);
 
@@ -29,19 +47,36 @@ AEnemy::AEnemy()
 	HealthBarWidget->SetupAttachment(GetRootComponent());
 
 	PawnSensing = CreateDefaultSubobject<UPawnSensingComponent>(TEXT("Pawn Sensing"));
-	PawnSensing->SightRadius = PawnSightRadius;
-	PawnSensing->SetPeripheralVisionAngle(PawnPeripheralVisionAngle);
 
 	TargetComponent = CreateDefaultSubobject<UTargetComponent>(TEXT("Target"));
 	TargetComponent->SetAssociatedComponent(GetMesh());
-	TargetComponent->SetDefaultSocket(TEXT("TargetWidgetSocket"));
+	TargetComponent->SetDefaultSocket(CharacterNames::TargetWidgetSocket);
+
+	// Enemies are most of what the server replicates: far ones are culled and the rest update at a modest rate.
+	NetCullDistanceSquared = FMath::Square(6000.f);
+	NetUpdateFrequency = 20.f;
+	MinNetUpdateFrequency = 5.f;
+}
+
+void AEnemy::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AEnemy, EnemyState, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AEnemy, DeathPose, Params);
 }
 
 void AEnemy::Tick(float DeltaTime)
 {
+	SH_TICK_AUDIT_SCOPE();
+
 	Super::Tick(DeltaTime);
 
-	if (IsDead()) return;
+	// The AI only runs on the server, clients follow the replicated movement and state.
+	if (!HasAuthority() || IsDead()) return;
 
 	if (EnemyState == EEnemyState::EES_Patrolling)
 		CheckPatrolTarget();
@@ -58,7 +93,7 @@ float AEnemy::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AC
 	CombatTarget = EventInstigator->GetPawn();
 
 	if (IsInsideAttackRadius())
-		EnemyState = EEnemyState::EES_Attacking;
+		SetEnemyState(EEnemyState::EES_Attacking);
 	else if (IsOutsideAttackRadius())
 		StartChasing();
 
@@ -84,76 +119,451 @@ void AEnemy::GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter)
 
 void AEnemy::Destroyed()
 {
-	if (EquippedWeapon)
+	if (EquippedWeapon && HasAuthority())
 		EquippedWeapon->Destroy();
+
+	Super::Destroyed();
+}
+
+void AEnemy::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	EnemyController = Cast<AAIController>(NewController);
 }
 
+void AEnemy::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	// Captured before any saved state is applied, so "moved" is always measured from the placed location.
+	HomeLocation = GetActorLocation();
+	bPlacedInLevel = HasAnyFlags(RF_WasLoaded) || IsNetStartupActor();
+}
+
+void AEnemy::PostLoad()
+{
+	Super::PostLoad();
+
+#if WITH_EDITORONLY_DATA
+	const AEnemy* Template = Cast<AEnemy>(GetArchetype());
+
+	if (UEnemyArchetype* Migrated = FCombatArchetypeMigration::Migrate(this, GetDeprecatedStats(), Template ? Template->GetDeprecatedStats() : FEnemyStats()))
+		Archetype = Migrated;
+#endif
+}
+
+#if WITH_EDITORONLY_DATA
+
+FEnemyStats AEnemy::GetDeprecatedStats() const
+{
+	FEnemyStats Stats;
+	Stats.PawnSightRadius = PawnSightRadius_DEPRECATED;
+	Stats.PawnPeripheralVisionAngle = PawnPeripheralVisionAngle_DEPRECATED;
+	Stats.PatrollingSpeed = PatrollingSpeed_DEPRECATED;
+	Stats.PatrolRadius = static_cast<float>(PatrolRadius_DEPRECATED);
+	Stats.AcceptanceRadius = static_cast<float>(AcceptanceRadius_DEPRECATED);
+	Stats.PatrolWaitingTimeMin = PatrolWaitinTimeMin_DEPRECATED;
+	Stats.PatrolWaitingTimeMax = PatrolWaitingTimeMax_DEPRECATED;
+	Stats.ChasingSpeed = ChasingSpeed_DEPRECATED;
+	Stats.CombatRadius = CombatRadius_DEPRECATED;
+	Stats.AttackRadius = AttackRadius_DEPRECATED;
+	Stats.AttackWaitingTimeMin = AttackWaitingTimeMin_DEPRECATED;
+	Stats.AttackWaitingTimeMax = AttackWaitingTimeMax_DEPRECATED;
+	Stats.DeathLifeSpan = DeathLifeSpan_DEPRECATED;
+
+	return Stats;
+}
+
+#endif
+
 void AEnemy::BeginPlay()
 {
 	Super::BeginPlay();
 
+	SetActorTickInterval(FGameplayScalability::GetAITickInterval(GetActorTickInterval()));
+
 	if (PawnSensing)
+	{
+		PawnSensing->SightRadius = GetStats().Stats.PawnSightRadius;
+		PawnSensing->SensingInterval = FGameplayScalability::GetAISensingInterval(PawnSensing->SensingInterval);
+		PawnSensing->SetPeripheralVisionAngle(GetStats().Stats.PawnPeripheralVisionAngle);
 		PawnSensing->OnSeePawn.AddDynamic(this, &AEnemy::PawnSeen);
+	}
 
 	ShowHealthBar(false);
-	SpawnDefaultWeapon();
+
+	if (!IsDead())
+		SetTargetable(true);
+
+	if (!HasAuthority())
+	{
+		SetActorTickEnabled(false);
+		PawnSensing->SetSensingUpdatesEnabled(false);
+
+		if (Attributes)
+			Attributes->OnAttributesChanged.AddUObject(this, &AEnemy::OnAttributesReplicated);
+	}
 
 	EnemyController = Cast<AAIController>(GetController());
 
-	if (EnemyController && PatrolTarget)
+	// Walking away from the placed spot records nothing, so saves poll placed enemies for it.
+	if (bPlacedInLevel && HasAuthority())
 	{
-		FTimerHandle UnusedHandle;
-		GetWorldTimerManager().SetTimer(UnusedHandle, this, &AEnemy::StartPatrolling, .1f, false);
+		if (UWorldStateSubsystem* WorldState = UWorldStateSubsystem::Get(this))
+			WorldState->TrackVolatileActor(this);
 	}
 
-	Tags.Add(FName("Enemy"));
+	if (EnemyController && PatrolTarget)
+		GetWorldTimerManager().SetTimer(PatrolTimer, this, &AEnemy::StartPatrolling, .1f, false);
+
+	Tags.Add(CharacterNames::EnemyTag);
+}
+
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (ULockOnCandidateSubsystem* CandidateSubsystem = ULockOnCandidateSubsystem::Get(this))
+		CandidateSubsystem->RemoveCandidate(this);
+
+	if (UWorldStateSubsystem* WorldState = bPlacedInLevel ? UWorldStateSubsystem::Get(this) : nullptr)
+		WorldState->UntrackVolatileActor(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AEnemy::OnPreloadAssetsLoaded()
+{
+	if (!bStagedSpawn && HasAuthority())
+		SpawnDefaultWeapon();
+}
+
+void AEnemy::GatherPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const
+{
+	Super::GatherPreloadAssets(OutAssets);
+
+	if (!WeaponClass.IsNull())
+		OutAssets.Add(WeaponClass.ToSoftObjectPath());
+
+	if (!SoulClass.IsNull())
+		OutAssets.Add(SoulClass.ToSoftObjectPath());
+
+	if (LootTable)
+		LootTable->GatherPreloadAssets(OutAssets);
 }
 
 void AEnemy::Death(const FVector& ImpactPoint)
 {
-	GEngine->AddOnScreenDebugMessage(INDEX_NONE, 10.f, FColor::White, TEXT("Entering death function"));
+	SH_DEBUG_LOG(Deaths, TEXT("%s died"), *GetName());
 
-	Tags.Add(FName("Dead"));
+	SH_COMBAT_TELEMETRY(Death, this, nullptr);
 
-	EnemyState = EEnemyState::EES_Dead;
+	SetEnemyState(EEnemyState::EES_Dead);
+	SetActorTickEnabled(false);
 
 	ClearAttackTimer();
 	ClearPatrolTimer();
 
-	if (DeathMontage)
+	// The pose is picked here and replicated, so every client plays the same death section.
+	if (UAnimMontage* Montage = UAssetPreloadSubsystem::Resolve(DeathMontage, this))
 	{
-		int32 DeathSectionSelected = PlayMontageRandomSection(DeathMontage);
-		DeathPose = (EEnemyDeathPose)DeathSectionSelected;
+		DeathPose = (EEnemyDeathPose)FMath::Max(FMontageSectionTable::Get(Montage).PickRandomSection(), 0);
+		MARK_PROPERTY_DIRTY_FROM_NAME(AEnemy, DeathPose, this);
 	}
+
+	PlayDeathEffects(ImpactPoint);
+
+	SetLifeSpan(FGameplayScalability::GetCorpseLifeSpan(GetStats().Stats.DeathLifeSpan));
+
+	SetWeaponCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	SpawnSoul();
+
+	if (UWorldStateSubsystem* WorldState = UWorldStateSubsystem::Get(this))
+		WorldState->RecordActorState(this);
+}
+
+void AEnemy::PlayDeathEffects(const FVector& ImpactPoint)
+{
+	if (bDeathEffectsPlayed)
+		return;
+
+	bDeathEffectsPlayed = true;
+
+	Tags.Add(CharacterNames::DeadTag);
+
+	UAnimMontage* Montage = UAssetPreloadSubsystem::Resolve(DeathMontage, this);
+
+	if (Montage)
+		PlayMontageSection(Montage, FMontageSectionTable::Get(Montage).GetSectionName(static_cast<int32>(DeathPose)));
 	else
-		StartRagdoll(ImpactPoint, 1500.f);
+		StartRagdoll(ImpactPoint, FGameplayScalability::GetRagdollImpulse());
 
 	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
 	ShowHealthBar(false);
 
-	SetLifeSpan(DeathLifeSpan);
-
 	GetCharacterMovement()->bOrientRotationToMovement = false;
 
-	SetWeaponCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetTargetable(false);
+}
 
-	SpawnSoul();
+void AEnemy::SetTargetable(bool bTargetable)
+{
+	TargetComponent->SetCanBeCaptured(bTargetable);
+
+	if (ULockOnCandidateSubsystem* CandidateSubsystem = ULockOnCandidateSubsystem::Get(this))
+	{
+		if (bTargetable)
+			CandidateSubsystem->AddCandidate(this);
+		else
+			CandidateSubsystem->RemoveCandidate(this);
+	}
+}
+
+void AEnemy::SetEnemyState(EEnemyState NewState)
+{
+	if (EnemyState == NewState)
+		return;
+
+	SH_COMBAT_TELEMETRY(StateTransition, this, nullptr, 0.f, static_cast<uint8>(NewState));
+
+	EnemyState = NewState;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AEnemy, EnemyState, this);
+}
+
+void AEnemy::OnRep_EnemyState()
+{
+	if (IsDead())
+		PlayDeathEffects(LastHitterLocation);
+	else if (bDeathEffectsPlayed)
+		ResetDeathEffects();
+}
+
+void AEnemy::LifeSpanExpired()
+{
+	if (bReturnToPool)
+	{
+		if (UEncounterSubsystem* EncounterSubsystem = GetWorld()->GetSubsystem<UEncounterSubsystem>())
+		{
+			if (EncounterSubsystem->ReleaseEnemy(this))
+				return;
+		}
+	}
 
-	TargetComponent->SetCanBeCaptured(false);
+	Super::LifeSpanExpired();
 }
 
 void AEnemy::SpawnSoul()
 {
-	UWorld* World = GetWorld();
-	if (World && SoulClass && Attributes)
+	ULootSubsystem* LootSubsystem = ULootSubsystem::Get(this);
+
+	if (LootSubsystem == nullptr)
+		return;
+
+	const FVector SpawnLocation = GetActorLocation() + FVector(0.f, 0.f, 150.f);
+
+	// Souls from enemies dying together are merged into one pickup.
+	if (!SoulClass.IsNull() && Attributes)
+		LootSubsystem->AddDrop(UAssetPreloadSubsystem::ResolveClass(SoulClass, this), Attributes->GetSouls(), SpawnLocation);
+
+	LootSubsystem->RollTable(LootTable, this, SpawnLocation);
+}
+
+#pragma endregion
+
+#pragma region Persistence
+
+FGuid AEnemy::GetPersistentGuid() const
+{
+	if (!PersistentGuid.IsValid())
+		PersistentGuid = UWorldStateSubsystem::MakeActorGuid(this);
+
+	return PersistentGuid;
+}
+
+bool AEnemy::WritePersistentState(FActorStateRecord& OutRecord) const
+{
+	// Runtime enemies (crowd promotions, encounter spawns) have nothing placed to restore into.
+	if (!bPlacedInLevel || CrowdHandle.IsValid())
+		return false;
+
+	if (EnemyState == EEnemyState::EES_Dead)
 	{
-		const FVector SpawnLocation = GetActorLocation() + FVector(0.f, 0.f, 150.f);
-		ASoul* SpawnedSoul = World->SpawnActor<ASoul>(SoulClass, SpawnLocation, GetActorRotation());
+		OutRecord.Flags = EActorStateFlags::Dead;
+		return true;
+	}
+
+	const FVector Location = GetActorLocation();
+
+	if (FVector::DistSquared(Location, HomeLocation) < FMath::Square(MovedPersistenceThreshold))
+		return false;
 
-		if (SpawnedSoul)
-			SpawnedSoul->SetSouls(Attributes->GetSouls());
+	OutRecord.Flags = EActorStateFlags::Moved;
+	OutRecord.Location = FVector3f(Location);
+	OutRecord.Yaw = GetActorRotation().Yaw;
+
+	return true;
+}
+
+void AEnemy::ApplyPersistentState(const FActorStateRecord& Record)
+{
+	if (Record.HasAnyFlags(EActorStateFlags::Dead))
+	{
+		Destroy();
+		return;
 	}
+
+	if (Record.HasAnyFlags(EActorStateFlags::Moved))
+		SetActorLocationAndRotation(FVector(Record.Location), FRotator(0.f, Record.Yaw, 0.f), false, nullptr, ETeleportType::TeleportPhysics);
+}
+
+#pragma endregion
+
+#pragma region Crowd
+
+void AEnemy::InitializeCrowdAgent(const FPatrolCrowdHandle& Handle, const TArray<AActor*>& InPatrolTargets, AActor* InPatrolTarget)
+{
+	CrowdHandle = Handle;
+	PatrolTargets = InPatrolTargets;
+	PatrolTarget = InPatrolTarget;
+}
+
+void AEnemy::EngageTarget(APawn* Target)
+{
+	if (Target == nullptr || IsDead())
+		return;
+
+	CombatTarget = Target;
+
+	ClearPatrolTimer();
+
+	StartChasing();
+}
+
+#pragma endregion
+
+#pragma region Encounter Spawning
+
+void AEnemy::PrepareStagedSpawn(const TArray<AActor*>& InPatrolTargets)
+{
+	bStagedSpawn = true;
+	AutoPossessAI = EAutoPossessAI::Disabled;
+
+	if (HealthBarWidget)
+		HealthBarWidget->SetDeferWidgetCreation(true);
+
+	PatrolTargets = InPatrolTargets;
+	PatrolTarget = PatrolTargets.Num() > 0 ? PatrolTargets[0] : nullptr;
+}
+
+void AEnemy::CreateHealthBarWidget()
+{
+	if (HealthBarWidget)
+		HealthBarWidget->CreateDeferredWidget();
+}
+
+void AEnemy::ActivateSpawned(APawn* Target)
+{
+	if (Target)
+		EngageTarget(Target);
+	else if (PatrolTarget)
+		StartPatrolling();
+}
+
+void AEnemy::DeactivateForPool()
+{
+	ClearAttackTimer();
+	ClearPatrolTimer();
+
+	if (EnemyController)
+		EnemyController->StopMovement();
+
+	SetLifeSpan(0.f);
+	ShowHealthBar(false);
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+
+	if (EquippedWeapon)
+		EquippedWeapon->SetActorHiddenInGame(true);
+
+	PatrolTargets.Reset();
+	PatrolTarget = nullptr;
+	CombatTarget = nullptr;
+
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+	PawnSensing->SetSensingUpdatesEnabled(false);
+	SetTargetable(false);
+}
+
+void AEnemy::ReactivateFromPool(const FTransform& SpawnTransform, const TArray<AActor*>& InPatrolTargets)
+{
+	ResetAfterDeath();
+
+	PatrolTargets = InPatrolTargets;
+	PatrolTarget = PatrolTargets.Num() > 0 ? PatrolTargets[0] : nullptr;
+
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+
+	if (EquippedWeapon)
+		EquippedWeapon->SetActorHiddenInGame(false);
+
+	GetCharacterMovement()->SetComponentTickEnabled(true);
+	PawnSensing->SetSensingUpdatesEnabled(true);
+	SetTargetable(true);
+}
+
+void AEnemy::ResetAfterDeath()
+{
+	if (!IsDead())
+		return;
+
+	ResetDeathEffects();
+
+	if (Attributes)
+		Attributes->ResetVitals();
+
+	SetEnemyState(EEnemyState::EES_Patrolling);
+	CombatTarget = nullptr;
+}
+
+void AEnemy::ResetDeathEffects()
+{
+	bDeathEffectsPlayed = false;
+
+	// Undo what Death and the ragdoll changed, using the class defaults as the reference state.
+	const AEnemy* Defaults = GetClass()->GetDefaultObject<AEnemy>();
+	const USkeletalMeshComponent* DefaultMesh = Defaults->GetMesh();
+	USkeletalMeshComponent* MeshComponent = GetMesh();
+
+	MeshComponent->SetAllBodiesSimulatePhysics(false);
+	MeshComponent->SetAllBodiesPhysicsBlendWeight(0.f);
+	MeshComponent->SetCollisionEnabled(DefaultMesh->GetCollisionEnabled());
+	MeshComponent->SetCollisionObjectType(DefaultMesh->GetCollisionObjectType());
+	MeshComponent->SetCollisionResponseToChannels(DefaultMesh->GetCollisionResponseToChannels());
+	MeshComponent->SetCanEverAffectNavigation(DefaultMesh->CanEverAffectNavigation());
+	MeshComponent->bPauseAnims = false;
+
+	if (MeshComponent->GetAttachParent() != GetCapsuleComponent())
+		MeshComponent->AttachToComponent(GetCapsuleComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+
+	MeshComponent->SetRelativeLocationAndRotation(DefaultMesh->GetRelativeLocation(), DefaultMesh->GetRelativeRotation());
+
+	if (UAnimInstance* AnimInstance = MeshComponent->GetAnimInstance())
+		AnimInstance->StopAllMontages(0.f);
+
+	GetCapsuleComponent()->SetCollisionEnabled(Defaults->GetCapsuleComponent()->GetCollisionEnabled());
+	GetCharacterMovement()->bOrientRotationToMovement = true;
+
+	SetTargetable(true);
+
+	Tags.Remove(CharacterNames::DeadTag);
 }
 
 #pragma endregion
@@ -164,11 +574,12 @@ void AEnemy::SpawnDefaultWeapon()
 {
 	UWorld* World = GetWorld();
 
-	if (World && WeaponClass)
+	// Called once the preload bundle is resident, which can be after the enemy already died.
+	if (World && !WeaponClass.IsNull() && EquippedWeapon == nullptr && !IsDead())
 	{
-		AWeapon* DefaultWeapon = World->SpawnActor<AWeapon>(WeaponClass);
-		DefaultWeapon->Equip(GetMesh(), FName("RightHandSocket"), this, this);
-		EquippedWeapon = DefaultWeapon;
+		AWeapon* DefaultWeapon = World->SpawnActor<AWeapon>(UAssetPreloadSubsystem::ResolveClass(WeaponClass, this));
+		DefaultWeapon->Equip(GetMesh(), CharacterNames::RightHandSocket, this, this);
+		SetEquippedWeapon(DefaultWeapon);
 	}
 }
 
@@ -178,27 +589,31 @@ void AEnemy::SpawnDefaultWeapon()
 
 void AEnemy::MoveToTarget(AActor* Target)
 {
+	if (EnemyController == nullptr) return;
+
 	FAIMoveRequest MoveRequest;
 	MoveRequest.SetGoalActor(Target);
-	MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
+	MoveRequest.SetAcceptanceRadius(GetStats().Stats.AcceptanceRadius);
 
 	EnemyController->MoveTo(MoveRequest);
 }
 
-bool AEnemy::InTargetRange(AActor* Target, double Radius)
+bool AEnemy::InTargetRange(AActor* Target, float RadiusSquared)
 {
 	if (Target == nullptr) return false;
 
-	const double TargetDistance = (Target->GetActorLocation() - GetActorLocation()).Size();
-	return TargetDistance <= Radius;
+	return FVector::DistSquared(Target->GetActorLocation(), GetActorLocation()) <= RadiusSquared;
 }
 
 void AEnemy::PawnSeen(APawn* SeenPawn)
 {
+	if (!HasAuthority())
+		return;
+
 	const bool bShouldChaseTarget =
 		EnemyState == EEnemyState::EES_Patrolling &&
-		SeenPawn->ActorHasTag(FName("EngageableTarget")) &&
-		!SeenPawn->ActorHasTag(FName("Dead"));
+		SeenPawn->ActorHasTag(CharacterNames::EngageableTargetTag) &&
+		!SeenPawn->ActorHasTag(CharacterNames::DeadTag);
 
 	if (bShouldChaseTarget)
 	{
@@ -216,20 +631,22 @@ void AEnemy::PawnSeen(APawn* SeenPawn)
 
 void AEnemy::StartPatrolling()
 {
-	EnemyState = EEnemyState::EES_Patrolling;
+	SetEnemyState(EEnemyState::EES_Patrolling);
 
-	GetCharacterMovement()->MaxWalkSpeed = PatrollingSpeed;
+	GetCharacterMovement()->MaxWalkSpeed = GetStats().Stats.PatrollingSpeed;
 
 	MoveToTarget(PatrolTarget);
 }
 
 void AEnemy::CheckPatrolTarget()
 {
-	if (EnemyController && InTargetRange(PatrolTarget, PatrolRadius))
+	const FEnemyStatRow& Stats = GetStats();
+
+	if (EnemyController && InTargetRange(PatrolTarget, Stats.PatrolRadiusSquared))
 	{
 		ChooseNewPatrolTarget();
 
-		float RandomWaitingTime = FMath::RandRange(PatrolWaitinTimeMin, PatrolWaitingTimeMax);
+		float RandomWaitingTime = FMath::RandRange(Stats.Stats.PatrolWaitingTimeMin, Stats.Stats.PatrolWaitingTimeMax);
 
 		GetWorldTimerManager().SetTimer(PatrolTimer, this, &AEnemy::PatrolTimerFinished, RandomWaitingTime);
 	}
@@ -270,13 +687,19 @@ void AEnemy::LoseInterest()
 	CombatTarget = nullptr;
 
 	ShowHealthBar(false);
+
+	if (CrowdHandle.IsValid())
+	{
+		if (UPatrolCrowdSubsystem* CrowdSubsystem = GetWorld()->GetSubsystem<UPatrolCrowdSubsystem>())
+			CrowdSubsystem->RequestDemotion(this);
+	}
 }
 
 void AEnemy::StartChasing()
 {
-	EnemyState = EEnemyState::EES_Chasing;
+	SetEnemyState(EEnemyState::EES_Chasing);
 
-	GetCharacterMovement()->MaxWalkSpeed = ChasingSpeed;
+	GetCharacterMovement()->MaxWalkSpeed = GetStats().Stats.ChasingSpeed;
 
 	MoveToTarget(CombatTarget);
 }
@@ -287,15 +710,23 @@ void AEnemy::StartChasing()
 
 void AEnemy::Attack()
 {
-	if (CombatTarget && CombatTarget->ActorHasTag(FName("Dead")))
+	if (CombatTarget && CombatTarget->ActorHasTag(CharacterNames::DeadTag))
 	{
 		LoseInterest();
 		ClearAttackTimer();
 	}
 	else
 	{
-		EnemyState = EEnemyState::EES_Engaged;
-		PlayMontageRandomSection(AttackMontage, LastSelectedAttackMontageSection);
+		SetEnemyState(EEnemyState::EES_Engaged);
+
+		UAnimMontage* Montage = UAssetPreloadSubsystem::Resolve(AttackMontage, this);
+		const int32 SectionIndex = PlayMontageRandomSection(Montage, LastSelectedAttackMontageSection);
+
+		if (SectionIndex != INDEX_NONE)
+			Multicast_PlayMontageSection(Montage, FMontageSectionTable::Get(Montage).GetSectionName(SectionIndex));
+
+		if (EquippedWeapon)
+			EquippedWeapon->BeginSwing();
 	}
 }
 
@@ -306,7 +737,7 @@ bool AEnemy::CanAttack()
 
 void AEnemy::AttackEnd()
 {
-	EnemyState = EEnemyState::EES_NoState;
+	SetEnemyState(EEnemyState::EES_NoState);
 	CheckCombatTarget();
 }
 
@@ -335,9 +766,10 @@ void AEnemy::CheckCombatTarget()
 
 void AEnemy::StartAttackTimer()
 {
-	EnemyState = EEnemyState::EES_Attacking;
+	SetEnemyState(EEnemyState::EES_Attacking);
 
-	const float AttackWaitingTime = FMath::RandRange(AttackWaitingTimeMin, AttackWaitingTimeMax);
+	const FEnemyStats& Stats = GetStats().Stats;
+	const float AttackWaitingTime = FMath::RandRange(Stats.AttackWaitingTimeMin, Stats.AttackWaitingTimeMax);
 	GetWorldTimerManager().SetTimer(AttackTimer, this, &AEnemy::Attack, AttackWaitingTime);
 }
 
@@ -348,17 +780,17 @@ void AEnemy::ClearAttackTimer()
 
 bool AEnemy::IsOutsideCombatRadius()
 {
-	return !InTargetRange(CombatTarget, CombatRadius);
+	return !InTargetRange(CombatTarget, GetStats().CombatRadiusSquared);
 }
 
 bool AEnemy::IsOutsideAttackRadius()
 {
-	return !InTargetRange(CombatTarget, AttackRadius);
+	return !InTargetRange(CombatTarget, GetStats().AttackRadiusSquared);
 }
 
 bool AEnemy::IsInsideAttackRadius()
 {
-	return InTargetRange(CombatTarget, AttackRadius);
+	return InTargetRange(CombatTarget, GetStats().AttackRadiusSquared);
 }
 
 #pragma endregion
@@ -391,8 +823,21 @@ bool AEnemy::IsDead()
 
 void AEnemy::ShowHealthBar(bool Show)
 {
-	if (HealthBarWidget)
-		HealthBarWidget->SetVisibility(Show);
+	if (HealthBarWidget == nullptr)
+		return;
+
+	if (Show)
+		HealthBarWidget->CreateDeferredWidget();
+
+	HealthBarWidget->SetVisibility(Show);
+}
+
+void AEnemy::OnAttributesReplicated()
+{
+	UpdateHealthPercent();
+
+	// Clients have no combat target to go by, a damaged living enemy is one that is being fought.
+	ShowHealthBar(!IsDead() && Attributes->GetHealthPercent() < 1.f);
 }
 
 void AEnemy::UpdateHealthPercent()
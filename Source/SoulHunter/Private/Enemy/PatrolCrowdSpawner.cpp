@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Enemy/PatrolCrowdSpawner.h"
+#include "Enemy/PatrolCrowdSubsystem.h"
+#include "Enemy/Enemy.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Loading/AssetPreloadSubsystem.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+
+APatrolCrowdSpawner::APatrolCrowdSpawner()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	CrowdInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Crowd Instances"));
+	SetRootComponent(CrowdInstances);
+
+	CrowdInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	CrowdInstances->SetCanEverAffectNavigation(false);
+	CrowdInstances->SetMobility(EComponentMobility::Movable);
+
+	// Only hidden agents and demotions replicate, but a promotion should hide its agent before the enemy shows up.
+	bReplicates = true;
+	NetUpdateFrequency = 10.f;
+}
+
+void APatrolCrowdSpawner::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(APatrolCrowdSpawner, CrowdSeed, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(APatrolCrowdSpawner, CrowdStartTime, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(APatrolCrowdSpawner, HiddenAgents, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(APatrolCrowdSpawner, AgentSyncs, Params);
+}
+
+void APatrolCrowdSpawner::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (CrowdMesh)
+		CrowdInstances->SetStaticMesh(CrowdMesh);
+
+	// Promotions happen mid-fight, so the enemy's assets are brought in while the crowd is still ambient.
+	if (UAssetPreloadSubsystem* PreloadSubsystem = UAssetPreloadSubsystem::Get(this))
+		PreloadSubsystem->PreloadCharacterAssets(EnemyClass, this);
+
+	UPatrolCrowdSubsystem* CrowdSubsystem = GetWorld()->GetSubsystem<UPatrolCrowdSubsystem>();
+
+	if (HasAuthority() && CrowdSubsystem)
+	{
+		CrowdSeed = FMath::RandHelper(MAX_int32 - 1) + 1;
+		CrowdStartTime = CrowdSubsystem->GetCrowdTime();
+
+		MARK_PROPERTY_DIRTY_FROM_NAME(APatrolCrowdSpawner, CrowdSeed, this);
+		MARK_PROPERTY_DIRTY_FROM_NAME(APatrolCrowdSpawner, CrowdStartTime, this);
+	}
+
+	RegisterWithCrowd();
+}
+
+void APatrolCrowdSpawner::RegisterWithCrowd()
+{
+	if (bRegisteredWithCrowd || CrowdSeed == 0 || !(HasActorBegunPlay() || IsActorBeginningPlay()))
+		return;
+
+	if (UPatrolCrowdSubsystem* CrowdSubsystem = GetWorld()->GetSubsystem<UPatrolCrowdSubsystem>())
+	{
+		bRegisteredWithCrowd = true;
+		CrowdSubsystem->RegisterSpawner(this);
+	}
+}
+
+void APatrolCrowdSpawner::OnRep_CrowdSeed()
+{
+	RegisterWithCrowd();
+}
+
+void APatrolCrowdSpawner::OnRep_CrowdState()
+{
+	if (!bRegisteredWithCrowd)
+		return;
+
+	if (UPatrolCrowdSubsystem* CrowdSubsystem = GetWorld()->GetSubsystem<UPatrolCrowdSubsystem>())
+		CrowdSubsystem->ApplyReplicatedState(this);
+}
+
+void APatrolCrowdSpawner::SetAgentHidden(int32 AgentIndex, bool bHidden)
+{
+	if (HiddenAgents.Contains(AgentIndex) == bHidden)
+		return;
+
+	if (bHidden)
+		HiddenAgents.Add(AgentIndex);
+	else
+		HiddenAgents.RemoveSingleSwap(AgentIndex, false);
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(APatrolCrowdSpawner, HiddenAgents, this);
+}
+
+void APatrolCrowdSpawner::SyncAgent(const FPatrolCrowdAgentSync& Sync)
+{
+	FPatrolCrowdAgentSync* Existing = AgentSyncs.FindByPredicate([&Sync](const FPatrolCrowdAgentSync& Entry) { return Entry.AgentIndex == Sync.AgentIndex; });
+	const uint16 Revision = Existing ? Existing->Revision + 1 : 1;
+
+	if (Existing == nullptr)
+		Existing = &AgentSyncs.AddDefaulted_GetRef();
+
+	*Existing = Sync;
+	Existing->Revision = FMath::Max<uint16>(Revision, 1);
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(APatrolCrowdSpawner, AgentSyncs, this);
+}
+
+void APatrolCrowdSpawner::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UPatrolCrowdSubsystem* CrowdSubsystem = GetWorld()->GetSubsystem<UPatrolCrowdSubsystem>())
+		CrowdSubsystem->UnregisterSpawner(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void APatrolCrowdSpawner::GetPatrolTargetLocations(TArray<FVector>& OutLocations, TArray<int32>& OutSourceIndices) const
+{
+	OutLocations.Reset(PatrolTargets.Num());
+	OutSourceIndices.Reset(PatrolTargets.Num());
+
+	for (int32 Index = 0; Index < PatrolTargets.Num(); ++Index)
+	{
+		if (PatrolTargets[Index])
+		{
+			OutLocations.Add(PatrolTargets[Index]->GetActorLocation());
+			OutSourceIndices.Add(Index);
+		}
+	}
+}
@@ -0,0 +1,618 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Enemy/PatrolCrowdSubsystem.h"
+#include "Enemy/PatrolCrowdSpawner.h"
+#include "Enemy/Enemy.h"
+#include "Characters/CharacterNames.h"
+#include "SoulHunter.h"
+#include "Scalability/GameplayScalability.h"
+#include "AIController.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_CYCLE_STAT(TEXT("PatrolCrowd Tick"), STAT_PatrolCrowdTick, STATGROUP_Game);
+
+namespace PatrolCrowd
+{
+	constexpr float RecentlyRenderedTolerance = .2f;
+
+	/** Crowds nobody is looking at still upload this often, so their bounds follow the agents and culling stays honest. */
+	constexpr double OffscreenUploadInterval = 1.0;
+
+	/** Bounds a client's catch-up, in case an agent's patrol legs are degenerate. */
+	constexpr int32 MaxCatchUpLegs = 4096;
+}
+
+#pragma region Main
+
+void UPatrolCrowdSubsystem::Deinitialize()
+{
+	Chunks.Empty();
+	Locations.Empty();
+	Yaws.Empty();
+	WaitTimes.Empty();
+	TargetIndices.Empty();
+	PatrolSteps.Empty();
+	Flags.Empty();
+	PendingDemotions.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UPatrolCrowdSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UPatrolCrowdSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPatrolCrowdSubsystem, STATGROUP_Tickables);
+}
+
+void UPatrolCrowdSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PatrolCrowdTick);
+
+	if (Chunks.Num() == 0)
+		return;
+
+	// Clients only patrol; sight checks, promotions and demotions are the server's.
+	if (GetWorld()->GetNetMode() != NM_Client)
+	{
+		ProcessDemotions();
+		GatherPlayers();
+	}
+
+	SightTracesThisFrame = 0;
+	MaxSightTracesPerFrame = FGameplayScalability::GetAISightTracesPerFrame();
+
+	// A dedicated server has nobody to draw the crowd for.
+	const bool bRenderCrowd = GetWorld()->GetNetMode() != NM_DedicatedServer;
+
+	for (FCrowdChunk& Chunk : Chunks)
+	{
+		RefreshPromotedAgents(Chunk);
+		SimulateChunk(Chunk, DeltaTime);
+
+		if (bRenderCrowd)
+			UpdateInstances(Chunk);
+	}
+}
+
+void UPatrolCrowdSubsystem::GatherPlayers()
+{
+	Players.Reset();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+
+		if (Pawn && Pawn->ActorHasTag(CharacterNames::EngageableTargetTag) && !Pawn->ActorHasTag(CharacterNames::DeadTag))
+			Players.Add({ Pawn, Pawn->GetActorLocation() });
+	}
+}
+
+#pragma endregion
+
+#pragma region Registration
+
+void UPatrolCrowdSubsystem::RegisterSpawner(APatrolCrowdSpawner* Spawner)
+{
+	if (Spawner == nullptr || Spawner->GetEnemyClass() == nullptr)
+		return;
+
+	FCrowdChunk& Chunk = Chunks.AddDefaulted_GetRef();
+	Chunk.Spawner = Spawner;
+	Chunk.SpawnerId = NextSpawnerId++;
+	Chunk.bAuthority = Spawner->HasAuthority();
+	Chunk.FirstAgent = Locations.Num();
+	Chunk.NumAgents = Spawner->GetAgentCount();
+
+	Spawner->GetPatrolTargetLocations(Chunk.TargetLocations, Chunk.TargetSourceIndices);
+
+	if (Chunk.TargetLocations.Num() == 0)
+	{
+		Chunk.TargetLocations.Add(Spawner->GetActorLocation());
+		Chunk.TargetSourceIndices.Add(INDEX_NONE);
+	}
+
+	Chunk.DirtyInstances.Init(false, Chunk.NumAgents);
+
+	const AEnemy* EnemyDefaults = Spawner->GetEnemyClass()->GetDefaultObject<AEnemy>();
+	const FEnemyStatRow& Stats = EnemyDefaults->GetStats();
+
+	FCrowdArchetype& Archetype = Chunk.Archetype;
+	Archetype.EnemyClass = Spawner->GetEnemyClass();
+	Archetype.Seed = Spawner->GetCrowdSeed();
+	Archetype.PatrolRadius = Stats.Stats.PatrolRadius;
+	Archetype.PatrolWaitingTimeMin = Stats.Stats.PatrolWaitingTimeMin;
+	Archetype.PatrolWaitingTimeMax = Stats.Stats.PatrolWaitingTimeMax;
+	Archetype.PatrollingSpeed = Stats.Stats.PatrollingSpeed;
+	Archetype.CombatRadiusSquared = Stats.CombatRadiusSquared;
+	Archetype.SightRadiusSquared = Stats.SightRadiusSquared;
+	Archetype.CosPeripheralVision = Stats.CosPeripheralVision;
+	Archetype.HalfHeight = EnemyDefaults->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+
+	const int32 NewNum = Locations.Num() + Chunk.NumAgents;
+	Locations.Reserve(NewNum);
+	Yaws.Reserve(NewNum);
+	WaitTimes.Reserve(NewNum);
+	TargetIndices.Reserve(NewNum);
+	PatrolSteps.Reserve(NewNum);
+	Flags.Reserve(NewNum);
+
+	const FVector Origin = Spawner->GetActorLocation();
+	const float SpawnRadius = Spawner->GetSpawnRadius();
+
+	TArray<FTransform> InitialTransforms;
+	InitialTransforms.Reserve(Chunk.NumAgents);
+
+	for (int32 Index = 0; Index < Chunk.NumAgents; ++Index)
+	{
+		FRandomStream Stream = GetAgentStream(Chunk, Index, 0);
+
+		const FVector2D Offset = FVector2D(Stream.FRandRange(-1.f, 1.f), Stream.FRandRange(-1.f, 1.f)).GetSafeNormal() * Stream.FRandRange(0.f, SpawnRadius);
+
+		Locations.Add(Origin + FVector(Offset, 0.f));
+		Yaws.Add(Stream.FRandRange(-180.f, 180.f));
+		WaitTimes.Add(Stream.FRandRange(0.f, Archetype.PatrolWaitingTimeMax));
+		TargetIndices.Add(ChooseNextTarget(INDEX_NONE, Chunk.TargetLocations.Num(), Stream));
+		PatrolSteps.Add(1);
+		Flags.Add(AF_None);
+	}
+
+	// A client joining late starts where the server's crowd has walked to since it was placed.
+	if (!Chunk.bAuthority)
+	{
+		const float Elapsed = static_cast<float>(GetCrowdTime() - Spawner->GetCrowdStartTime());
+
+		for (int32 Index = 0; Index < Chunk.NumAgents; ++Index)
+			AdvanceAgent(Chunk, Chunk.FirstAgent + Index, Elapsed);
+	}
+
+	for (int32 Index = 0; Index < Chunk.NumAgents; ++Index)
+		InitialTransforms.Add(GetInstanceTransform(Chunk.FirstAgent + Index));
+
+	UInstancedStaticMeshComponent* Instances = Spawner->GetCrowdInstances();
+	Instances->ClearInstances();
+	Instances->AddInstances(InitialTransforms, false, true);
+
+	if (!Chunk.bAuthority)
+		ApplyReplicatedState(Spawner);
+}
+
+void UPatrolCrowdSubsystem::UnregisterSpawner(APatrolCrowdSpawner* Spawner)
+{
+	const int32 ChunkIndex = Chunks.IndexOfByPredicate([Spawner](const FCrowdChunk& Chunk) { return Chunk.Spawner == Spawner; });
+
+	if (ChunkIndex == INDEX_NONE)
+		return;
+
+	const FCrowdChunk& Removed = Chunks[ChunkIndex];
+	const int32 First = Removed.FirstAgent;
+	const int32 Count = Removed.NumAgents;
+
+	for (const TPair<int32, TWeakObjectPtr<AEnemy>>& Promoted : Removed.PromotedEnemies)
+	{
+		if (AEnemy* Enemy = Promoted.Value.Get())
+			Enemy->ClearCrowdHandle();
+	}
+
+	NumPromotedAgents -= Removed.PromotedEnemies.Num();
+
+	Locations.RemoveAt(First, Count, false);
+	Yaws.RemoveAt(First, Count, false);
+	WaitTimes.RemoveAt(First, Count, false);
+	TargetIndices.RemoveAt(First, Count, false);
+	PatrolSteps.RemoveAt(First, Count, false);
+	Flags.RemoveAt(First, Count, false);
+
+	Chunks.RemoveAt(ChunkIndex);
+
+	for (int32 Index = ChunkIndex; Index < Chunks.Num(); ++Index)
+		Chunks[Index].FirstAgent -= Count;
+}
+
+UPatrolCrowdSubsystem::FCrowdChunk* UPatrolCrowdSubsystem::FindChunk(uint32 SpawnerId)
+{
+	return Chunks.FindByPredicate([SpawnerId](const FCrowdChunk& Chunk) { return Chunk.SpawnerId == SpawnerId; });
+}
+
+#pragma endregion
+
+#pragma region Simulation
+
+void UPatrolCrowdSubsystem::SimulateChunk(FCrowdChunk& Chunk, float DeltaTime)
+{
+	const FCrowdArchetype& Archetype = Chunk.Archetype;
+	const int32 NumTargets = Chunk.TargetLocations.Num();
+	const float StepDistance = Archetype.PatrollingSpeed * DeltaTime;
+	const float PatrolRadiusSquared = FMath::Square(Archetype.PatrolRadius);
+
+	for (int32 Local = 0; Local < Chunk.NumAgents; ++Local)
+	{
+		const int32 Agent = Chunk.FirstAgent + Local;
+
+		if (Flags[Agent] != AF_None)
+			continue;
+
+		APawn* SeenPlayer = nullptr;
+		if (Chunk.bAuthority && CanSeePlayer(Chunk, Agent, SeenPlayer))
+		{
+			PromoteAgent(Chunk, Local, SeenPlayer);
+			continue;
+		}
+
+		if (WaitTimes[Agent] > 0.f)
+		{
+			WaitTimes[Agent] -= DeltaTime;
+			continue;
+		}
+
+		FVector& Location = Locations[Agent];
+		const FVector ToTarget = Chunk.TargetLocations[TargetIndices[Agent]] - Location;
+		const float DistanceSquared = ToTarget.SizeSquared2D();
+
+		if (DistanceSquared <= PatrolRadiusSquared)
+		{
+			ChooseNextLeg(Chunk, Agent);
+			continue;
+		}
+
+		const float Distance = FMath::Sqrt(DistanceSquared);
+		const float Alpha = FMath::Min(StepDistance / Distance, 1.f);
+
+		Location += ToTarget * Alpha;
+		Yaws[Agent] = FMath::RadiansToDegrees(FMath::Atan2(ToTarget.Y, ToTarget.X));
+
+		MarkInstanceDirty(Chunk, Local);
+	}
+}
+
+bool UPatrolCrowdSubsystem::CanSeePlayer(const FCrowdChunk& Chunk, int32 AgentIndex, APawn*& OutPlayer)
+{
+	const FCrowdArchetype& Archetype = Chunk.Archetype;
+	const FVector& Location = Locations[AgentIndex];
+
+	for (const FPlayerView& Player : Players)
+	{
+		const FVector ToPlayer = Player.Location - Location;
+		const float DistanceSquared = ToPlayer.SizeSquared();
+
+		if (DistanceSquared <= Archetype.CombatRadiusSquared)
+		{
+			OutPlayer = Player.Pawn;
+			return true;
+		}
+
+		if (DistanceSquared > Archetype.SightRadiusSquared || SightTracesThisFrame >= MaxSightTracesPerFrame)
+			continue;
+
+		float SinYaw, CosYaw;
+		FMath::SinCos(&SinYaw, &CosYaw, FMath::DegreesToRadians(Yaws[AgentIndex]));
+
+		const FVector Forward(CosYaw, SinYaw, 0.f);
+		if (FVector::DotProduct(Forward, ToPlayer) < Archetype.CosPeripheralVision * FMath::Sqrt(DistanceSquared))
+			continue;
+
+		++SightTracesThisFrame;
+
+		const FVector EyeLocation = Location + FVector(0.f, 0.f, Archetype.HalfHeight * 1.8f);
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(PatrolCrowdSight), false, Player.Pawn);
+		if (!GetWorld()->LineTraceTestByChannel(EyeLocation, Player.Location, ECollisionChannel::ECC_Visibility, QueryParams))
+		{
+			OutPlayer = Player.Pawn;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void UPatrolCrowdSubsystem::UpdateInstances(FCrowdChunk& Chunk)
+{
+	APatrolCrowdSpawner* Spawner = Chunk.Spawner.Get();
+
+	if (Spawner == nullptr || Chunk.NumDirtyInstances == 0)
+		return;
+
+	UInstancedStaticMeshComponent* Instances = Spawner->GetCrowdInstances();
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	if (!Instances->WasRecentlyRendered(PatrolCrowd::RecentlyRenderedTolerance) && Now - Chunk.LastInstanceUpload < PatrolCrowd::OffscreenUploadInterval)
+		return;
+
+	Chunk.LastInstanceUpload = Now;
+
+	// Waiting agents stay put, so only the runs of agents that moved are uploaded.
+	for (TConstSetBitIterator<> It(Chunk.DirtyInstances); It;)
+	{
+		const int32 RunStart = It.GetIndex();
+		InstanceTransformScratch.Reset();
+
+		for (int32 Local = RunStart; It && It.GetIndex() == Local; ++It, ++Local)
+			InstanceTransformScratch.Add(GetInstanceTransform(Chunk.FirstAgent + Local));
+
+		Instances->BatchUpdateInstancesTransforms(RunStart, InstanceTransformScratch, true, false, false);
+	}
+
+	Instances->MarkRenderStateDirty();
+
+	Chunk.DirtyInstances.SetRange(0, Chunk.NumAgents, false);
+	Chunk.NumDirtyInstances = 0;
+}
+
+FTransform UPatrolCrowdSubsystem::GetInstanceTransform(int32 Agent) const
+{
+	if (Flags[Agent] == AF_None)
+		return FTransform(FRotator(0.f, Yaws[Agent], 0.f), Locations[Agent]);
+
+	return FTransform(FQuat::Identity, Locations[Agent], FVector::ZeroVector);
+}
+
+void UPatrolCrowdSubsystem::AdvanceAgent(FCrowdChunk& Chunk, int32 Agent, float Seconds)
+{
+	const FCrowdArchetype& Archetype = Chunk.Archetype;
+
+	for (int32 Leg = 0; Seconds > 0.f && Leg < PatrolCrowd::MaxCatchUpLegs; ++Leg)
+	{
+		if (WaitTimes[Agent] > 0.f)
+		{
+			const float Waited = FMath::Min(WaitTimes[Agent], Seconds);
+			WaitTimes[Agent] -= Waited;
+			Seconds -= Waited;
+			continue;
+		}
+
+		FVector& Location = Locations[Agent];
+		const FVector ToTarget = Chunk.TargetLocations[TargetIndices[Agent]] - Location;
+		const float Distance = ToTarget.Size2D();
+
+		// Within a centimetre of the patrol radius counts as arrived, so rounding cannot leave an agent short forever.
+		if (Distance <= Archetype.PatrolRadius + 1.f)
+		{
+			ChooseNextLeg(Chunk, Agent);
+			continue;
+		}
+
+		if (Archetype.PatrollingSpeed <= 0.f)
+			break;
+
+		const float Travel = FMath::Min(Distance - Archetype.PatrolRadius, Archetype.PatrollingSpeed * Seconds);
+
+		Location += ToTarget * (Travel / Distance);
+		Yaws[Agent] = FMath::RadiansToDegrees(FMath::Atan2(ToTarget.Y, ToTarget.X));
+		Seconds -= Travel / Archetype.PatrollingSpeed;
+	}
+}
+
+FRandomStream UPatrolCrowdSubsystem::GetAgentStream(const FCrowdChunk& Chunk, int32 LocalIndex, int32 PatrolStep)
+{
+	return FRandomStream(static_cast<int32>(HashCombine(HashCombine(GetTypeHash(Chunk.Archetype.Seed), GetTypeHash(LocalIndex)), GetTypeHash(PatrolStep))));
+}
+
+int32 UPatrolCrowdSubsystem::ChooseNextTarget(int32 CurrentTarget, int32 NumTargets, FRandomStream& Stream)
+{
+	if (NumTargets <= 1)
+		return 0;
+
+	if (CurrentTarget == INDEX_NONE)
+		return Stream.RandRange(0, NumTargets - 1);
+
+	int32 NextTarget = Stream.RandRange(0, NumTargets - 2);
+
+	if (NextTarget >= CurrentTarget)
+		++NextTarget;
+
+	return NextTarget;
+}
+
+void UPatrolCrowdSubsystem::ChooseNextLeg(const FCrowdChunk& Chunk, int32 Agent)
+{
+	FRandomStream Stream = GetAgentStream(Chunk, Agent - Chunk.FirstAgent, PatrolSteps[Agent]++);
+
+	TargetIndices[Agent] = ChooseNextTarget(TargetIndices[Agent], Chunk.TargetLocations.Num(), Stream);
+	WaitTimes[Agent] = Stream.FRandRange(Chunk.Archetype.PatrolWaitingTimeMin, Chunk.Archetype.PatrolWaitingTimeMax);
+}
+
+#pragma endregion
+
+#pragma region Promotion
+
+void UPatrolCrowdSubsystem::PromoteAgent(FCrowdChunk& Chunk, int32 LocalIndex, APawn* Target)
+{
+	APatrolCrowdSpawner* Spawner = Chunk.Spawner.Get();
+	const int32 Agent = Chunk.FirstAgent + LocalIndex;
+
+	if (Spawner == nullptr)
+		return;
+
+	const FVector SpawnLocation = Locations[Agent] + FVector(0.f, 0.f, Chunk.Archetype.HalfHeight);
+	const FTransform SpawnTransform(FRotator(0.f, Yaws[Agent], 0.f), SpawnLocation);
+
+	AEnemy* Enemy = GetWorld()->SpawnActorDeferred<AEnemy>(
+		Chunk.Archetype.EnemyClass,
+		SpawnTransform,
+		nullptr,
+		nullptr,
+		ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn
+	);
+
+	if (Enemy == nullptr)
+		return;
+
+	// Agents index the compacted target locations; map back to the spawner's own list, which may contain unset targets.
+	const TArray<AActor*>& PatrolTargets = Spawner->GetPatrolTargets();
+	const int32 SourceIndex = Chunk.TargetSourceIndices[TargetIndices[Agent]];
+	AActor* CurrentTarget = PatrolTargets.IsValidIndex(SourceIndex) ? PatrolTargets[SourceIndex] : nullptr;
+
+	FPatrolCrowdHandle Handle;
+	Handle.SpawnerId = Chunk.SpawnerId;
+	Handle.AgentIndex = LocalIndex;
+
+	Enemy->InitializeCrowdAgent(Handle, PatrolTargets, CurrentTarget);
+	Enemy->FinishSpawning(SpawnTransform);
+
+	if (Enemy->GetController() == nullptr)
+		Enemy->SpawnDefaultController();
+
+	Enemy->EngageTarget(Target);
+
+	Flags[Agent] = AF_Promoted;
+	MarkInstanceDirty(Chunk, LocalIndex);
+	Spawner->SetAgentHidden(LocalIndex, true);
+	Chunk.PromotedEnemies.Add(LocalIndex, Enemy);
+	++NumPromotedAgents;
+}
+
+void UPatrolCrowdSubsystem::RefreshPromotedAgents(FCrowdChunk& Chunk)
+{
+	for (auto It = Chunk.PromotedEnemies.CreateIterator(); It; ++It)
+	{
+		const int32 Agent = Chunk.FirstAgent + It.Key();
+		AEnemy* Enemy = It.Value().Get();
+
+		if (Enemy == nullptr || Enemy->GetEnemyState() == EEnemyState::EES_Dead)
+		{
+			Flags[Agent] = AF_Dead;
+			--NumPromotedAgents;
+			It.RemoveCurrent();
+			continue;
+		}
+
+		Locations[Agent] = Enemy->GetActorLocation() - FVector(0.f, 0.f, Chunk.Archetype.HalfHeight);
+		Yaws[Agent] = Enemy->GetActorRotation().Yaw;
+	}
+}
+
+void UPatrolCrowdSubsystem::RequestDemotion(AEnemy* Enemy)
+{
+	PendingDemotions.AddUnique(Enemy);
+}
+
+void UPatrolCrowdSubsystem::ProcessDemotions()
+{
+	// An enemy that loses interest mid-attack only goes back to patrolling once the attack ends, so its request is kept
+	// until then. Requests from enemies that died or were already demoted are dropped.
+	PendingDemotions.RemoveAll([this](const TWeakObjectPtr<AEnemy>& WeakEnemy)
+	{
+		AEnemy* Enemy = WeakEnemy.Get();
+
+		if (Enemy == nullptr || Enemy->GetEnemyState() == EEnemyState::EES_Dead)
+			return true;
+
+		if (Enemy->GetEnemyState() != EEnemyState::EES_Patrolling)
+			return false;
+
+		const FPatrolCrowdHandle Handle = Enemy->GetCrowdHandle();
+		FCrowdChunk* Chunk = FindChunk(Handle.SpawnerId);
+
+		if (Chunk == nullptr || !Chunk->PromotedEnemies.Contains(Handle.AgentIndex))
+			return true;
+
+		const int32 Agent = Chunk->FirstAgent + Handle.AgentIndex;
+
+		Locations[Agent] = Enemy->GetActorLocation() - FVector(0.f, 0.f, Chunk->Archetype.HalfHeight);
+		Yaws[Agent] = Enemy->GetActorRotation().Yaw;
+		WaitTimes[Agent] = 0.f;
+		Flags[Agent] = AF_None;
+		MarkInstanceDirty(*Chunk, Handle.AgentIndex);
+
+		if (APatrolCrowdSpawner* Spawner = Chunk->Spawner.Get())
+		{
+			FPatrolCrowdAgentSync Sync;
+			Sync.AgentIndex = Handle.AgentIndex;
+			Sync.TargetIndex = TargetIndices[Agent];
+			Sync.PatrolStep = PatrolSteps[Agent];
+			Sync.Location = Locations[Agent];
+			Sync.Yaw = Yaws[Agent];
+			Sync.ServerTime = GetCrowdTime();
+
+			Spawner->SyncAgent(Sync);
+			Spawner->SetAgentHidden(Handle.AgentIndex, false);
+		}
+
+		Chunk->PromotedEnemies.Remove(Handle.AgentIndex);
+		--NumPromotedAgents;
+
+		if (AController* Controller = Enemy->GetController())
+			Controller->Destroy();
+
+		Enemy->Destroy();
+
+		return true;
+	});
+}
+
+#pragma endregion
+
+#pragma region Replication
+
+double UPatrolCrowdSubsystem::GetCrowdTime() const
+{
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+
+	return GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+}
+
+void UPatrolCrowdSubsystem::ApplyReplicatedState(APatrolCrowdSpawner* Spawner)
+{
+	FCrowdChunk* Chunk = Chunks.FindByPredicate([Spawner](const FCrowdChunk& Candidate) { return Candidate.Spawner == Spawner; });
+
+	if (Chunk == nullptr || Chunk->bAuthority)
+		return;
+
+	const double Now = GetCrowdTime();
+
+	for (const FPatrolCrowdAgentSync& Sync : Spawner->GetAgentSyncs())
+	{
+		if (Sync.AgentIndex < 0 || Sync.AgentIndex >= Chunk->NumAgents)
+			continue;
+
+		uint16& AppliedRevision = Chunk->AppliedSyncRevisions.FindOrAdd(Sync.AgentIndex);
+
+		if (AppliedRevision == Sync.Revision)
+			continue;
+
+		AppliedRevision = Sync.Revision;
+
+		const int32 Agent = Chunk->FirstAgent + Sync.AgentIndex;
+
+		Locations[Agent] = Sync.Location;
+		Yaws[Agent] = Sync.Yaw;
+		WaitTimes[Agent] = 0.f;
+		TargetIndices[Agent] = FMath::Clamp(Sync.TargetIndex, 0, Chunk->TargetLocations.Num() - 1);
+		PatrolSteps[Agent] = Sync.PatrolStep;
+
+		AdvanceAgent(*Chunk, Agent, static_cast<float>(Now - Sync.ServerTime));
+		MarkInstanceDirty(*Chunk, Sync.AgentIndex);
+	}
+
+	TBitArray<> Hidden(false, Chunk->NumAgents);
+
+	for (const int32 LocalIndex : Spawner->GetHiddenAgents())
+	{
+		if (LocalIndex >= 0 && LocalIndex < Chunk->NumAgents)
+			Hidden[LocalIndex] = true;
+	}
+
+	// Promoted agents are drawn by their replicated enemy, and dead ones by nothing.
+	for (int32 Local = 0; Local < Chunk->NumAgents; ++Local)
+	{
+		const uint8 NewFlags = Hidden[Local] ? AF_Promoted : AF_None;
+		uint8& AgentFlags = Flags[Chunk->FirstAgent + Local];
+
+		if (AgentFlags != NewFlags)
+		{
+			AgentFlags = NewFlags;
+			MarkInstanceDirty(*Chunk, Local);
+		}
+	}
+}
+
+#pragma endregion
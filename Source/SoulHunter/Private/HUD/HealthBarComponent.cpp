@@ -5,8 +5,27 @@
 #include "HUD/HealthBar.h"
 #include "Components/ProgressBar.h"
 
+void UHealthBarComponent::InitWidget()
+{
+	if (bDeferWidgetCreation)
+		return;
+
+	Super::InitWidget();
+}
+
+void UHealthBarComponent::CreateDeferredWidget()
+{
+	if (!bDeferWidgetCreation)
+		return;
+
+	bDeferWidgetCreation = false;
+	InitWidget();
+}
+
 void UHealthBarComponent::SetHealthPercent(float Percent)
 {
+	CreateDeferredWidget();
+
 	if (HealthBarWidget == nullptr)
 		HealthBarWidget = Cast<UHealthBar>(GetUserWidgetObject());
 
@@ -5,12 +5,21 @@
 #include "Components/SphereComponent.h"
 #include "NiagaraComponent.h"
 #include "Interfaces/PickupInterface.h"
+#include "Items/PickupSubsystem.h"
 #include "NiagaraFunctionLibrary.h"
 #include "Kismet/GameplayStatics.h"
+#include "Persistence/WorldStateSubsystem.h"
+#include "Diagnostics/TickAudit.h"
+#include "Diagnostics/CombatTelemetry.h"
 
 AItem::AItem()
 {
+	// Only ticks while hovering. The hover is cosmetic, so nothing has to wait for it before physics.
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_DuringPhysics;
+
+	bReplicates = true;
+	NetDormancy = DORM_Initial;
 
 	ItemMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("ItemMeshComponent"));
 	RootComponent = ItemMesh;
@@ -26,10 +35,126 @@ void AItem::BeginPlay()
 {
 	Super::BeginPlay();
 
-	SphereCollider->OnComponentBeginOverlap.AddDynamic(this, &AItem::OnSphereOverlap);
-	SphereCollider->OnComponentEndOverlap.AddDynamic(this, &AItem::OnSphereEndOverlap);
+	if (IsAutoCollected())
+	{
+		if (UPickupSubsystem* PickupSubsystem = UPickupSubsystem::Get(this))
+			PickupSubsystem->AddPickup(this);
+	}
+	else
+	{
+		SphereCollider->OnComponentBeginOverlap.AddDynamic(this, &AItem::OnSphereOverlap);
+		SphereCollider->OnComponentEndOverlap.AddDynamic(this, &AItem::OnSphereEndOverlap);
+	}
+
+	bSpawnedAtRuntime = !(HasAnyFlags(RF_WasLoaded) || IsNetStartupActor());
+
+	if (bSpawnedAtRuntime && ShouldPersistWhenSpawned() && HasAuthority())
+	{
+		if (UWorldStateSubsystem* WorldState = UWorldStateSubsystem::Get(this))
+			WorldState->TrackDynamicPickup(this);
+	}
+}
+
+void AItem::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UPickupSubsystem* PickupSubsystem = IsAutoCollected() ? UPickupSubsystem::Get(this) : nullptr)
+		PickupSubsystem->RemovePickup(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+#pragma region Collection
+
+void AItem::Collect(AActor* Collector)
+{
+	IPickupInterface* PickupInterface = Cast<IPickupInterface>(Collector);
+
+	if (bCollected || PickupInterface == nullptr)
+		return;
+
+	bCollected = true;
+
+	if (HasAuthority())
+		SH_COMBAT_TELEMETRY(Pickup, Collector, this, GetPersistentAmount());
+
+	if (UPickupSubsystem* PickupSubsystem = UPickupSubsystem::Get(this))
+		PickupSubsystem->RemovePickup(this);
+
+	// Clients hide it straight away; it goes for good when the server's destroy reaches them.
+	if (!HasAuthority())
+	{
+		SetActorHiddenInGame(true);
+		GetWorldTimerManager().SetTimer(CollectConfirmTimer, this, &AItem::RestoreUnconfirmedCollect, CollectConfirmTimeout);
+	}
+
+	OnCollected(PickupInterface);
+}
+
+void AItem::RestoreUnconfirmedCollect()
+{
+	// The server did not agree, most likely because it never saw the player reach the pickup. Still there, then.
+	bCollected = false;
+	SetActorHiddenInGame(false);
+
+	if (UPickupSubsystem* PickupSubsystem = UPickupSubsystem::Get(this))
+		PickupSubsystem->AddPickup(this);
 }
 
+void AItem::MoveTowardsCollector(const FVector& CollectorLocation, float Step)
+{
+	bMagnetized = true;
+
+	SetActorLocation(GetActorLocation() + (CollectorLocation - GetActorLocation()).GetClampedToMaxSize(Step));
+
+	if (UPickupSubsystem* PickupSubsystem = UPickupSubsystem::Get(this))
+		PickupSubsystem->UpdatePickup(this);
+}
+
+#pragma endregion
+
+#pragma region Persistence
+
+FGuid AItem::GetPersistentGuid() const
+{
+	if (!PersistentGuid.IsValid())
+		PersistentGuid = UWorldStateSubsystem::MakeActorGuid(this);
+
+	return PersistentGuid;
+}
+
+bool AItem::WritePersistentState(FActorStateRecord& OutRecord) const
+{
+	if (!bLooted || bSpawnedAtRuntime)
+		return false;
+
+	OutRecord.Flags = EActorStateFlags::Looted;
+
+	return true;
+}
+
+void AItem::ApplyPersistentState(const FActorStateRecord& Record)
+{
+	if (Record.HasAnyFlags(EActorStateFlags::Looted))
+		Destroy();
+}
+
+void AItem::NotifyLooted()
+{
+	bLooted = true;
+
+	UWorldStateSubsystem* WorldState = UWorldStateSubsystem::Get(this);
+
+	if (WorldState == nullptr)
+		return;
+
+	if (bSpawnedAtRuntime)
+		WorldState->UntrackDynamicPickup(this);
+	else
+		WorldState->RecordActorState(this);
+}
+
+#pragma endregion
+
 float AItem::TransformedSin()
 {
 	return Amplitude * FMath::Sin(RunningTime * TimeConstant);
@@ -80,11 +205,21 @@ void AItem::SpawnPickupSound()
 
 void AItem::Tick(float DeltaTime)
 {
+	SH_TICK_AUDIT_SCOPE();
+
 	Super::Tick(DeltaTime);
 
 	RunningTime += DeltaTime;
 
 	if (ItemState == EItemState::EIS_Hovering)
 		AddActorWorldOffset(FVector(0.f, 0.f, TransformedSin()));
+
+	// Placed items start dormant (DORM_Initial); runtime drops are awake until they have replicated and settled.
+	if (IsAwaitingDormancy() && ItemState == EItemState::EIS_Hovering && RunningTime >= MinAwakeTime && IsSettled())
+		SetNetDormancy(DORM_DormantAll);
+
+	// A dedicated server draws nothing, so once the item has settled (and a runtime drop has gone dormant) it stops ticking.
+	if (GetNetMode() == NM_DedicatedServer && IsSettled() && !IsAwaitingDormancy())
+		SetActorTickEnabled(false);
 }
 
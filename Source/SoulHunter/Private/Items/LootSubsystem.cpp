@@ -0,0 +1,226 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Items/LootSubsystem.h"
+#include "Items/Item.h"
+#include "Interfaces/PersistentInterface.h"
+#include "SoulHunter.h"
+#include "Diagnostics/CombatTelemetry.h"
+#include "Engine/Engine.h"
+#include "HAL/IConsoleManager.h"
+
+namespace Loot
+{
+	TAutoConsoleVariable<int32> CVarSeed(
+		TEXT("sh.Loot.Seed"),
+		0,
+		TEXT("World seed for loot rolls, read when a world starts. 0 picks a new seed every time; the one used is logged."));
+
+	TAutoConsoleVariable<float> CVarClusterRadius(
+		TEXT("sh.Loot.ClusterRadius"),
+		300.f,
+		TEXT("Drops of the same pickup class closer than this are merged into one pickup."));
+
+	TAutoConsoleVariable<float> CVarClusterWindow(
+		TEXT("sh.Loot.ClusterWindow"),
+		.25f,
+		TEXT("Seconds a cluster keeps taking drops before its pickup is spawned."));
+}
+
+#pragma region Main
+
+ULootSubsystem* ULootSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+
+	return World ? World->GetSubsystem<ULootSubsystem>() : nullptr;
+}
+
+bool ULootSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId ULootSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULootSubsystem, STATGROUP_Tickables);
+}
+
+void ULootSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	WorldSeed = Loot::CVarSeed.GetValueOnGameThread();
+
+	if (WorldSeed == 0)
+		WorldSeed = static_cast<int32>(FPlatformTime::Cycles());
+
+	UE_LOG(LogSoulHunter, Log, TEXT("Loot: world seed %d"), WorldSeed);
+}
+
+void ULootSubsystem::Tick(float DeltaTime)
+{
+	if (PendingClusters.Num() == 0)
+		return;
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float ClusterWindow = Loot::CVarClusterWindow.GetValueOnGameThread();
+
+	for (int32 Index = PendingClusters.Num() - 1; Index >= 0; --Index)
+	{
+		if (Now - PendingClusters[Index].FirstDropTime < ClusterWindow)
+			continue;
+
+		const FLootCluster Cluster = PendingClusters[Index];
+		PendingClusters.RemoveAtSwap(Index, 1, false);
+
+		SpawnCluster(Cluster);
+	}
+}
+
+FRandomStream ULootSubsystem::MakeStream(const AActor* Source)
+{
+	uint32 SourceHash = 0;
+
+	if (const IPersistentInterface* Persistent = Cast<IPersistentInterface>(Source))
+		SourceHash = GetTypeHash(Persistent->GetPersistentGuid());
+	else if (Source)
+		SourceHash = GetTypeHash(Source->GetFName());
+
+	const int32 RollIndex = SourceRollCounts.FindOrAdd(SourceHash)++;
+
+	return FRandomStream(static_cast<int32>(HashCombine(HashCombine(static_cast<uint32>(WorldSeed), SourceHash), static_cast<uint32>(RollIndex))));
+}
+
+void ULootSubsystem::RollTable(const ULootTable* Table, const AActor* Source, const FVector& Location)
+{
+	if (Table == nullptr)
+		return;
+
+	FRandomStream Stream = MakeStream(Source);
+
+	TArray<FLootDrop> Drops;
+	Table->Roll(Stream, Drops, Source);
+
+	for (const FLootDrop& Drop : Drops)
+		AddDrop(Drop.ItemClass, Drop.Amount, Location);
+}
+
+void ULootSubsystem::AddDrop(TSubclassOf<AItem> ItemClass, int32 Amount, const FVector& Location)
+{
+	if (ItemClass == nullptr)
+		return;
+
+	++NumDrops;
+
+	// Zero means the class's own amount; it is filled in here so merged clusters add up correctly.
+	if (Amount <= 0)
+		Amount = ItemClass->GetDefaultObject<AItem>()->GetPersistentAmount();
+
+	const float ClusterRadiusSquared = FMath::Square(Loot::CVarClusterRadius.GetValueOnGameThread());
+
+	for (FLootCluster& Cluster : PendingClusters)
+	{
+		if (Cluster.ItemClass == ItemClass && FVector::DistSquared(Cluster.Location, Location) <= ClusterRadiusSquared)
+		{
+			Cluster.Amount += Amount;
+			++Cluster.NumDrops;
+			return;
+		}
+	}
+
+	FLootCluster& NewCluster = PendingClusters.AddDefaulted_GetRef();
+	NewCluster.ItemClass = ItemClass;
+	NewCluster.Location = Location;
+	NewCluster.Amount = Amount;
+	NewCluster.NumDrops = 1;
+	NewCluster.FirstDropTime = GetWorld()->GetTimeSeconds();
+}
+
+void ULootSubsystem::SpawnCluster(const FLootCluster& Cluster)
+{
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	AItem* Item = GetWorld()->SpawnActor<AItem>(Cluster.ItemClass, Cluster.Location, FRotator::ZeroRotator, SpawnParameters);
+
+	if (Item == nullptr)
+		return;
+
+	Item->SetPersistentAmount(Cluster.Amount);
+	++NumSpawned;
+
+	SH_COMBAT_TELEMETRY(Drop, nullptr, Item, Cluster.Amount, static_cast<uint8>(FMath::Min(Cluster.NumDrops, 255)));
+}
+
+void ULootSubsystem::LogReport() const
+{
+	UE_LOG(LogSoulHunter, Display, TEXT("Loot: world seed %d, %d drops spawned as %d pickups, %d clusters pending"),
+		WorldSeed, NumDrops, NumSpawned, PendingClusters.Num());
+}
+
+#pragma endregion
+
+#pragma region Console Commands
+
+namespace Loot
+{
+	static FAutoConsoleCommandWithWorld ReportCommand(
+		TEXT("sh.Loot.Report"),
+		TEXT("Logs the world seed and how many drops were merged into how many pickups."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (const ULootSubsystem* LootSubsystem = ULootSubsystem::Get(World))
+				LootSubsystem->LogReport();
+		}));
+
+	static FAutoConsoleCommandWithArgs SimulateCommand(
+		TEXT("sh.Loot.Simulate"),
+		TEXT("Rolls a loot table many times and logs how often each entry came up: sh.Loot.Simulate <TablePath> [Rolls] [Seed]."),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const ULootTable* Table = Args.Num() > 0 ? LoadObject<ULootTable>(nullptr, *Args[0]) : nullptr;
+
+			if (Table == nullptr)
+			{
+				UE_LOG(LogSoulHunter, Warning, TEXT("Loot: sh.Loot.Simulate needs a loot table path"));
+				return;
+			}
+
+			const int32 NumRolls = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 100000;
+			FRandomStream Stream(Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 0);
+
+			TArray<int32> Counts;
+			Counts.SetNumZeroed(Table->Entries.Num());
+
+			const double StartTime = FPlatformTime::Seconds();
+
+			for (int32 Roll = 0; Roll < NumRolls; ++Roll)
+			{
+				const int32 EntryIndex = Table->PickEntry(Stream);
+
+				if (EntryIndex != INDEX_NONE)
+					++Counts[EntryIndex];
+			}
+
+			const double Elapsed = FPlatformTime::Seconds() - StartTime;
+			float TotalWeight = 0.f;
+
+			for (const FLootEntry& Entry : Table->Entries)
+				TotalWeight += Entry.bGuaranteed ? 0.f : Entry.Weight;
+
+			UE_LOG(LogSoulHunter, Display, TEXT("Loot: %d picks from %s in %.3f ms"), NumRolls, *Table->GetName(), Elapsed * 1000.0);
+
+			for (int32 EntryIndex = 0; EntryIndex < Table->Entries.Num(); ++EntryIndex)
+			{
+				const FLootEntry& Entry = Table->Entries[EntryIndex];
+
+				UE_LOG(LogSoulHunter, Display, TEXT("  %-48s %s expected %6.2f%%  rolled %6.2f%%"),
+					Entry.ItemClass.IsNull() ? TEXT("(nothing)") : *Entry.ItemClass.GetAssetName(),
+					Entry.bGuaranteed ? TEXT("guaranteed") : TEXT("          "),
+					Entry.bGuaranteed || TotalWeight <= 0.f ? 0.f : Entry.Weight * 100.f / TotalWeight,
+					Counts[EntryIndex] * 100.f / NumRolls);
+			}
+		}));
+}
+
+#pragma endregion
@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Items/LootTable.h"
+#include "Items/Item.h"
+#include "Loading/AssetPreloadSubsystem.h"
+
+void ULootTable::PostLoad()
+{
+	Super::PostLoad();
+
+	CompileAliasTable();
+}
+
+#if WITH_EDITOR
+
+void ULootTable::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	CompileAliasTable();
+}
+
+#endif
+
+void ULootTable::CompileAliasTable()
+{
+	Probabilities.Reset();
+	SlotEntries.Reset();
+	Aliases.Reset();
+
+	double TotalWeight = 0.0;
+
+	for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
+	{
+		if (!Entries[EntryIndex].bGuaranteed && Entries[EntryIndex].Weight > 0.f)
+		{
+			SlotEntries.Add(EntryIndex);
+			TotalWeight += Entries[EntryIndex].Weight;
+		}
+	}
+
+	const int32 NumSlots = SlotEntries.Num();
+
+	if (NumSlots == 0)
+		return;
+
+	// Vose's alias method: scale weights so the average slot is 1, then pair every under-full slot with an over-full one.
+	TArray<double> Scaled;
+	Scaled.SetNumUninitialized(NumSlots);
+
+	TArray<int32> Small;
+	TArray<int32> Large;
+
+	for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+	{
+		Scaled[Slot] = Entries[SlotEntries[Slot]].Weight * NumSlots / TotalWeight;
+		(Scaled[Slot] < 1.0 ? Small : Large).Add(Slot);
+	}
+
+	Probabilities.SetNumZeroed(NumSlots);
+	Aliases.SetNumZeroed(NumSlots);
+
+	while (Small.Num() > 0 && Large.Num() > 0)
+	{
+		const int32 Under = Small.Pop(false);
+		const int32 Over = Large.Last();
+
+		Probabilities[Under] = Scaled[Under];
+		Aliases[Under] = Over;
+
+		Scaled[Over] -= 1.0 - Scaled[Under];
+
+		if (Scaled[Over] < 1.0)
+			Small.Add(Large.Pop(false));
+	}
+
+	// Whatever is left is full up to rounding error.
+	for (const int32 Slot : Large)
+		Probabilities[Slot] = 1.f;
+
+	for (const int32 Slot : Small)
+		Probabilities[Slot] = 1.f;
+}
+
+int32 ULootTable::PickEntry(FRandomStream& Stream) const
+{
+	if (SlotEntries.Num() == 0)
+		return INDEX_NONE;
+
+	const int32 Slot = Stream.RandHelper(SlotEntries.Num());
+
+	return SlotEntries[Stream.GetFraction() < Probabilities[Slot] ? Slot : Aliases[Slot]];
+}
+
+void ULootTable::Roll(FRandomStream& Stream, TArray<FLootDrop>& OutDrops, const UObject* Requester) const
+{
+	auto AddDrop = [&Stream, &OutDrops, Requester](const FLootEntry& Entry)
+	{
+		if (Entry.ItemClass.IsNull())
+			return;
+
+		FLootDrop& Drop = OutDrops.AddDefaulted_GetRef();
+		Drop.ItemClass = UAssetPreloadSubsystem::ResolveClass(Entry.ItemClass, Requester);
+		Drop.Amount = Entry.MaxAmount > 0 ? Stream.RandRange(Entry.MinAmount, FMath::Max(Entry.MinAmount, Entry.MaxAmount)) : 0;
+	};
+
+	for (const FLootEntry& Entry : Entries)
+	{
+		if (Entry.bGuaranteed)
+			AddDrop(Entry);
+	}
+
+	for (int32 Pick = 0; Pick < NumPicks; ++Pick)
+	{
+		const int32 EntryIndex = PickEntry(Stream);
+
+		if (EntryIndex != INDEX_NONE)
+			AddDrop(Entries[EntryIndex]);
+	}
+}
+
+void ULootTable::GatherPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const
+{
+	for (const FLootEntry& Entry : Entries)
+	{
+		if (!Entry.ItemClass.IsNull())
+			OutAssets.AddUnique(Entry.ItemClass.ToSoftObjectPath());
+	}
+}
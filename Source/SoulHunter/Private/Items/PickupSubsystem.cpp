@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Items/PickupSubsystem.h"
+#include "Items/Item.h"
+#include "SoulHunter.h"
+#include "Engine/Engine.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pickup Query"), STAT_PickupQuery, STATGROUP_Game);
+
+#pragma region Main
+
+UPickupSubsystem* UPickupSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+
+	return World ? World->GetSubsystem<UPickupSubsystem>() : nullptr;
+}
+
+bool UPickupSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UPickupSubsystem::AddPickup(AItem* Item)
+{
+	if (Item == nullptr || PickupIndices.Contains(Item))
+		return;
+
+	FPickup Pickup;
+	Pickup.Item = Item;
+	Pickup.Cell = GetCell(Item->GetActorLocation());
+
+	const int32 PickupIndex = Pickups.Add(Pickup);
+	PickupIndices.Add(Item, PickupIndex);
+	Cells.FindOrAdd(Pickup.Cell).Add(PickupIndex);
+}
+
+void UPickupSubsystem::RemovePickup(AItem* Item)
+{
+	int32 PickupIndex = INDEX_NONE;
+
+	if (!PickupIndices.RemoveAndCopyValue(Item, PickupIndex))
+		return;
+
+	RemoveFromCell(PickupIndex, Pickups[PickupIndex].Cell);
+	Pickups.RemoveAt(PickupIndex);
+}
+
+void UPickupSubsystem::UpdatePickup(AItem* Item)
+{
+	const int32* PickupIndex = PickupIndices.Find(Item);
+
+	if (PickupIndex == nullptr)
+		return;
+
+	FPickup& Pickup = Pickups[*PickupIndex];
+	const FIntPoint Cell = GetCell(Item->GetActorLocation());
+
+	if (Cell == Pickup.Cell)
+		return;
+
+	RemoveFromCell(*PickupIndex, Pickup.Cell);
+	Cells.FindOrAdd(Cell).Add(*PickupIndex);
+	Pickup.Cell = Cell;
+}
+
+void UPickupSubsystem::RemoveFromCell(int32 PickupIndex, const FIntPoint& Cell)
+{
+	TArray<int32>* CellPickups = Cells.Find(Cell);
+
+	if (CellPickups == nullptr)
+		return;
+
+	CellPickups->RemoveSingleSwap(PickupIndex, false);
+
+	if (CellPickups->Num() == 0)
+		Cells.Remove(Cell);
+}
+
+void UPickupSubsystem::QueryPickups(const FVector& Origin, float Radius, TArray<AItem*>& OutPickups) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_PickupQuery);
+
+	++NumQueries;
+
+	if (Pickups.Num() == 0)
+		return;
+
+	const FIntPoint MinCell = GetCell(Origin - FVector(Radius, Radius, 0.f));
+	const FIntPoint MaxCell = GetCell(Origin + FVector(Radius, Radius, 0.f));
+	const float RadiusSquared = FMath::Square(Radius);
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			const TArray<int32>* CellPickups = Cells.Find(FIntPoint(X, Y));
+
+			if (CellPickups == nullptr)
+				continue;
+
+			for (const int32 PickupIndex : *CellPickups)
+			{
+				AItem* Item = Pickups[PickupIndex].Item;
+				++NumTested;
+
+				if (FVector::DistSquared2D(Origin, Item->GetActorLocation()) > RadiusSquared)
+					continue;
+
+				OutPickups.Add(Item);
+				++NumFound;
+			}
+		}
+	}
+}
+
+void UPickupSubsystem::LogReport() const
+{
+	UE_LOG(LogSoulHunter, Display, TEXT("Pickups: %d indexed in %d cells, %lld queries testing %.1f and finding %.1f pickups on average"),
+		Pickups.Num(), Cells.Num(), NumQueries,
+		NumQueries > 0 ? double(NumTested) / NumQueries : 0.0,
+		NumQueries > 0 ? double(NumFound) / NumQueries : 0.0);
+}
+
+#pragma endregion
+
+#pragma region Console Commands
+
+namespace Pickups
+{
+	static FAutoConsoleCommandWithWorld ReportCommand(
+		TEXT("sh.Pickup.Report"),
+		TEXT("Logs how many pickups are indexed and how many each collector query tested and found."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (const UPickupSubsystem* PickupSubsystem = UPickupSubsystem::Get(World))
+				PickupSubsystem->LogReport();
+		}));
+}
+
+#pragma endregion
@@ -3,68 +3,83 @@
 
 #include "Items/Soul.h"
 #include "Interfaces/PickupInterface.h"
-#include "Kismet/KismetSystemLibrary.h"
+#include "Components/SphereComponent.h"
+#include "SoulHunterDebug.h"
+#include "Diagnostics/TickAudit.h"
 
+ASoul::ASoul()
+{
+	SphereCollider->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
 
 void ASoul::Tick(float DeltaTime)
 {
+	SH_TICK_AUDIT_SCOPE();
+
 	Super::Tick(DeltaTime);
 
-	if (!bFinishedDrifting)
+	// Once a collector pulls it in, the drift would only fight the pull.
+	if (!bFinishedDrifting && !bMagnetized && DriftStartTime >= 0.0)
 	{
-		const FVector Location = GetActorLocation();
+		const float DriftAlpha = FMath::Clamp(float(GetWorld()->GetTimeSeconds() - DriftStartTime) / DriftDuration, 0.f, 1.f);
 
-		ElapsedDriftingTime += DeltaTime;
-		float DriftingPercent = ElapsedDriftingTime / DriftingTime;
-		
-		SetActorLocation(FMath::Lerp(Location, DesiredLocation, DriftingPercent));
+		SetActorLocation(FMath::InterpEaseOut(StartLocation, DesiredLocation, DriftAlpha, 2.f));
 
-		if (DriftingPercent >= 1.f)
+		if (DriftAlpha >= 1.f)
 			bFinishedDrifting = true;
 	}
-	
+
+	// Settled souls cost nothing: they are collected through the pickup subsystem, not their own tick.
+	if (IsSettled() && !IsAwaitingDormancy())
+		SetActorTickEnabled(false);
 }
 
 void ASoul::BeginPlay()
 {
 	Super::BeginPlay();
 
-	FVector LineTraceStart = GetActorLocation();
-	FVector LineTraceEnd = LineTraceStart - FVector(0.f, 0.f, 2000.f);
-
-	TArray<TEnumAsByte<EObjectTypeQuery>> ObjectTypes;
-	ObjectTypes.Add(EObjectTypeQuery::ObjectTypeQuery1);
+	StartLocation = GetActorLocation();
 
-	TArray<AActor*> ActorsToIgnore;
-	ActorsToIgnore.Add(GetOwner());
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SoulGroundTrace));
+	QueryParams.AddIgnoredActor(this);
+	QueryParams.AddIgnoredActor(GetOwner());
 
-	FHitResult HitResult;
+	// Async traces are batched by the engine and resolved next frame, so the soul just hovers where it spawned until then.
+	GroundTraceDelegate.BindUObject(this, &ASoul::OnGroundTraceDone);
 
-	UKismetSystemLibrary::LineTraceSingleForObjects(
-		this, 
-		LineTraceStart, 
-		LineTraceEnd, 
-		ObjectTypes, 
-		false,
-		ActorsToIgnore, 
-		bShowLineTraceDebug ? EDrawDebugTrace::ForDuration : EDrawDebugTrace::None,
-		HitResult, 
-		true
+	GetWorld()->AsyncLineTraceByObjectType(
+		EAsyncTraceType::Single,
+		StartLocation,
+		StartLocation - FVector(0.f, 0.f, 2000.f),
+		FCollisionObjectQueryParams(ECC_WorldStatic),
+		QueryParams,
+		&GroundTraceDelegate
 	);
+}
 
-	DesiredLocation = HitResult.ImpactPoint + FVector(0.f, 0.f, 75.f);
+void ASoul::OnGroundTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	const FHitResult* GroundHit = TraceDatum.OutHits.FindByPredicate([](const FHitResult& Hit) { return Hit.bBlockingHit; });
+
+	// With no ground below it the soul stays where it is.
+	DesiredLocation = GroundHit ? GroundHit->ImpactPoint + FVector(0.f, 0.f, 75.f) : StartLocation;
+	DriftStartTime = GetWorld()->GetTimeSeconds();
+
+	SH_DEBUG_DRAW(SoulTraces, DrawDebugLine(GetWorld(), TraceDatum.Start, GroundHit ? GroundHit->ImpactPoint : TraceDatum.End,
+		GroundHit ? FColor::Green : FColor::Red, false, SoulHunterDebug::DrawDuration));
 }
 
-void ASoul::OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void ASoul::OnCollected(IPickupInterface* PickupInterface)
 {
-	IPickupInterface* PickupInterface = Cast<IPickupInterface>(OtherActor);
-	if (PickupInterface)
-	{
-		PickupInterface->AddSouls(this);
+	SpawnPickupEffect();
+	SpawnPickupSound();
 
-		SpawnPickupEffect();
-		SpawnPickupSound();
+	// Every machine collects it and plays the effects, only the server hands out the souls.
+	if (!HasAuthority())
+		return;
 
-		Destroy();
-	}
+	PickupInterface->AddSouls(this);
+
+	NotifyLooted();
+	Destroy();
 }
@@ -3,15 +3,22 @@
 
 #include "Items/Treasure.h"
 #include "Interfaces/PickupInterface.h"
+#include "Components/SphereComponent.h"
 
-void ATreasure::OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+ATreasure::ATreasure()
 {
-	IPickupInterface* PickupInterface = Cast<IPickupInterface>(OtherActor);
-	if (PickupInterface)
-	{
-		PickupInterface->AddGold(this);
+	SphereCollider->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
+
+void ATreasure::OnCollected(IPickupInterface* PickupInterface)
+{
+	SpawnPickupSound();
+
+	if (!HasAuthority())
+		return;
+
+	PickupInterface->AddGold(this);
 
-		SpawnPickupSound();
-		Destroy();
-	}
+	NotifyLooted();
+	Destroy();
 }
@@ -3,15 +3,25 @@
 
 #include "Items/Weapons/Weapon.h"
 #include "Characters\PlayerCharacter.h"
+#include "Characters/CharacterNames.h"
 #include "Kismet/GameplayStatics.h"
 #include "Components\SphereComponent.h"
 #include "Components\BoxComponent.h"
 #include "Components/SceneComponent.h"
-#include "Kismet/KismetSystemLibrary.h"
+#include "SoulHunterDebug.h"
 #include "Interfaces\HitInterface.h"
+#include "Breakable/BreakableActor.h"
 #include "NiagaraComponent.h"
+#include "SoulHunter.h"
+#include "Diagnostics/CombatTelemetry.h"
+#include "Network/LagCompensationSubsystem.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+
+DECLARE_CYCLE_STAT(TEXT("Weapon Box Trace"), STAT_WeaponBoxTrace, STATGROUP_Game);
 
 AWeapon::AWeapon()
+	: TraceQueryParams(SCENE_QUERY_STAT(WeaponBoxTrace), false)
 {
 	ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
 	ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
@@ -30,6 +40,32 @@ AWeapon::AWeapon()
 	BoxTraceEnd->SetupAttachment(GetRootComponent());
 }
 
+void AWeapon::PostLoad()
+{
+	Super::PostLoad();
+
+#if WITH_EDITORONLY_DATA
+	const AWeapon* Template = Cast<AWeapon>(GetArchetype());
+
+	if (UWeaponArchetype* Migrated = FCombatArchetypeMigration::Migrate(this, GetDeprecatedStats(), Template ? Template->GetDeprecatedStats() : FWeaponStats()))
+		Archetype = Migrated;
+#endif
+}
+
+#if WITH_EDITORONLY_DATA
+
+FWeaponStats AWeapon::GetDeprecatedStats() const
+{
+	// Reach and swing duration were added along with the archetype, so there is nothing older to carry over for them.
+	FWeaponStats Stats;
+	Stats.Damage = Damage_DEPRECATED;
+	Stats.BoxTraceExtent = BoxTraceExtent_DEPRECATED;
+
+	return Stats;
+}
+
+#endif
+
 void AWeapon::BeginPlay()
 {
 	Super::BeginPlay();
@@ -37,15 +73,43 @@ void AWeapon::BeginPlay()
 	WeaponCollisionBox->OnComponentBeginOverlap.AddDynamic(this, &AWeapon::OnBoxOverlap);
 }
 
-void AWeapon::Equip(USceneComponent* InParent, FName InSocketName, AActor* NewOwner, APawn* NewInstigator)
+void AWeapon::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
-	ItemState = EItemState::EIS_Equipped;
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
 
+	DOREPLIFETIME_WITH_PARAMS_FAST(AWeapon, bEquipped, Params);
+}
+
+void AWeapon::Equip(USceneComponent* InParent, FName InSocketName, AActor* NewOwner, APawn* NewInstigator)
+{
 	SetOwner(NewOwner);
 	SetInstigator(NewInstigator);
 
 	AttackMeshToSocket(InParent, InSocketName);
 
+	// A held weapon follows its owner's sockets, so it needs its attachment replicated and can no longer sleep.
+	SetNetDormancy(DORM_Awake);
+	SetReplicateMovement(true);
+
+	bEquipped = true;
+	MARK_PROPERTY_DIRTY_FROM_NAME(AWeapon, bEquipped, this);
+
+	OnRep_Equipped();
+}
+
+void AWeapon::OnRep_Equipped()
+{
+	if (!bEquipped)
+		return;
+
+	ItemState = EItemState::EIS_Equipped;
+
+	// Held weapons neither hover nor settle, so the item tick has nothing left to do.
+	SetActorTickEnabled(false);
+
 	if (EquipSound)
 		UGameplayStatics::PlaySoundAtLocation(GetWorld(), EquipSound, GetActorLocation());
 
@@ -63,9 +127,18 @@ void AWeapon::AttackMeshToSocket(USceneComponent* InParent, const FName& InSocke
 
 void AWeapon::ResetHitIgnoreActors()
 {
-	HitIgnoreActors.Empty();
-	HitIgnoreActors.Add(this);
-	HitIgnoreActors.Add(GetOwner());
+	// Reset keeps the inline storage, so a swing allocates nothing once the weapon has traced a few times.
+	HitIgnoreActors.Reset();
+	TraceQueryParams.ClearIgnoredActors();
+
+	for (const AActor* Actor : { static_cast<const AActor*>(this), GetOwner() })
+	{
+		if (Actor)
+		{
+			HitIgnoreActors.Add(Actor);
+			TraceQueryParams.AddIgnoredActor(Actor);
+		}
+	}
 }
 
 void AWeapon::EnablePhysics()
@@ -77,55 +150,199 @@ void AWeapon::EnablePhysics()
 
 void AWeapon::OnBoxOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
-	if (ActorIsSameType(OtherActor))
+	if (!DetectsHits() || HitIgnoreActors.Contains(OtherActor) || ActorIsSameType(OtherActor))
 		return;
 
 	FHitResult BoxHitResult;
-	BoxTrace(BoxHitResult);
+	BoxTrace(BoxTraceStart->GetComponentLocation(), BoxTraceEnd->GetComponentLocation(), BoxTraceStart->GetComponentQuat(), BoxHitResult);
 
-	if (BoxHitResult.GetActor())
-	{
-		if (ActorIsSameType(BoxHitResult.GetActor()))
-			return;
+	HandleTraceHit(BoxHitResult);
+}
+
+bool AWeapon::DetectsHits() const
+{
+	const APawn* InstigatorPawn = GetInstigator();
+
+	return InstigatorPawn && InstigatorPawn->IsLocallyControlled();
+}
+
+void AWeapon::TraceHitWindow(const FTransform& SocketTransform)
+{
+	// The weapon's root snaps to the socket, so the trace points sit at their relative transforms from it.
+	const FTransform TraceStartTransform = BoxTraceStart->GetRelativeTransform() * SocketTransform;
+
+	FHitResult BoxHitResult;
+	BoxTrace(TraceStartTransform.GetLocation(), SocketTransform.TransformPosition(BoxTraceEnd->GetRelativeLocation()), TraceStartTransform.GetRotation(), BoxHitResult);
+
+	HandleTraceHit(BoxHitResult);
+}
 
-		UGameplayStatics::ApplyDamage(
-			BoxHitResult.GetActor(),
-			Damage,
-			GetInstigator()->GetController(),
-			this,
-			UDamageType::StaticClass()
-		);
+void AWeapon::HandleTraceHit(const FHitResult& BoxHitResult)
+{
+	AActor* HitActor = BoxHitResult.GetActor();
 
-		if (IHitInterface* HitInterface = Cast<IHitInterface>(BoxHitResult.GetActor()))
-			HitInterface->Execute_GetHit(BoxHitResult.GetActor(), BoxHitResult.ImpactPoint, GetOwner());
+	if (HitActor == nullptr || ActorIsSameType(HitActor))
+		return;
 
-		CreateFields(BoxHitResult.ImpactPoint);
+	if (HasAuthority())
+	{
+		ApplyHit(HitActor, BoxHitResult.ImpactPoint);
+		return;
 	}
+
+	APlayerCharacter* PlayerOwner = Cast<APlayerCharacter>(GetOwner());
+
+	if (PlayerOwner == nullptr)
+		return;
+
+	const double ViewTime = ULagCompensationSubsystem::GetClientViewTime(HitActor);
+
+	if (ABaseCharacter* HitCharacter = Cast<ABaseCharacter>(HitActor))
+		HitCharacter->PlayPredictedHitEffects(BoxHitResult.ImpactPoint, PlayerOwner);
+
+	PlayerOwner->Server_ReportWeaponHit(this, HitActor, BoxHitResult.ImpactPoint, ViewTime);
 }
 
-bool AWeapon::ActorIsSameType(AActor* OtherActor)
+#pragma region Hits
+
+void AWeapon::BeginSwing()
 {
-	return GetOwner()->ActorHasTag(FName("Enemy")) && OtherActor->ActorHasTag(FName("Enemy"));
+	SwingStartTime = GetWorld()->GetTimeSeconds();
+	SwingHitActors.Reset();
 }
 
-void AWeapon::BoxTrace(FHitResult& BoxHitResult)
+bool AWeapon::ValidateReportedHit(AActor* HitActor, const FVector& ImpactPoint, double ViewTime) const
 {
-	const FVector Start = BoxTraceStart->GetComponentLocation();
-	const FVector End = BoxTraceEnd->GetComponentLocation();
+	const AActor* WeaponOwner = GetOwner();
+
+	if (HitActor == nullptr || WeaponOwner == nullptr || HitActor == WeaponOwner || HitActor == this)
+		return false;
 
-	UKismetSystemLibrary::BoxTraceSingle(
+	if (WeaponOwner->ActorHasTag(CharacterNames::DeadTag))
+	{
+		UE_LOG(LogSoulHunter, Verbose, TEXT("Rejected hit on %s: %s is dead"), *HitActor->GetName(), *WeaponOwner->GetName());
+		return false;
+	}
+
+	if (SwingStartTime < 0.0 || GetWorld()->GetTimeSeconds() - SwingStartTime > GetStats().MaxSwingDuration)
+	{
+		UE_LOG(LogSoulHunter, Verbose, TEXT("Rejected hit on %s: %s is not swinging"), *HitActor->GetName(), *WeaponOwner->GetName());
+		return false;
+	}
+
+	if (SwingHitActors.Contains(HitActor))
+	{
+		UE_LOG(LogSoulHunter, Verbose, TEXT("Rejected hit on %s: already hit in this swing"), *HitActor->GetName());
+		return false;
+	}
+
+	const ULagCompensationSubsystem* LagCompensation = ULagCompensationSubsystem::Get(this);
+
+	const FVector OwnerLocation = WeaponOwner->GetActorLocation();
+	const FVector TargetLocation = LagCompensation ?
+		LagCompensation->GetRewoundLocation(HitActor, LagCompensation->ClampRewindTime(ViewTime)) :
+		HitActor->GetActorLocation();
+
+	const float Reach = GetStats().MaxReportedHitDistance + HitActor->GetSimpleCollisionRadius();
+
+	if (FVector::DistSquared(OwnerLocation, TargetLocation) > FMath::Square(Reach) ||
+		FVector::DistSquared(OwnerLocation, ImpactPoint) > FMath::Square(Reach))
+	{
+		UE_LOG(LogSoulHunter, Verbose, TEXT("Rejected hit on %s: out of reach"), *HitActor->GetName());
+		return false;
+	}
+
+	return true;
+}
+
+void AWeapon::ApplyHit(AActor* HitActor, const FVector& ImpactPoint)
+{
+	SwingHitActors.Add(HitActor);
+
+	SH_COMBAT_TELEMETRY(Hit, GetOwner(), HitActor, GetStats().Damage);
+
+	UGameplayStatics::ApplyDamage(
+		HitActor,
+		GetStats().Damage,
+		GetInstigator()->GetController(),
 		this,
-		Start,
-		End,
-		BoxTraceExtent,
-		BoxTraceStart->GetComponentRotation(),
-		ETraceTypeQuery::TraceTypeQuery1,
-		false,
-		HitIgnoreActors,
-		bShowBoxTraceDebug ? EDrawDebugTrace::ForDuration : EDrawDebugTrace::None,
-		BoxHitResult,
-		true
+		UDamageType::StaticClass()
 	);
 
-	HitIgnoreActors.AddUnique(BoxHitResult.GetActor());
+	// In a batch the character reacts in EndHitBatch instead, along with everything else the same sweeps hit.
+	ABaseCharacter* BatchedCharacter = bBatchingHits ? Cast<ABaseCharacter>(HitActor) : nullptr;
+
+	if (BatchedCharacter)
+		BatchedCharacter->SetHitReactDeferred(true);
+
+	if (IHitInterface* HitInterface = Cast<IHitInterface>(HitActor))
+		HitInterface->Execute_GetHit(HitActor, ImpactPoint, GetOwner());
+
+	if (BatchedCharacter)
+	{
+		BatchedCharacter->SetHitReactDeferred(false);
+		BatchedHitCharacters.Add(BatchedCharacter);
+	}
+
+	Multicast_CreateFields(ImpactPoint, HitActor);
+}
+
+void AWeapon::BeginHitBatch()
+{
+	bBatchingHits = true;
+}
+
+void AWeapon::EndHitBatch()
+{
+	bBatchingHits = false;
+
+	if (BatchedHitCharacters.Num() > 0 && GetOwner())
+		ABaseCharacter::PlayCrowdHitReactions(BatchedHitCharacters, GetOwner()->GetActorLocation());
+
+	BatchedHitCharacters.Reset();
+}
+
+void AWeapon::Multicast_CreateFields_Implementation(FVector_NetQuantize FieldLocation, AActor* HitActor)
+{
+	// A breakable may still be a proxy here if this arrived before its replicated break; the fields need the real collection.
+	if (ABreakableActor* Breakable = Cast<ABreakableActor>(HitActor))
+		Breakable->SwapInGeometryCollection();
+
+	CreateFields(FieldLocation);
+}
+
+#pragma endregion
+
+bool AWeapon::ActorIsSameType(AActor* OtherActor)
+{
+	return GetOwner()->ActorHasTag(CharacterNames::EnemyTag) && OtherActor->ActorHasTag(CharacterNames::EnemyTag);
+}
+
+void AWeapon::BoxTrace(const FVector& Start, const FVector& End, const FQuat& Rotation, FHitResult& BoxHitResult)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WeaponBoxTrace);
+
+	const FVector Extent = GetStats().BoxTraceExtent;
+
+	GetWorld()->SweepSingleByChannel(BoxHitResult, Start, End, Rotation, ECC_Visibility, FCollisionShape::MakeBox(Extent), TraceQueryParams);
+
+	SH_DEBUG_DRAW(WeaponTraces,
+		DrawDebugBox(GetWorld(), Start, Extent, Rotation, FColor::Red, false, SoulHunterDebug::DrawDuration);
+		DrawDebugBox(GetWorld(), End, Extent, Rotation, FColor::Red, false, SoulHunterDebug::DrawDuration);
+
+		if (BoxHitResult.bBlockingHit)
+			DrawDebugPoint(GetWorld(), BoxHitResult.ImpactPoint, 16.f, FColor::Green, false, SoulHunterDebug::DrawDuration));
+
+	const AActor* HitActor = BoxHitResult.GetActor();
+	bool bAlreadyIgnored = false;
+
+	SH_COMBAT_TELEMETRY(Trace, GetOwner(), HitActor);
+
+	if (HitActor)
+	{
+		HitIgnoreActors.Add(HitActor, &bAlreadyIgnored);
+
+		if (!bAlreadyIgnored)
+			TraceQueryParams.AddIgnoredActor(HitActor);
+	}
 }
@@ -0,0 +1,278 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Loading/AssetPreloadSubsystem.h"
+#include "Characters/BaseCharacter.h"
+#include "SoulHunter.h"
+#include "Engine/Engine.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+
+namespace AssetPreload
+{
+	TAutoConsoleVariable<bool> CVarLogSyncLoads(
+		TEXT("sh.Preload.LogSyncLoads"),
+		!UE_BUILD_SHIPPING,
+		TEXT("Logs a warning for every package loaded synchronously while a game world is playing."));
+}
+
+#pragma region Main
+
+void UAssetPreloadSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SyncLoadHandle = FCoreDelegates::OnSyncLoadPackage.AddUObject(this, &UAssetPreloadSubsystem::OnSyncLoadPackage);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UAssetPreloadSubsystem::OnLevelRemovedFromWorld);
+	WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddUObject(this, &UAssetPreloadSubsystem::OnWorldCleanup);
+}
+
+void UAssetPreloadSubsystem::Deinitialize()
+{
+	FCoreDelegates::OnSyncLoadPackage.Remove(SyncLoadHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+	FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+
+	for (TPair<FName, FPreloadBundle>& BundlePair : Bundles)
+	{
+		if (BundlePair.Value.Handle.IsValid())
+			BundlePair.Value.Handle->CancelHandle();
+	}
+
+	Bundles.Empty();
+
+	Super::Deinitialize();
+}
+
+UAssetPreloadSubsystem* UAssetPreloadSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+
+	return GameInstance ? GameInstance->GetSubsystem<UAssetPreloadSubsystem>() : nullptr;
+}
+
+void UAssetPreloadSubsystem::PreloadCharacterAssets(TSubclassOf<ABaseCharacter> CharacterClass, const UObject* Requester, FStreamableDelegate OnLoaded)
+{
+	if (CharacterClass == nullptr)
+	{
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	const FName BundleName = CharacterClass->GetFName();
+
+	// The asset list only depends on the class defaults, so it is gathered once per class.
+	if (Bundles.Contains(BundleName))
+	{
+		PreloadBundle(BundleName, TArray<FSoftObjectPath>(), Requester, MoveTemp(OnLoaded));
+		return;
+	}
+
+	TArray<FSoftObjectPath> Assets;
+	CharacterClass->GetDefaultObject<ABaseCharacter>()->GatherPreloadAssets(Assets);
+
+	PreloadBundle(BundleName, MoveTemp(Assets), Requester, MoveTemp(OnLoaded));
+}
+
+void UAssetPreloadSubsystem::PreloadBundle(FName BundleName, TArray<FSoftObjectPath>&& Assets, const UObject* Requester, FStreamableDelegate OnLoaded)
+{
+	ULevel* RequesterLevel = GetRequesterLevel(Requester);
+
+	if (FPreloadBundle* ExistingBundle = Bundles.Find(BundleName))
+	{
+		if (RequesterLevel)
+			ExistingBundle->Levels.AddUnique(RequesterLevel);
+
+		if (ExistingBundle->Handle.IsValid() && !ExistingBundle->Handle->HasLoadCompleted())
+			ExistingBundle->Waiters.Add(MoveTemp(OnLoaded));
+		else
+			OnLoaded.ExecuteIfBound();
+
+		return;
+	}
+
+	FPreloadBundle& Bundle = Bundles.Add(BundleName);
+	Bundle.NumAssets = Assets.Num();
+
+	if (RequesterLevel)
+		Bundle.Levels.Add(RequesterLevel);
+
+	Bundle.RequestTime = FPlatformTime::Seconds();
+
+	if (Assets.Num() == 0)
+	{
+		Bundle.LoadMilliseconds = 0.0;
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	Bundle.Waiters.Add(MoveTemp(OnLoaded));
+	Bundle.Handle = StreamableManager.RequestAsyncLoad(
+		MoveTemp(Assets),
+		FStreamableDelegate::CreateUObject(this, &UAssetPreloadSubsystem::OnBundleLoaded, BundleName),
+		FStreamableManager::AsyncLoadHighPriority,
+		true,
+		false,
+		BundleName.ToString());
+}
+
+void UAssetPreloadSubsystem::ReleaseBundle(FName BundleName)
+{
+	FPreloadBundle Bundle;
+
+	if (!Bundles.RemoveAndCopyValue(BundleName, Bundle))
+		return;
+
+	if (Bundle.Handle.IsValid())
+		Bundle.Handle->ReleaseHandle();
+}
+
+bool UAssetPreloadSubsystem::IsBundleLoaded(FName BundleName) const
+{
+	const FPreloadBundle* Bundle = Bundles.Find(BundleName);
+
+	return Bundle && (!Bundle->Handle.IsValid() || Bundle->Handle->HasLoadCompleted());
+}
+
+void UAssetPreloadSubsystem::LogReport() const
+{
+	UE_LOG(LogSoulHunter, Display, TEXT("Preload bundles: %d"), Bundles.Num());
+
+	for (const TPair<FName, FPreloadBundle>& BundlePair : Bundles)
+	{
+		const FPreloadBundle& Bundle = BundlePair.Value;
+
+		if (Bundle.LoadMilliseconds >= 0.0)
+			UE_LOG(LogSoulHunter, Display, TEXT("  %-40s %3d assets  %2d levels  loaded in %.2f ms"), *BundlePair.Key.ToString(), Bundle.NumAssets, Bundle.Levels.Num(), Bundle.LoadMilliseconds);
+		else
+			UE_LOG(LogSoulHunter, Display, TEXT("  %-40s %3d assets  %2d levels  loading"), *BundlePair.Key.ToString(), Bundle.NumAssets, Bundle.Levels.Num());
+	}
+
+	UE_LOG(LogSoulHunter, Display, TEXT("Soft references resolved synchronously: %d"), ResolveMisses.Num());
+
+	for (const TPair<FString, int32>& MissPair : ResolveMisses)
+		UE_LOG(LogSoulHunter, Display, TEXT("  %5dx %s"), MissPair.Value, *MissPair.Key);
+
+	UE_LOG(LogSoulHunter, Display, TEXT("Packages loaded synchronously during play: %d"), SyncLoadedPackages.Num());
+
+	for (const TPair<FString, int32>& PackagePair : SyncLoadedPackages)
+		UE_LOG(LogSoulHunter, Display, TEXT("  %5dx %s"), PackagePair.Value, *PackagePair.Key);
+}
+
+#pragma endregion
+
+#pragma region Bundles
+
+void UAssetPreloadSubsystem::OnBundleLoaded(FName BundleName)
+{
+	FPreloadBundle* Bundle = Bundles.Find(BundleName);
+
+	if (Bundle == nullptr)
+		return;
+
+	Bundle->LoadMilliseconds = (FPlatformTime::Seconds() - Bundle->RequestTime) * 1000.0;
+
+	// Waiters may request more bundles, which can reallocate the map, so they are moved out first.
+	TArray<FStreamableDelegate> Waiters = MoveTemp(Bundle->Waiters);
+
+	for (FStreamableDelegate& Waiter : Waiters)
+		Waiter.ExecuteIfBound();
+}
+
+ULevel* UAssetPreloadSubsystem::GetRequesterLevel(const UObject* Requester)
+{
+	if (const AActor* Actor = Cast<AActor>(Requester))
+		return Actor->GetLevel();
+
+	if (ULevel* Level = Requester ? Requester->GetTypedOuter<ULevel>() : nullptr)
+		return Level;
+
+	const UWorld* World = Requester ? Requester->GetWorld() : nullptr;
+
+	return World ? World->PersistentLevel : nullptr;
+}
+
+void UAssetPreloadSubsystem::ReleaseLevels(TFunctionRef<bool(const ULevel*)> Predicate)
+{
+	TArray<FName, TInlineAllocator<8>> Unused;
+
+	for (TPair<FName, FPreloadBundle>& BundlePair : Bundles)
+	{
+		const int32 NumRemoved = BundlePair.Value.Levels.RemoveAll([&Predicate](const TWeakObjectPtr<ULevel>& Level)
+		{
+			return !Level.IsValid() || Predicate(Level.Get());
+		});
+
+		// Bundles requested without a level are left for their owner to release.
+		if (NumRemoved > 0 && BundlePair.Value.Levels.Num() == 0)
+			Unused.Add(BundlePair.Key);
+	}
+
+	for (const FName BundleName : Unused)
+	{
+		UE_LOG(LogSoulHunter, Verbose, TEXT("Preload: releasing %s, no loaded level uses it"), *BundleName.ToString());
+		ReleaseBundle(BundleName);
+	}
+}
+
+void UAssetPreloadSubsystem::OnLevelRemovedFromWorld(ULevel* Level, UWorld* World)
+{
+	// A null level means every level of the world is going.
+	if (Level)
+		ReleaseLevels([Level](const ULevel* BundleLevel) { return BundleLevel == Level; });
+	else if (World)
+		ReleaseLevels([World](const ULevel* BundleLevel) { return BundleLevel->GetWorld() == World; });
+}
+
+void UAssetPreloadSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+	ReleaseLevels([World](const ULevel* BundleLevel) { return BundleLevel->GetWorld() == World; });
+}
+
+#pragma endregion
+
+#pragma region Sync Load Tracking
+
+void UAssetPreloadSubsystem::ReportResolveMiss(const FSoftObjectPath& AssetPath, const UObject* Requester)
+{
+	const FString AssetName = AssetPath.ToString();
+
+	UE_LOG(LogSoulHunter, Warning, TEXT("Preload: %s was not resident when %s needed it, loading synchronously"),
+		*AssetName, *GetNameSafe(Requester));
+
+	if (UAssetPreloadSubsystem* PreloadSubsystem = Get(Requester))
+		++PreloadSubsystem->ResolveMisses.FindOrAdd(AssetName);
+}
+
+void UAssetPreloadSubsystem::OnSyncLoadPackage(const FString& PackageName)
+{
+	const UWorld* World = GetGameInstance()->GetWorld();
+
+	if (World == nullptr || !World->HasBegunPlay() || !IsInGameThread())
+		return;
+
+	++SyncLoadedPackages.FindOrAdd(PackageName);
+
+	if (AssetPreload::CVarLogSyncLoads.GetValueOnGameThread())
+		UE_LOG(LogSoulHunter, Warning, TEXT("Preload: synchronous load of %s during play"), *PackageName);
+}
+
+#pragma endregion
+
+#pragma region Console Commands
+
+namespace AssetPreload
+{
+	static FAutoConsoleCommandWithWorld ReportCommand(
+		TEXT("sh.Preload.Report"),
+		TEXT("Lists preload bundles with their load times and every synchronous load seen during play."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (const UAssetPreloadSubsystem* PreloadSubsystem = UAssetPreloadSubsystem::Get(World))
+				PreloadSubsystem->LogReport();
+		}));
+}
+
+#pragma endregion
@@ -0,0 +1,317 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Network/LagCompensationSubsystem.h"
+#include "Characters/BaseCharacter.h"
+#include "SoulHunter.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/GameStateBase.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Lag Compensation Record"), STAT_LagCompensationRecord, STATGROUP_Game);
+
+namespace LagCompensation
+{
+	TAutoConsoleVariable<float> CVarSampleRate(
+		TEXT("sh.LagComp.SampleRate"),
+		60.f,
+		TEXT("Capsule positions recorded per second, at most. Together with MaxRewindMs it sizes each character's history."));
+
+	TAutoConsoleVariable<float> CVarMaxRewindMs(
+		TEXT("sh.LagComp.MaxRewindMs"),
+		400.f,
+		TEXT("Furthest back in time a reported hit may be validated. Histories are sized for it when a character registers."));
+
+	double GetSampleInterval()
+	{
+		return 1.0 / FMath::Max(CVarSampleRate.GetValueOnGameThread(), 1.f);
+	}
+
+	int32 GetHistoryCapacity()
+	{
+		return FRewindHistory::GetCapacityFor(CVarMaxRewindMs.GetValueOnGameThread() / 1000.0, GetSampleInterval());
+	}
+}
+
+#pragma region Rewind History
+
+int32 FRewindHistory::GetCapacityFor(double MaxRewindSeconds, double SampleInterval)
+{
+	// Frames can be up to a frame late on both ends of the window, so the ring holds two more than the span needs.
+	return FMath::CeilToInt32(FMath::Max(MaxRewindSeconds, 0.0) / FMath::Max(SampleInterval, UE_SMALL_NUMBER)) + 2;
+}
+
+void FRewindHistory::Init(int32 Capacity)
+{
+	Frames.SetNumZeroed(FMath::Max(Capacity, 2));
+	Head = 0;
+	NumFrames = 0;
+}
+
+void FRewindHistory::Record(double Time, const FVector& Location)
+{
+	FFrame& Frame = Frames[Head];
+	Frame.Time = Time;
+	Frame.Location = FVector3f(Location);
+
+	Head = (Head + 1) % Frames.Num();
+	NumFrames = FMath::Min(NumFrames + 1, Frames.Num());
+}
+
+bool FRewindHistory::Sample(double Time, FVector& OutLocation) const
+{
+	if (NumFrames == 0)
+		return false;
+
+	const FFrame& Newest = GetFrame(0);
+	const FFrame& Oldest = GetFrame(NumFrames - 1);
+
+	if (Time >= Newest.Time)
+	{
+		OutLocation = FVector(Newest.Location);
+		return true;
+	}
+
+	if (Time <= Oldest.Time)
+	{
+		OutLocation = FVector(Oldest.Location);
+		return true;
+	}
+
+	// Binary search over age: frame times decrease as age grows. Finds the youngest frame at or before Time.
+	int32 Low = 0;
+	int32 High = NumFrames - 1;
+
+	while (Low < High)
+	{
+		const int32 Middle = (Low + High) / 2;
+
+		if (GetFrame(Middle).Time <= Time)
+			High = Middle;
+		else
+			Low = Middle + 1;
+	}
+
+	const FFrame& Before = GetFrame(Low);
+	const FFrame& After = GetFrame(Low - 1);
+
+	const double Span = After.Time - Before.Time;
+	const float Alpha = Span > UE_SMALL_NUMBER ? static_cast<float>((Time - Before.Time) / Span) : 0.f;
+
+	OutLocation = FVector(FMath::Lerp(Before.Location, After.Location, Alpha));
+	return true;
+}
+
+#pragma endregion
+
+#pragma region Main
+
+ULagCompensationSubsystem* ULagCompensationSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+
+	return World ? World->GetSubsystem<ULagCompensationSubsystem>() : nullptr;
+}
+
+bool ULagCompensationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId ULagCompensationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULagCompensationSubsystem, STATGROUP_Tickables);
+}
+
+void ULagCompensationSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_LagCompensationRecord);
+
+	// Tickable objects run after every tick group, so these are the positions clients will be sent this frame.
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// Sampling at a fixed rate keeps the history spanning MaxRewindMs however fast the server ticks.
+	if (LastSampleTime >= 0.0 && Now - LastSampleTime < LagCompensation::GetSampleInterval())
+		return;
+
+	LastSampleTime = Now;
+
+	for (int32 Index = Histories.Num() - 1; Index >= 0; --Index)
+	{
+		const ABaseCharacter* Character = Histories[Index].Character.Get();
+
+		if (Character == nullptr)
+		{
+			Histories.RemoveAtSwap(Index);
+			continue;
+		}
+
+		Histories[Index].History.Record(Now, Character->GetActorLocation());
+	}
+}
+
+void ULagCompensationSubsystem::Register(ABaseCharacter* Character)
+{
+	// Nobody reports hits in a standalone game and clients never validate them.
+	if (Character == nullptr || GetWorld()->GetNetMode() == NM_Standalone || GetWorld()->GetNetMode() == NM_Client)
+		return;
+
+	if (Histories.ContainsByPredicate([Character](const FCharacterHistory& Entry) { return Entry.Character == Character; }))
+		return;
+
+	FCharacterHistory& Entry = Histories.AddDefaulted_GetRef();
+	Entry.Character = Character;
+	Entry.History.Init(LagCompensation::GetHistoryCapacity());
+}
+
+void ULagCompensationSubsystem::Unregister(ABaseCharacter* Character)
+{
+	Histories.RemoveAllSwap([Character](const FCharacterHistory& Entry) { return Entry.Character == Character; });
+}
+
+double ULagCompensationSubsystem::ClampRewindTime(double ViewTime) const
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	const double MaxRewind = LagCompensation::CVarMaxRewindMs.GetValueOnGameThread() / 1000.0;
+
+	return FMath::Clamp(ViewTime, Now - MaxRewind, Now);
+}
+
+double ULagCompensationSubsystem::GetClientViewTime(const AActor* Actor)
+{
+	const UWorld* World = Actor ? Actor->GetWorld() : nullptr;
+
+	if (World == nullptr)
+		return 0.0;
+
+	const AGameStateBase* GameState = World->GetGameState();
+	const double ServerTime = GameState ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+
+	// Simulated characters are drawn smoothed towards their latest replicated position, so they trail it by the smoothing time.
+	const ACharacter* Character = Cast<ACharacter>(Actor);
+	const UCharacterMovementComponent* Movement = Character ? Character->GetCharacterMovement() : nullptr;
+
+	const bool bSmoothed = Movement && Character->GetLocalRole() == ROLE_SimulatedProxy
+		&& Movement->NetworkSmoothingMode != ENetworkSmoothingMode::Disabled;
+
+	return ServerTime - (bSmoothed ? Movement->NetworkSimulatedSmoothLocationTime : 0.f);
+}
+
+FVector ULagCompensationSubsystem::GetRewoundLocation(const AActor* Actor, double Time) const
+{
+	if (Actor == nullptr)
+		return FVector::ZeroVector;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	FVector Location = Actor->GetActorLocation();
+
+	for (const FCharacterHistory& Entry : Histories)
+	{
+		if (Entry.Character.Get() == Actor)
+		{
+			Entry.History.Sample(Time, Location);
+			break;
+		}
+	}
+
+	++NumQueries;
+	QuerySeconds += FPlatformTime::Seconds() - StartTime;
+
+	return Location;
+}
+
+void ULagCompensationSubsystem::LogReport() const
+{
+	SIZE_T HistoryBytes = 0;
+
+	for (const FCharacterHistory& Entry : Histories)
+		HistoryBytes += Entry.History.GetAllocatedSize();
+
+	UE_LOG(LogSoulHunter, Display, TEXT("Lag compensation: %d characters, %llu bytes of history (%d frames each at %.0f Hz, max rewind %.0f ms)"),
+		Histories.Num(),
+		static_cast<uint64>(HistoryBytes),
+		LagCompensation::GetHistoryCapacity(),
+		LagCompensation::CVarSampleRate.GetValueOnGameThread(),
+		LagCompensation::CVarMaxRewindMs.GetValueOnGameThread());
+
+	UE_LOG(LogSoulHunter, Display, TEXT("  %lld rewind queries, %.3f us average"),
+		NumQueries,
+		NumQueries > 0 ? QuerySeconds * 1000000.0 / NumQueries : 0.0);
+}
+
+#pragma endregion
+
+#pragma region Console Commands
+
+namespace LagCompensation
+{
+	static FAutoConsoleCommandWithWorld ReportCommand(
+		TEXT("sh.LagComp.Report"),
+		TEXT("Logs the number of recorded characters, their history memory and the average rewind query cost."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (const ULagCompensationSubsystem* LagCompensationSubsystem = ULagCompensationSubsystem::Get(World))
+				LagCompensationSubsystem->LogReport();
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("sh.LagComp.Benchmark"),
+		TEXT("Times rewind queries against synthetic histories: sh.LagComp.Benchmark [Characters] [Queries]."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			const int32 NumCharacters = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 256;
+			const int32 NumQueries = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 100000;
+			const int32 Capacity = GetHistoryCapacity();
+			const double FrameTime = GetSampleInterval();
+
+			TArray<FRewindHistory> Histories;
+			Histories.SetNum(NumCharacters);
+
+			FRandomStream Random(NumCharacters);
+
+			for (FRewindHistory& History : Histories)
+			{
+				History.Init(Capacity);
+
+				FVector Location(Random.FRandRange(-10000.f, 10000.f), Random.FRandRange(-10000.f, 10000.f), 0.f);
+
+				// Record more frames than fit so the ring has wrapped, like it would in a running game.
+				for (int32 Frame = 0; Frame < Capacity * 2; ++Frame)
+				{
+					Location += FVector(Random.FRandRange(-20.f, 20.f), Random.FRandRange(-20.f, 20.f), 0.f);
+					History.Record(Frame * FrameTime, Location);
+				}
+			}
+
+			const double Newest = (Capacity * 2 - 1) * FrameTime;
+			const double Oldest = Newest - (Capacity - 1) * FrameTime;
+
+			TArray<double> QueryTimes;
+			QueryTimes.SetNumUninitialized(NumQueries);
+
+			for (double& QueryTime : QueryTimes)
+				QueryTime = Random.FRandRange(Oldest, Newest);
+
+			FVector Checksum = FVector::ZeroVector;
+			const double StartTime = FPlatformTime::Seconds();
+
+			for (int32 Query = 0; Query < NumQueries; ++Query)
+			{
+				FVector Location;
+				Histories[Query % NumCharacters].Sample(QueryTimes[Query], Location);
+				Checksum += Location;
+			}
+
+			const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+
+			UE_LOG(LogSoulHunter, Display, TEXT("Lag compensation benchmark: %d characters x %d frames, %d bytes per character"),
+				NumCharacters, Capacity, static_cast<int32>(Histories[0].GetAllocatedSize()));
+
+			UE_LOG(LogSoulHunter, Display, TEXT("  %d queries in %.3f ms, %.1f ns per query (checksum %.1f)"),
+				NumQueries, ElapsedSeconds * 1000.0, ElapsedSeconds * 1000000000.0 / NumQueries, Checksum.Size());
+		}));
+}
+
+#pragma endregion
@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Network/NetworkStats.h"
+#include "Network/SoulHunterReplicationGraph.h"
+#include "SoulHunter.h"
+#include "Engine/Engine.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
+#include "Containers/Ticker.h"
+
+int32 FNetworkStats::AcceptedHits = 0;
+int32 FNetworkStats::RejectedHits = 0;
+int32 FNetworkStats::PositionCorrections = 0;
+int32 FNetworkStats::StaminaCorrections = 0;
+
+namespace NetworkStats
+{
+	static FTSTicker::FDelegateHandle LogTickerHandle;
+
+	static bool LogAllServerWorlds(float DeltaTime)
+	{
+		if (GEngine == nullptr)
+			return true;
+
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			UWorld* World = Context.World();
+
+			if (World && World->IsGameWorld() && World->GetNetMode() != NM_Client && World->GetNetMode() != NM_Standalone)
+				FNetworkStats::LogConnectionStats(World);
+		}
+
+		return true;
+	}
+
+	static void OnStatsIntervalChanged(IConsoleVariable* Variable)
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(LogTickerHandle);
+		LogTickerHandle.Reset();
+
+		const float Interval = Variable->GetFloat();
+
+		if (Interval > 0.f)
+			LogTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&LogAllServerWorlds), Interval);
+	}
+
+	TAutoConsoleVariable<float> CVarStatsInterval(
+		TEXT("sh.Net.StatsInterval"),
+		0.f,
+		TEXT("Seconds between sh.Net.Stats reports logged by a server. 0 disables the periodic report."),
+		FConsoleVariableDelegate::CreateStatic(&OnStatsIntervalChanged));
+}
+
+void FNetworkStats::RecordReportedHit(bool bAccepted)
+{
+	if (bAccepted)
+		++AcceptedHits;
+	else
+		++RejectedHits;
+}
+
+void FNetworkStats::RecordMoveCorrection(bool bStaminaOnly)
+{
+	if (bStaminaOnly)
+		++StaminaCorrections;
+	else
+		++PositionCorrections;
+}
+
+void FNetworkStats::LogConnectionStats(UWorld* World)
+{
+	const UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+
+	if (NetDriver == nullptr || !NetDriver->IsServer())
+	{
+		UE_LOG(LogSoulHunter, Display, TEXT("Net stats: %s is not running a server"), *GetNameSafe(World));
+		return;
+	}
+
+	UE_LOG(LogSoulHunter, Display, TEXT("Net stats: %d clients, %.1f KB/s out, %.1f KB/s in, reported hits %d accepted / %d rejected"),
+		NetDriver->ClientConnections.Num(),
+		NetDriver->OutBytesPerSecond / 1024.f,
+		NetDriver->InBytesPerSecond / 1024.f,
+		AcceptedHits,
+		RejectedHits);
+
+	UE_LOG(LogSoulHunter, Display, TEXT("  move corrections: %d position, %d stamina"), PositionCorrections, StaminaCorrections);
+
+	for (const UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		if (Connection == nullptr)
+			continue;
+
+		const APlayerController* PlayerController = Connection->PlayerController;
+		const APlayerState* PlayerState = PlayerController ? PlayerController->PlayerState.Get() : nullptr;
+		const FString ClientName = PlayerState ? PlayerState->GetPlayerName() : Connection->LowLevelGetRemoteAddress(true);
+
+		UE_LOG(LogSoulHunter, Display, TEXT("  %-24s out %7.1f KB/s  in %6.1f KB/s  lag %5.0f ms  lost out/in %d/%d per s  channels %d"),
+			*ClientName,
+			Connection->OutBytesPerSecond / 1024.f,
+			Connection->InBytesPerSecond / 1024.f,
+			Connection->AvgLag * 1000.0,
+			Connection->OutPacketsLost,
+			Connection->InPacketsLost,
+			Connection->OpenChannels.Num());
+	}
+
+	if (const USoulHunterReplicationGraph* ReplicationGraph = Cast<USoulHunterReplicationGraph>(NetDriver->GetReplicationDriver()))
+		ReplicationGraph->LogStats();
+}
+
+namespace NetworkStats
+{
+	static FAutoConsoleCommandWithWorld StatsCommand(
+		TEXT("sh.Net.Stats"),
+		TEXT("Logs bandwidth, lag and packet loss for every client connection, plus accepted and rejected weapon hit reports and move corrections."),
+		FConsoleCommandWithWorldDelegate::CreateStatic(&FNetworkStats::LogConnectionStats));
+}
@@ -0,0 +1,324 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Network/SoulHunterReplicationGraph.h"
+#include "SoulHunter.h"
+#include "Breakable/BreakableActor.h"
+#include "Characters/PlayerCharacter.h"
+#include "Enemy/Enemy.h"
+#include "Items/Item.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+namespace SoulHunterRepGraph
+{
+	const TCHAR* MappingNames[] = { TEXT("NotRouted"), TEXT("AlwaysRelevant"), TEXT("Static"), TEXT("Dynamic"), TEXT("Dormancy") };
+	static_assert(UE_ARRAY_COUNT(MappingNames) == static_cast<int32>(ESoulHunterRepNodeMapping::Count), "Missing mapping name");
+
+	bool IsSpatialized(ESoulHunterRepNodeMapping Mapping)
+	{
+		return Mapping >= ESoulHunterRepNodeMapping::Spatialize_Static;
+	}
+
+	float Percentile(const TArray<float>& SortedSamples, float Fraction)
+	{
+		if (SortedSamples.Num() == 0)
+			return 0.f;
+
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Fraction * SortedSamples.Num()) - 1, 0, SortedSamples.Num() - 1);
+
+		return SortedSamples[Index];
+	}
+
+	USoulHunterReplicationGraph* GetGraph(UWorld* World)
+	{
+		UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+
+		return NetDriver ? Cast<USoulHunterReplicationGraph>(NetDriver->GetReplicationDriver()) : nullptr;
+	}
+}
+
+#pragma region Main
+
+void USoulHunterReplicationGraph::ResetGameWorldState()
+{
+	Super::ResetGameWorldState();
+
+	ResetStats();
+}
+
+void USoulHunterReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	ClassRepNodePolicies.Set(APlayerController::StaticClass(), ESoulHunterRepNodeMapping::NotRouted);
+	ClassRepNodePolicies.Set(APlayerState::StaticClass(), ESoulHunterRepNodeMapping::RelevantAllConnections);
+	ClassRepNodePolicies.Set(APlayerCharacter::StaticClass(), ESoulHunterRepNodeMapping::Spatialize_Dynamic);
+	ClassRepNodePolicies.Set(AEnemy::StaticClass(), ESoulHunterRepNodeMapping::Spatialize_Dynamic);
+	ClassRepNodePolicies.Set(AItem::StaticClass(), ESoulHunterRepNodeMapping::Spatialize_Dormancy);
+	ClassRepNodePolicies.Set(ABreakableActor::StaticClass(), ESoulHunterRepNodeMapping::Spatialize_Dormancy);
+
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		UClass* Class = *It;
+		const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject(false));
+
+		if (ActorCDO == nullptr || !ActorCDO->GetIsReplicated())
+			continue;
+
+		if (Class->HasAnyClassFlags(CLASS_Abstract | CLASS_Deprecated | CLASS_NewerVersionExists))
+			continue;
+
+		// Blueprint compilation leftovers never spawn.
+		if (Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_")))
+			continue;
+
+		const ESoulHunterRepNodeMapping Mapping = GetMappingPolicy(Class);
+
+		if (ClassRepNodePolicies.Get(Class) == nullptr)
+			ClassRepNodePolicies.Set(Class, Mapping);
+
+		FClassReplicationInfo ClassInfo;
+		InitClassReplicationInfo(ClassInfo, Class, SoulHunterRepGraph::IsSpatialized(Mapping));
+		GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+	}
+}
+
+void USoulHunterReplicationGraph::InitGlobalGraphNodes()
+{
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = GridCellSize;
+	GridNode->SpatialBias = FVector2D(SpatialBiasX, SpatialBiasY);
+
+	if (bDisableSpatialRebuilding)
+		GridNode->AddToClassRebuildDenyList(AActor::StaticClass());
+
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void USoulHunterReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	// Gathers the connection's own player controller and view target every frame.
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* ConnectionNode = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+	AddConnectionGraphNode(ConnectionNode, RepGraphConnection);
+}
+
+void USoulHunterReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	const ESoulHunterRepNodeMapping Mapping = GetMappingPolicy(ActorInfo.Class);
+
+	switch (Mapping)
+	{
+	case ESoulHunterRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+
+	case ESoulHunterRepNodeMapping::Spatialize_Static:
+		GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+		break;
+
+	case ESoulHunterRepNodeMapping::Spatialize_Dynamic:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+
+	case ESoulHunterRepNodeMapping::Spatialize_Dormancy:
+		GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+		break;
+
+	default:
+		break;
+	}
+
+	++NumRoutedActors[static_cast<int32>(Mapping)];
+}
+
+void USoulHunterReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	const ESoulHunterRepNodeMapping Mapping = GetMappingPolicy(ActorInfo.Class);
+
+	switch (Mapping)
+	{
+	case ESoulHunterRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+
+	case ESoulHunterRepNodeMapping::Spatialize_Static:
+		GridNode->RemoveActor_Static(ActorInfo);
+		break;
+
+	case ESoulHunterRepNodeMapping::Spatialize_Dynamic:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+
+	case ESoulHunterRepNodeMapping::Spatialize_Dormancy:
+		GridNode->RemoveActor_Dormancy(ActorInfo);
+		break;
+
+	default:
+		break;
+	}
+
+	--NumRoutedActors[static_cast<int32>(Mapping)];
+}
+
+int32 USoulHunterReplicationGraph::ServerReplicateActors(float DeltaSeconds)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	const int32 NumReplicated = Super::ServerReplicateActors(DeltaSeconds);
+
+	const float FrameMilliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	if (FrameCostSamples.Num() < MaxFrameSamples)
+		FrameCostSamples.Add(FrameMilliseconds);
+	else
+		FrameCostSamples[NextFrameSampleIndex] = FrameMilliseconds;
+
+	NextFrameSampleIndex = (NextFrameSampleIndex + 1) % MaxFrameSamples;
+
+	return NumReplicated;
+}
+
+void USoulHunterReplicationGraph::LogStats() const
+{
+	TArray<float> Samples = FrameCostSamples;
+	Samples.Sort();
+
+	UE_LOG(LogSoulHunter, Display, TEXT("Replication graph: %d connections, grid cell %.0f"), Connections.Num(), GridCellSize);
+
+	for (int32 MappingIndex = 0; MappingIndex < static_cast<int32>(ESoulHunterRepNodeMapping::Count); ++MappingIndex)
+		UE_LOG(LogSoulHunter, Display, TEXT("  %-16s %6d actors"), SoulHunterRepGraph::MappingNames[MappingIndex], NumRoutedActors[MappingIndex]);
+
+	UE_LOG(LogSoulHunter, Display, TEXT("  ServerReplicateActors n=%4d  p50 %6.3f  p90 %6.3f  p99 %6.3f  max %6.3f ms"),
+		Samples.Num(),
+		SoulHunterRepGraph::Percentile(Samples, .5f),
+		SoulHunterRepGraph::Percentile(Samples, .9f),
+		SoulHunterRepGraph::Percentile(Samples, .99f),
+		Samples.Num() > 0 ? Samples.Last() : 0.f);
+}
+
+void USoulHunterReplicationGraph::ResetStats()
+{
+	FrameCostSamples.Reset();
+	NextFrameSampleIndex = 0;
+}
+
+#pragma endregion
+
+#pragma region Routing
+
+ESoulHunterRepNodeMapping USoulHunterReplicationGraph::GetMappingPolicy(UClass* Class) const
+{
+	// Walks up the class hierarchy, so blueprint subclasses loaded after startup still find their native policy.
+	if (const ESoulHunterRepNodeMapping* Mapping = ClassRepNodePolicies.Get(Class))
+		return *Mapping;
+
+	return GetDefaultMappingPolicy(Class);
+}
+
+ESoulHunterRepNodeMapping USoulHunterReplicationGraph::GetDefaultMappingPolicy(UClass* Class) const
+{
+	const AActor* ActorCDO = Class ? Cast<AActor>(Class->GetDefaultObject()) : nullptr;
+
+	if (ActorCDO == nullptr)
+		return ESoulHunterRepNodeMapping::NotRouted;
+
+	if (ActorCDO->bAlwaysRelevant)
+		return ESoulHunterRepNodeMapping::RelevantAllConnections;
+
+	if (ActorCDO->bOnlyRelevantToOwner)
+		return ESoulHunterRepNodeMapping::NotRouted;
+
+	return ActorCDO->IsReplicatingMovement() ? ESoulHunterRepNodeMapping::Spatialize_Dynamic : ESoulHunterRepNodeMapping::Spatialize_Static;
+}
+
+void USoulHunterReplicationGraph::InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool bSpatialize) const
+{
+	const AActor* ActorCDO = Class->GetDefaultObject<AActor>();
+
+	if (bSpatialize)
+		Info.SetCullDistanceSquared(ActorCDO->NetCullDistanceSquared);
+
+	const float ServerTickRate = NetDriver ? NetDriver->GetNetServerMaxTickRate() : 30.f;
+
+	Info.ReplicationPeriodFrame = FMath::Max<uint32>(FMath::RoundToInt(ServerTickRate / FMath::Max(ActorCDO->NetUpdateFrequency, 1.f)), 1);
+}
+
+#pragma endregion
+
+#pragma region Console Commands
+
+namespace SoulHunterRepGraph
+{
+	static FAutoConsoleCommandWithWorldAndArgs StatsCommand(
+		TEXT("sh.Net.RepGraphStats"),
+		TEXT("Logs routed actor counts and ServerReplicateActors cost percentiles. Pass 'reset' to clear the samples."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			USoulHunterReplicationGraph* Graph = GetGraph(World);
+
+			if (Graph == nullptr)
+			{
+				UE_LOG(LogSoulHunter, Display, TEXT("Replication graph: not active in %s"), *GetNameSafe(World));
+				return;
+			}
+
+			if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+				Graph->ResetStats();
+			else
+				Graph->LogStats();
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs SpawnBenchmarkEnemiesCommand(
+		TEXT("sh.Net.SpawnBenchmarkEnemies"),
+		TEXT("Server only. Spawns <Count> copies of the first enemy class in the world on a grid around the first player, <Spacing> units apart (default 400)."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (World == nullptr || World->GetNetMode() == NM_Client)
+				return;
+
+			const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100;
+			const float Spacing = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 400.f;
+
+			TActorIterator<AEnemy> EnemyIt(World);
+			UClass* EnemyClass = EnemyIt ? EnemyIt->GetClass() : nullptr;
+
+			if (EnemyClass == nullptr || Count <= 0)
+			{
+				UE_LOG(LogSoulHunter, Warning, TEXT("sh.Net.SpawnBenchmarkEnemies: no enemy in the world to copy"));
+				return;
+			}
+
+			const APlayerController* PlayerController = World->GetFirstPlayerController();
+			const APawn* PlayerPawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+			const FVector Origin = PlayerPawn ? PlayerPawn->GetActorLocation() : EnemyIt->GetActorLocation();
+
+			const int32 Side = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count)));
+
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+			int32 NumSpawned = 0;
+
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				const FVector Offset((Index % Side - Side / 2) * Spacing, (Index / Side - Side / 2) * Spacing, 0.f);
+
+				if (World->SpawnActor<AEnemy>(EnemyClass, Origin + Offset, FRotator::ZeroRotator, SpawnParams))
+					++NumSpawned;
+			}
+
+			UE_LOG(LogSoulHunter, Display, TEXT("sh.Net.SpawnBenchmarkEnemies: spawned %d %s"), NumSpawned, *EnemyClass->GetName());
+		}));
+}
+
+#pragma endregion
@@ -0,0 +1,577 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Persistence/SaveGameSubsystem.h"
+#include "Persistence/WorldStateSubsystem.h"
+#include "Components/AttributeComponent.h"
+#include "SoulHunter.h"
+#include "Engine/Engine.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace SaveGame
+{
+	constexpr uint32 FileMagic = 0x56534853; // "SHSV"
+	constexpr uint16 FormatVersion = 2;
+
+	// Version 2 keys the player section by player instead of holding the first local player's attributes only.
+	constexpr uint16 PerPlayerVersion = 2;
+
+	enum class ECompression : uint8
+	{
+		None,
+		Oodle
+	};
+
+	const TCHAR* AutosaveSlot = TEXT("Autosave");
+
+	TAutoConsoleVariable<float> CVarAutosaveInterval(
+		TEXT("sh.Save.AutosaveInterval"),
+		60.f,
+		TEXT("Seconds between autosaves. 0 disables autosaving."));
+
+	struct FSectionHeader
+	{
+		uint32 Magic = FileMagic;
+		uint16 Version = FormatVersion;
+		uint8 Section = 0;
+		uint8 Compression = 0;
+		int32 UncompressedSize = 0;
+		int32 CompressedSize = 0;
+		uint32 Crc = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FSectionHeader& Header)
+		{
+			return Ar << Header.Magic << Header.Version << Header.Section << Header.Compression
+				<< Header.UncompressedSize << Header.CompressedSize << Header.Crc;
+		}
+	};
+
+	struct FPlayerSaveData
+	{
+		FString MapName;
+		TMap<FString, FAttributeSnapshot> Players;
+
+		void Serialize(FArchive& Ar, uint16 Version)
+		{
+			Ar << MapName;
+
+			if (Version >= PerPlayerVersion)
+			{
+				Ar << Players;
+				return;
+			}
+
+			// The single snapshot of an older save is left unkeyed, for the first player to spawn to claim.
+			FAttributeSnapshot Attributes;
+			Ar << Attributes;
+			Players.Add(FString(), Attributes);
+		}
+	};
+
+	const TCHAR* GetSectionName(ESaveSection Section)
+	{
+		switch (Section)
+		{
+		case ESaveSection::Player: return TEXT("Player");
+		case ESaveSection::World: return TEXT("World");
+		default: return TEXT("Unknown");
+		}
+	}
+}
+
+#pragma region Main
+
+void USaveGameSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Collection.InitializeDependency(UWorldStateSubsystem::StaticClass());
+
+	Super::Initialize(Collection);
+
+	AutosaveHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &USaveGameSubsystem::TickAutosave), 1.f);
+}
+
+void USaveGameSubsystem::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(AutosaveHandle);
+
+	WaitForPendingSaves();
+
+	Super::Deinitialize();
+}
+
+USaveGameSubsystem* USaveGameSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+
+	return GameInstance ? GameInstance->GetSubsystem<USaveGameSubsystem>() : nullptr;
+}
+
+bool USaveGameSubsystem::SaveGame(const FString& SlotName, bool bOnlyChangedSections)
+{
+	CollectFinishedSaves();
+
+	UWorldStateSubsystem* WorldState = GetGameInstance()->GetSubsystem<UWorldStateSubsystem>();
+	UWorld* World = GetGameInstance()->GetWorld();
+
+	if (WorldState == nullptr || World == nullptr)
+		return false;
+
+	// The game is saved by whoever runs it. A client has no world state of its own and would write an empty one over the host's.
+	if (World->GetNetMode() == NM_Client)
+		return false;
+
+	bool bLaunchedAny = false;
+
+	// Player section: a few values per player, so its dirty key is simply a checksum of them. Players who left keep the
+	// snapshot taken as their pawn ended play.
+	SaveGame::FPlayerSaveData PlayerData;
+	PlayerData.MapName = UWorld::RemovePIEPrefix(World->GetOutermost()->GetName());
+	PlayerData.Players = WorldState->GetPlayerSnapshots();
+
+	for (FConstPlayerControllerIterator Iterator = World->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator->Get();
+		const APawn* PlayerPawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+		const UAttributeComponent* Attributes = PlayerPawn ? PlayerPawn->FindComponentByClass<UAttributeComponent>() : nullptr;
+		const FString PlayerKey = UWorldStateSubsystem::GetPlayerKey(PlayerController);
+
+		if (Attributes && !PlayerKey.IsEmpty())
+			PlayerData.Players.Add(PlayerKey, Attributes->WriteSnapshot());
+	}
+
+	PlayerData.Players.KeySort(TLess<FString>());
+
+	TArray<uint8> PlayerBytes;
+	FMemoryWriter PlayerWriter(PlayerBytes);
+	PlayerData.Serialize(PlayerWriter, SaveGame::FormatVersion);
+
+	const uint32 PlayerKey = FCrc::MemCrc32(PlayerBytes.GetData(), PlayerBytes.Num());
+
+	if (!bOnlyChangedSections || IsDirty(Sections[static_cast<int32>(ESaveSection::Player)], SlotName, PlayerKey))
+	{
+		bLaunchedAny |= LaunchSectionWrite(ESaveSection::Player, SlotName, PlayerKey, [PlayerBytes = MoveTemp(PlayerBytes)](TArray<uint8>& OutBytes) mutable
+		{
+			OutBytes = MoveTemp(PlayerBytes);
+			return true;
+		});
+	}
+
+	// World section: the revision counter tells whether anything was recorded since the last write. Captured only once the
+	// previous world write is done, since the capture shares the cell bytes that write is still packing.
+	if (IsSectionBusy(ESaveSection::World))
+		return bLaunchedAny;
+
+	WorldState->RefreshVolatileActors();
+
+	const uint32 WorldKey = WorldState->GetRevision();
+
+	if (!bOnlyChangedSections || IsDirty(Sections[static_cast<int32>(ESaveSection::World)], SlotName, WorldKey))
+	{
+		bLaunchedAny |= LaunchSectionWrite(ESaveSection::World, SlotName, WorldKey, [Capture = WorldState->CaptureForSave()](TArray<uint8>& OutBytes) mutable
+		{
+			FMemoryWriter Writer(OutBytes);
+			Capture.Serialize(Writer);
+			return !Writer.IsError();
+		});
+	}
+
+	return bLaunchedAny;
+}
+
+bool USaveGameSubsystem::LoadGame(const FString& SlotName)
+{
+	WaitForPendingSaves();
+
+	UWorldStateSubsystem* WorldState = GetGameInstance()->GetSubsystem<UWorldStateSubsystem>();
+
+	if (WorldState == nullptr)
+		return false;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	TArray<uint8> PlayerBytes;
+	uint16 PlayerVersion = 0;
+
+	if (!ReadSectionFile(GetSectionPath(SlotName, ESaveSection::Player), ESaveSection::Player, PlayerBytes, &PlayerVersion))
+		return false;
+
+	SaveGame::FPlayerSaveData PlayerData;
+	FMemoryReader PlayerReader(PlayerBytes);
+	PlayerData.Serialize(PlayerReader, PlayerVersion);
+
+	// A slot without a world section is still valid, it just has nothing recorded yet.
+	FWorldStateSnapshot WorldSnapshot;
+	TArray<uint8> WorldBytes;
+
+	if (ReadSectionFile(GetSectionPath(SlotName, ESaveSection::World), ESaveSection::World, WorldBytes))
+	{
+		FMemoryReader WorldReader(WorldBytes);
+		WorldSnapshot.Serialize(WorldReader);
+	}
+
+	if (PlayerReader.IsError())
+	{
+		UE_LOG(LogSoulHunter, Warning, TEXT("Save game: slot %s has a corrupt player section"), *SlotName);
+		return false;
+	}
+
+	WorldState->LoadSnapshot(MoveTemp(WorldSnapshot));
+	WorldState->SetPlayerSnapshots(MoveTemp(PlayerData.Players));
+
+	UE_LOG(LogSoulHunter, Log, TEXT("Save game: loaded slot %s in %.2f ms"), *SlotName, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	if (!PlayerData.MapName.IsEmpty())
+		UGameplayStatics::OpenLevel(this, FName(*PlayerData.MapName));
+
+	return true;
+}
+
+bool USaveGameSubsystem::IsSaving() const
+{
+	for (int32 Section = 0; Section < static_cast<int32>(ESaveSection::Count); ++Section)
+	{
+		if (IsSectionBusy(static_cast<ESaveSection>(Section)))
+			return true;
+	}
+
+	return false;
+}
+
+void USaveGameSubsystem::WaitForPendingSaves()
+{
+	for (FSectionState& State : Sections)
+	{
+		if (State.PendingTask.IsValid())
+			State.PendingTask.Wait();
+	}
+
+	CollectFinishedSaves();
+}
+
+FString USaveGameSubsystem::GetSectionPath(const FString& SlotName, ESaveSection Section)
+{
+	return FPaths::ProjectSavedDir() / TEXT("SaveGames") / SlotName / FString(SaveGame::GetSectionName(Section)) + TEXT(".sav");
+}
+
+#pragma endregion
+
+#pragma region File Format
+
+bool USaveGameSubsystem::WriteSectionFile(const FString& Path, ESaveSection Section, const TArray<uint8>& RawBytes)
+{
+	SaveGame::FSectionHeader Header;
+	Header.Section = static_cast<uint8>(Section);
+	Header.UncompressedSize = RawBytes.Num();
+	Header.Crc = FCrc::MemCrc32(RawBytes.GetData(), RawBytes.Num());
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Oodle, RawBytes.Num());
+	TArray<uint8> Compressed;
+	Compressed.SetNumUninitialized(CompressedSize);
+
+	const bool bCompressed = RawBytes.Num() > 0
+		&& FCompression::CompressMemory(NAME_Oodle, Compressed.GetData(), CompressedSize, RawBytes.GetData(), RawBytes.Num())
+		&& CompressedSize < RawBytes.Num();
+
+	if (bCompressed)
+	{
+		Compressed.SetNum(CompressedSize, false);
+		Header.Compression = static_cast<uint8>(SaveGame::ECompression::Oodle);
+	}
+	else
+	{
+		Compressed = RawBytes;
+		Header.Compression = static_cast<uint8>(SaveGame::ECompression::None);
+	}
+
+	Header.CompressedSize = Compressed.Num();
+
+	TArray<uint8> FileBytes;
+	FileBytes.Reserve(Compressed.Num() + 32);
+
+	FMemoryWriter Writer(FileBytes);
+	Writer << Header;
+	Writer.Serialize(Compressed.GetData(), Compressed.Num());
+
+	// Write next to the target and swap it in, so a crash mid-write never leaves a truncated section behind.
+	const FString TempPath = Path + TEXT(".tmp");
+
+	if (!FFileHelper::SaveArrayToFile(FileBytes, *TempPath))
+		return false;
+
+	return IFileManager::Get().Move(*Path, *TempPath, true, true);
+}
+
+bool USaveGameSubsystem::ReadSectionFile(const FString& Path, ESaveSection Section, TArray<uint8>& OutRawBytes, uint16* OutVersion)
+{
+	TArray<uint8> FileBytes;
+
+	if (!FFileHelper::LoadFileToArray(FileBytes, *Path, FILEREAD_Silent))
+		return false;
+
+	SaveGame::FSectionHeader Header;
+	FMemoryReader Reader(FileBytes);
+	Reader << Header;
+
+	const int64 PayloadOffset = Reader.Tell();
+
+	if (Reader.IsError() || Header.Magic != SaveGame::FileMagic || Header.Section != static_cast<uint8>(Section)
+		|| Header.CompressedSize < 0 || Header.UncompressedSize < 0 || PayloadOffset + Header.CompressedSize > FileBytes.Num())
+	{
+		UE_LOG(LogSoulHunter, Warning, TEXT("Save game: %s is not a valid section file"), *Path);
+		return false;
+	}
+
+	if (Header.Version > SaveGame::FormatVersion)
+	{
+		UE_LOG(LogSoulHunter, Warning, TEXT("Save game: %s was written by a newer version (%d)"), *Path, Header.Version);
+		return false;
+	}
+
+	OutRawBytes.SetNumUninitialized(Header.UncompressedSize);
+	const uint8* Payload = FileBytes.GetData() + PayloadOffset;
+
+	bool bDecoded = false;
+
+	switch (static_cast<SaveGame::ECompression>(Header.Compression))
+	{
+	case SaveGame::ECompression::None:
+		bDecoded = Header.CompressedSize == Header.UncompressedSize;
+		if (bDecoded)
+			FMemory::Memcpy(OutRawBytes.GetData(), Payload, Header.UncompressedSize);
+		break;
+	case SaveGame::ECompression::Oodle:
+		bDecoded = FCompression::UncompressMemory(NAME_Oodle, OutRawBytes.GetData(), Header.UncompressedSize, Payload, Header.CompressedSize);
+		break;
+	}
+
+	if (!bDecoded || FCrc::MemCrc32(OutRawBytes.GetData(), OutRawBytes.Num()) != Header.Crc)
+	{
+		UE_LOG(LogSoulHunter, Warning, TEXT("Save game: %s failed to decode or its checksum does not match"), *Path);
+		OutRawBytes.Reset();
+		return false;
+	}
+
+	if (OutVersion)
+		*OutVersion = Header.Version;
+
+	return true;
+}
+
+#pragma endregion
+
+#pragma region Sections
+
+bool USaveGameSubsystem::IsDirty(const FSectionState& State, const FString& SlotName, uint32 Key) const
+{
+	return !State.bWritten || State.LastKey != Key || State.LastSlot != SlotName;
+}
+
+bool USaveGameSubsystem::IsSectionBusy(ESaveSection Section) const
+{
+	const FSectionState& State = Sections[static_cast<int32>(Section)];
+
+	return State.PendingTask.IsValid() && !State.PendingTask.IsCompleted();
+}
+
+bool USaveGameSubsystem::LaunchSectionWrite(ESaveSection Section, const FString& SlotName, uint32 Key, TUniqueFunction<bool(TArray<uint8>&)>&& Serializer)
+{
+	FSectionState& State = Sections[static_cast<int32>(Section)];
+
+	// One write per section at a time; the section stays dirty and is picked up by the next save.
+	if (IsSectionBusy(Section))
+		return false;
+
+	State.PendingSlot = SlotName;
+	State.PendingKey = Key;
+
+	const FString Path = GetSectionPath(SlotName, Section);
+
+	State.PendingTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Path, Section, Serializer = MoveTemp(Serializer)]() mutable
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		TArray<uint8> RawBytes;
+
+		if (!Serializer(RawBytes) || !WriteSectionFile(Path, Section, RawBytes))
+		{
+			UE_LOG(LogSoulHunter, Warning, TEXT("Save game: failed to write %s"), *Path);
+			return false;
+		}
+
+		UE_LOG(LogSoulHunter, Verbose, TEXT("Save game: wrote %s (%d bytes raw) in %.2f ms"), *Path, RawBytes.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+		return true;
+	});
+
+	return true;
+}
+
+void USaveGameSubsystem::CollectFinishedSaves()
+{
+	for (FSectionState& State : Sections)
+	{
+		if (!State.PendingTask.IsValid() || !State.PendingTask.IsCompleted())
+			continue;
+
+		if (State.PendingTask.GetResult())
+		{
+			State.LastSlot = State.PendingSlot;
+			State.LastKey = State.PendingKey;
+			State.bWritten = true;
+		}
+
+		State.PendingTask = UE::Tasks::TTask<bool>();
+	}
+}
+
+#pragma endregion
+
+#pragma region Autosave
+
+bool USaveGameSubsystem::TickAutosave(float DeltaTime)
+{
+	CollectFinishedSaves();
+
+	const float Interval = SaveGame::CVarAutosaveInterval.GetValueOnGameThread();
+	const UWorld* World = GetGameInstance()->GetWorld();
+
+	if (Interval <= 0.f || World == nullptr || !World->IsGameWorld() || World->bIsTearingDown || World->GetNetMode() == NM_Client)
+		return true;
+
+	TimeSinceAutosave += DeltaTime;
+
+	if (TimeSinceAutosave >= Interval)
+	{
+		TimeSinceAutosave = 0.f;
+		SaveGame(SaveGame::AutosaveSlot, true);
+	}
+
+	return true;
+}
+
+#pragma endregion
+
+#pragma region Console Commands
+
+namespace SaveGame
+{
+	static FAutoConsoleCommandWithWorldAndArgs SaveCommand(
+		TEXT("sh.Save.Save"),
+		TEXT("Saves the game to the given slot (default: Manual)."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (USaveGameSubsystem* SaveSubsystem = USaveGameSubsystem::Get(World))
+				SaveSubsystem->SaveGame(Args.Num() > 0 ? Args[0] : TEXT("Manual"));
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs LoadCommand(
+		TEXT("sh.Save.Load"),
+		TEXT("Loads the given slot (default: Manual) and reopens its map."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (USaveGameSubsystem* SaveSubsystem = USaveGameSubsystem::Get(World))
+				SaveSubsystem->LoadGame(Args.Num() > 0 ? Args[0] : TEXT("Manual"));
+		}));
+
+	static void BenchmarkLoad(const TArray<FString>& Args)
+	{
+		const int32 NumCells = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 256;
+		const int32 ActorsPerCell = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 512;
+
+		FRandomStream Random(0x5A4E);
+		FWorldStateSnapshot Snapshot;
+		TMap<FName, TArray<uint8>>& Cells = Snapshot.Worlds.Add(TEXT("/Game/Benchmark"));
+
+		for (int32 CellIndex = 0; CellIndex < NumCells; ++CellIndex)
+		{
+			FCellState Cell;
+
+			for (int32 ActorIndex = 0; ActorIndex < ActorsPerCell; ++ActorIndex)
+			{
+				FActorStateRecord Record;
+				Record.Guid = FGuid(Random.GetUnsignedInt(), Random.GetUnsignedInt(), Random.GetUnsignedInt(), Random.GetUnsignedInt());
+				Record.Flags = (ActorIndex % 4 == 0) ? EActorStateFlags::Moved : EActorStateFlags::Dead;
+				Record.Location = FVector3f(Random.FRandRange(-1e5f, 1e5f), Random.FRandRange(-1e5f, 1e5f), 0.f);
+				Cell.Actors.Add(Record.Guid, Record);
+			}
+
+			for (int32 PickupIndex = 0; PickupIndex < ActorsPerCell / 8; ++PickupIndex)
+			{
+				FDynamicPickupRecord& Pickup = Cell.Pickups.AddDefaulted_GetRef();
+				Pickup.Guid = FGuid::NewGuid();
+				Pickup.PickupClass = FSoftClassPath(TEXT("/Game/_SoulHunter/Core/Blueprints/Items/Pickups/Souls/BP_Soul.BP_Soul_C"));
+				Pickup.Amount = Random.RandRange(1, 100);
+			}
+
+			FMemoryWriter CellWriter(Cells.Add(FName(*FString::Printf(TEXT("Cell_%d"), CellIndex))));
+			Cell.Serialize(CellWriter);
+		}
+
+		TArray<uint8> RawBytes;
+		FMemoryWriter Writer(RawBytes);
+		Snapshot.Serialize(Writer);
+
+		const FString Path = USaveGameSubsystem::GetSectionPath(TEXT("LoadBenchmark"), ESaveSection::World);
+
+		double Time = FPlatformTime::Seconds();
+		const bool bWritten = USaveGameSubsystem::WriteSectionFile(Path, ESaveSection::World, RawBytes);
+		const double WriteMs = (FPlatformTime::Seconds() - Time) * 1000.0;
+
+		if (!bWritten)
+		{
+			UE_LOG(LogSoulHunter, Warning, TEXT("Save benchmark: could not write %s"), *Path);
+			return;
+		}
+
+		const int64 FileSize = IFileManager::Get().FileSize(*Path);
+
+		Time = FPlatformTime::Seconds();
+		TArray<uint8> LoadedBytes;
+		USaveGameSubsystem::ReadSectionFile(Path, ESaveSection::World, LoadedBytes);
+		const double ReadMs = (FPlatformTime::Seconds() - Time) * 1000.0;
+
+		Time = FPlatformTime::Seconds();
+		FWorldStateSnapshot LoadedSnapshot;
+		FMemoryReader Reader(LoadedBytes);
+		LoadedSnapshot.Serialize(Reader);
+		const double ParseMs = (FPlatformTime::Seconds() - Time) * 1000.0;
+
+		// Unpacking every cell is the worst case: normally a cell is only unpacked when it streams in.
+		Time = FPlatformTime::Seconds();
+		int32 NumRecords = 0;
+
+		for (TPair<FName, TMap<FName, TArray<uint8>>>& WorldPair : LoadedSnapshot.Worlds)
+		{
+			for (TPair<FName, TArray<uint8>>& CellPair : WorldPair.Value)
+			{
+				FCellState Cell;
+				FMemoryReader CellReader(CellPair.Value);
+				Cell.Serialize(CellReader);
+				NumRecords += Cell.Actors.Num() + Cell.Pickups.Num();
+			}
+		}
+
+		const double UnpackMs = (FPlatformTime::Seconds() - Time) * 1000.0;
+
+		UE_LOG(LogSoulHunter, Display, TEXT("Save benchmark: %d cells, %d records, %.1f KB raw, %.1f KB on disk"),
+			NumCells, NumRecords, RawBytes.Num() / 1024.0, FileSize / 1024.0);
+		UE_LOG(LogSoulHunter, Display, TEXT("Save benchmark: write %.2f ms | read+decompress %.2f ms | parse %.2f ms | unpack all cells %.2f ms"),
+			WriteMs, ReadMs, ParseMs, UnpackMs);
+
+		IFileManager::Get().Delete(*Path);
+	}
+
+	static FAutoConsoleCommand BenchmarkLoadCommand(
+		TEXT("sh.Save.BenchmarkLoad"),
+		TEXT("Writes and reloads a synthetic world section. Usage: sh.Save.BenchmarkLoad [NumCells=256] [ActorsPerCell=512]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkLoad));
+}
+
+#pragma endregion
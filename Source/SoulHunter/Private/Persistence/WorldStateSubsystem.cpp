@@ -0,0 +1,702 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Persistence/WorldStateSubsystem.h"
+#include "Interfaces/PersistentInterface.h"
+#include "Items/Item.h"
+#include "SoulHunter.h"
+#include "Engine/Engine.h"
+#include "Engine/Level.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/PlayerState.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace WorldState
+{
+	constexpr uint8 CellVersion = 1;
+}
+
+#pragma region Cell Serialization
+
+void FWorldStateSnapshot::Serialize(FArchive& Ar)
+{
+	int32 NumWorlds = Worlds.Num();
+	Ar << NumWorlds;
+
+	if (Ar.IsLoading())
+		Worlds.Empty(NumWorlds);
+
+	auto SerializeWorld = [&Ar](FString& WorldName, TMap<FName, TArray<uint8>>& Cells)
+	{
+		Ar << WorldName;
+
+		int32 NumCells = Cells.Num();
+		Ar << NumCells;
+
+		if (Ar.IsSaving())
+		{
+			for (TPair<FName, TArray<uint8>>& CellPair : Cells)
+			{
+				FString CellName = CellPair.Key.ToString();
+				Ar << CellName;
+				Ar << CellPair.Value;
+			}
+
+			return;
+		}
+
+		Cells.Empty(NumCells);
+
+		for (int32 CellIndex = 0; CellIndex < NumCells; ++CellIndex)
+		{
+			FString CellName;
+			Ar << CellName;
+			Ar << Cells.Add(FName(*CellName));
+		}
+	};
+
+	if (Ar.IsSaving())
+	{
+		for (TPair<FName, TMap<FName, TArray<uint8>>>& WorldPair : Worlds)
+		{
+			FString WorldName = WorldPair.Key.ToString();
+			SerializeWorld(WorldName, WorldPair.Value);
+		}
+
+		return;
+	}
+
+	for (int32 WorldIndex = 0; WorldIndex < NumWorlds; ++WorldIndex)
+	{
+		FString WorldName;
+		TMap<FName, TArray<uint8>> Cells;
+		SerializeWorld(WorldName, Cells);
+
+		Worlds.Add(FName(*WorldName), MoveTemp(Cells));
+	}
+}
+
+void FWorldStateCapture::Serialize(FArchive& Ar)
+{
+	check(Ar.IsSaving());
+
+	int32 NumWorlds = Worlds.Num();
+	Ar << NumWorlds;
+
+	for (TPair<FName, FWorldCells>& WorldPair : Worlds)
+	{
+		FString WorldName = WorldPair.Key.ToString();
+		Ar << WorldName;
+
+		int32 NumCells = WorldPair.Value.Packed.Num() + WorldPair.Value.Changed.Num();
+		Ar << NumCells;
+
+		for (TPair<FName, FPackedCellBytes>& CellPair : WorldPair.Value.Packed)
+		{
+			FString CellName = CellPair.Key.ToString();
+			Ar << CellName;
+			Ar << *CellPair.Value;
+		}
+
+		// Packed here rather than on the game thread; the subsystem keeps the same bytes for the next capture.
+		for (TPair<FName, FChangedCell>& CellPair : WorldPair.Value.Changed)
+		{
+			FMemoryWriter CellWriter(*CellPair.Value.Bytes);
+			CellPair.Value.State.Serialize(CellWriter);
+
+			FString CellName = CellPair.Key.ToString();
+			Ar << CellName;
+			Ar << *CellPair.Value.Bytes;
+		}
+	}
+}
+
+void FCellState::Serialize(FArchive& Ar)
+{
+	uint8 Version = WorldState::CellVersion;
+	Ar << Version;
+
+	int32 NumActors = Actors.Num();
+	Ar << NumActors;
+
+	if (Ar.IsLoading())
+	{
+		Actors.Empty(NumActors);
+
+		for (int32 Index = 0; Index < NumActors; ++Index)
+		{
+			FActorStateRecord Record;
+			Ar << Record;
+			Actors.Add(Record.Guid, Record);
+		}
+	}
+	else
+	{
+		for (TPair<FGuid, FActorStateRecord>& Pair : Actors)
+			Ar << Pair.Value;
+	}
+
+	// Pickup classes are written once per cell and referenced by index.
+	TArray<FString> ClassPaths;
+	TArray<uint16> ClassIndices;
+
+	if (Ar.IsSaving())
+	{
+		ClassIndices.Reserve(Pickups.Num());
+
+		for (const FDynamicPickupRecord& Pickup : Pickups)
+			ClassIndices.Add(static_cast<uint16>(ClassPaths.AddUnique(Pickup.PickupClass.ToString())));
+	}
+
+	Ar << ClassPaths;
+
+	int32 NumPickups = Pickups.Num();
+	Ar << NumPickups;
+
+	if (Ar.IsLoading())
+		Pickups.SetNum(NumPickups);
+
+	for (int32 Index = 0; Index < NumPickups; ++Index)
+	{
+		FDynamicPickupRecord& Pickup = Pickups[Index];
+
+		uint16 ClassIndex = Ar.IsSaving() ? ClassIndices[Index] : 0;
+
+		Ar << Pickup.Guid;
+		Ar << ClassIndex;
+		Ar << Pickup.Location;
+		Ar << Pickup.Amount;
+
+		if (Ar.IsLoading() && ClassPaths.IsValidIndex(ClassIndex))
+			Pickup.PickupClass = FSoftClassPath(ClassPaths[ClassIndex]);
+	}
+}
+
+#pragma endregion
+
+#pragma region Main
+
+void UWorldStateSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	WorldActorsInitializedHandle = FWorldDelegates::OnWorldInitializedActors.AddUObject(this, &UWorldStateSubsystem::OnWorldActorsInitialized);
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UWorldStateSubsystem::OnLevelAdded);
+	LevelRemovedHandle = FWorldDelegates::PreLevelRemovedFromWorld.AddUObject(this, &UWorldStateSubsystem::OnLevelRemoved);
+	WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddUObject(this, &UWorldStateSubsystem::OnWorldCleanup);
+}
+
+void UWorldStateSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldInitializedActors.Remove(WorldActorsInitializedHandle);
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::PreLevelRemovedFromWorld.Remove(LevelRemovedHandle);
+	FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+
+	Super::Deinitialize();
+}
+
+UWorldStateSubsystem* UWorldStateSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+
+	return GameInstance ? GameInstance->GetSubsystem<UWorldStateSubsystem>() : nullptr;
+}
+
+FGuid UWorldStateSubsystem::MakeActorGuid(const AActor* Actor)
+{
+	if (Actor == nullptr || !(Actor->HasAnyFlags(RF_WasLoaded) || Actor->IsNetStartupActor()))
+		return FGuid::NewGuid();
+
+	// Placed actors hash their level path so the same actor maps to the same GUID in every session.
+	const FString StablePath = UWorld::RemovePIEPrefix(Actor->GetPathName());
+
+	uint32 Digest[4];
+
+	FMD5 Md5;
+	Md5.Update(reinterpret_cast<const uint8*>(*StablePath), StablePath.Len() * sizeof(TCHAR));
+	Md5.Final(reinterpret_cast<uint8*>(Digest));
+
+	return FGuid(Digest[0], Digest[1], Digest[2], Digest[3]);
+}
+
+FName UWorldStateSubsystem::GetWorldName(const UWorld* World)
+{
+	return FName(*UWorld::RemovePIEPrefix(World->GetOutermost()->GetName()));
+}
+
+FName UWorldStateSubsystem::GetCellName(const ULevel* Level)
+{
+	return FName(*UWorld::RemovePIEPrefix(Level->GetOutermost()->GetName()));
+}
+
+bool UWorldStateSubsystem::IsOurWorld(const UWorld* World) const
+{
+	// World state belongs to the server; a client applying it would destroy replicated actors under the server's feet.
+	return World && World->IsGameWorld() && World->GetNetMode() != NM_Client && World->GetGameInstance() == GetGameInstance();
+}
+
+UWorldStateSubsystem::FWorldStateData& UWorldStateSubsystem::GetWorldData(const UWorld* World)
+{
+	return Worlds.FindOrAdd(GetWorldName(World));
+}
+
+FCellState& UWorldStateSubsystem::GetLiveCell(const UWorld* World, FName CellName)
+{
+	FWorldStateData& WorldData = GetWorldData(World);
+
+	if (FCellState* LiveCell = WorldData.LiveCells.Find(CellName))
+		return *LiveCell;
+
+	FCellState& Cell = WorldData.LiveCells.Add(CellName);
+
+	if (const FPackedCellBytes* PackedCell = WorldData.PackedCells.Find(CellName))
+	{
+		FMemoryReader Reader(**PackedCell);
+		Cell.Serialize(Reader);
+
+		// Unpacked as is, so the packed bytes still describe the live cell until it changes.
+		WorldData.CapturedLiveCells.Add(CellName, *PackedCell);
+		WorldData.PackedCells.Remove(CellName);
+	}
+
+	return Cell;
+}
+
+void UWorldStateSubsystem::UpdateRecord(AActor* Actor, IPersistentInterface* Persistent, bool bOnlyIfChanged)
+{
+	FActorStateRecord Record;
+	Record.Guid = Persistent->GetPersistentGuid();
+
+	const bool bHasState = Persistent->WritePersistentState(Record);
+	const FName CellName = GetCellName(Actor->GetLevel());
+	FCellState& Cell = GetLiveCell(Actor->GetWorld(), CellName);
+
+	if (bOnlyIfChanged)
+	{
+		const FActorStateRecord* Existing = Cell.Actors.Find(Record.Guid);
+
+		if (bHasState ? (Existing && *Existing == Record) : Existing == nullptr)
+			return;
+	}
+
+	if (bHasState)
+		Cell.Actors.Add(Record.Guid, Record);
+	else
+		Cell.Actors.Remove(Record.Guid);
+
+	GetWorldData(Actor->GetWorld()).CapturedLiveCells.Remove(CellName);
+
+	++Revision;
+}
+
+#pragma endregion
+
+#pragma region Recording
+
+void UWorldStateSubsystem::RecordActorState(AActor* Actor)
+{
+	IPersistentInterface* Persistent = Cast<IPersistentInterface>(Actor);
+
+	if (Persistent == nullptr || Actor->GetLevel() == nullptr || !IsOurWorld(Actor->GetWorld()))
+		return;
+
+	UpdateRecord(Actor, Persistent, false);
+}
+
+void UWorldStateSubsystem::TrackDynamicPickup(AItem* Pickup)
+{
+	DynamicPickups.AddUnique(Pickup);
+	++Revision;
+}
+
+void UWorldStateSubsystem::UntrackDynamicPickup(AItem* Pickup)
+{
+	DynamicPickups.RemoveSwap(Pickup);
+	++Revision;
+}
+
+void UWorldStateSubsystem::TrackVolatileActor(AActor* Actor)
+{
+	VolatileActors.AddUnique(Actor);
+}
+
+void UWorldStateSubsystem::UntrackVolatileActor(AActor* Actor)
+{
+	VolatileActors.RemoveSwap(Actor);
+}
+
+void UWorldStateSubsystem::RefreshVolatileActors()
+{
+	if (bSuppressCapture)
+		return;
+
+	VolatileActors.RemoveAllSwap([](const TWeakObjectPtr<AActor>& Actor) { return !Actor.IsValid(); });
+
+	for (const TWeakObjectPtr<AActor>& WeakActor : VolatileActors)
+	{
+		AActor* Actor = WeakActor.Get();
+		IPersistentInterface* Persistent = Cast<IPersistentInterface>(Actor);
+
+		if (Persistent && Actor->GetLevel() && IsOurWorld(Actor->GetWorld()))
+			UpdateRecord(Actor, Persistent, true);
+	}
+}
+
+FString UWorldStateSubsystem::GetPlayerKey(const AController* Controller)
+{
+	const APlayerState* PlayerState = Controller ? Controller->PlayerState.Get() : nullptr;
+
+	if (PlayerState == nullptr)
+		return FString();
+
+	const FUniqueNetIdRepl& UniqueId = PlayerState->GetUniqueId();
+
+	return UniqueId.IsValid() ? UniqueId->ToString() : PlayerState->GetPlayerName();
+}
+
+void UWorldStateSubsystem::CapturePlayerState(const FString& PlayerKey, const UAttributeComponent* Attributes)
+{
+	if (Attributes == nullptr || PlayerKey.IsEmpty() || bSuppressCapture)
+		return;
+
+	PlayerSnapshots.Add(PlayerKey, Attributes->WriteSnapshot());
+}
+
+bool UWorldStateSubsystem::RestorePlayerState(const FString& PlayerKey, UAttributeComponent* Attributes)
+{
+	if (Attributes == nullptr || PlayerKey.IsEmpty())
+		return false;
+
+	if (const FAttributeSnapshot* Snapshot = PlayerSnapshots.Find(PlayerKey))
+	{
+		Attributes->ApplySnapshot(*Snapshot);
+		return true;
+	}
+
+	FAttributeSnapshot Unclaimed;
+
+	if (!PlayerSnapshots.RemoveAndCopyValue(FString(), Unclaimed))
+		return false;
+
+	Attributes->ApplySnapshot(Unclaimed);
+	PlayerSnapshots.Add(PlayerKey, Unclaimed);
+
+	return true;
+}
+
+void UWorldStateSubsystem::SetPlayerSnapshots(TMap<FString, FAttributeSnapshot>&& Snapshots)
+{
+	PlayerSnapshots = MoveTemp(Snapshots);
+}
+
+FWorldStateCapture UWorldStateSubsystem::CaptureForSave()
+{
+	// Pickups in loaded cells go into the capture only; they become part of their cell when it unloads.
+	TMap<FName, TArray<FDynamicPickupRecord>> LoadedPickups;
+	FName LoadedWorldName;
+
+	UWorld* World = GetGameInstance()->GetWorld();
+
+	if (IsOurWorld(World) && !bSuppressCapture)
+	{
+		LoadedWorldName = GetWorldName(World);
+		GatherLoadedPickups(World, LoadedPickups);
+	}
+
+	FWorldStateCapture Capture;
+
+	for (TPair<FName, FWorldStateData>& WorldPair : Worlds)
+	{
+		FWorldStateData& WorldData = WorldPair.Value;
+		FWorldStateCapture::FWorldCells& Cells = Capture.Worlds.Add(WorldPair.Key);
+
+		Cells.Packed = WorldData.PackedCells;
+
+		for (TPair<FName, FCellState>& LivePair : WorldData.LiveCells)
+		{
+			const TArray<FDynamicPickupRecord>* Pickups = WorldPair.Key == LoadedWorldName ? LoadedPickups.Find(LivePair.Key) : nullptr;
+
+			if (Pickups == nullptr)
+			{
+				if (const FPackedCellBytes* Captured = WorldData.CapturedLiveCells.Find(LivePair.Key))
+				{
+					Cells.Packed.Add(LivePair.Key, *Captured);
+					continue;
+				}
+
+				if (LivePair.Value.IsEmpty())
+					continue;
+			}
+
+			FWorldStateCapture::FChangedCell& Changed = Cells.Changed.Add(LivePair.Key);
+			Changed.State = LivePair.Value;
+
+			// Cells carrying transient pickups are not kept, their bytes do not describe the live cell alone.
+			if (Pickups)
+				Changed.State.Pickups.Append(*Pickups);
+			else
+				WorldData.CapturedLiveCells.Add(LivePair.Key, Changed.Bytes);
+		}
+	}
+
+	return Capture;
+}
+
+void UWorldStateSubsystem::GatherLoadedPickups(UWorld* World, TMap<FName, TArray<FDynamicPickupRecord>>& OutPickups)
+{
+	TArray<AItem*> CapturedPickups;
+	FCellState Scratch;
+
+	auto GatherLevel = [&](ULevel* Level, const FBox* CellBounds)
+	{
+		Scratch.Pickups.Reset();
+		WritePickups(CellBounds, Scratch, CapturedPickups);
+
+		if (Scratch.Pickups.Num() > 0)
+			OutPickups.Add(GetCellName(Level), Scratch.Pickups);
+	};
+
+	for (ULevel* Level : World->GetLevels())
+	{
+		const FBox* CellBounds = Level && Level != World->PersistentLevel ? LoadedCellBounds.Find(Level) : nullptr;
+
+		if (CellBounds)
+			GatherLevel(Level, CellBounds);
+	}
+
+	// Whatever is left over belongs to the persistent level.
+	GatherLevel(World->PersistentLevel, nullptr);
+}
+
+void UWorldStateSubsystem::LoadSnapshot(FWorldStateSnapshot&& Snapshot)
+{
+	Worlds.Reset();
+
+	for (TPair<FName, TMap<FName, TArray<uint8>>>& WorldPair : Snapshot.Worlds)
+	{
+		TMap<FName, FPackedCellBytes>& PackedCells = Worlds.Add(WorldPair.Key).PackedCells;
+
+		for (TPair<FName, TArray<uint8>>& CellPair : WorldPair.Value)
+			PackedCells.Add(CellPair.Key, MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(CellPair.Value)));
+	}
+
+	LoadedCellBounds.Reset();
+	DynamicPickups.Reset();
+	VolatileActors.Reset();
+
+	bSuppressCapture = true;
+	++Revision;
+}
+
+#pragma endregion
+
+#pragma region Streaming
+
+void UWorldStateSubsystem::OnWorldActorsInitialized(const UWorld::FActorsInitializedParams& Params)
+{
+	if (!IsOurWorld(Params.World))
+		return;
+
+	bSuppressCapture = false;
+
+	ApplyCell(Params.World->PersistentLevel, Params.World);
+}
+
+void UWorldStateSubsystem::OnLevelAdded(ULevel* Level, UWorld* World)
+{
+	if (Level && IsOurWorld(World))
+		ApplyCell(Level, World);
+}
+
+void UWorldStateSubsystem::OnLevelRemoved(ULevel* Level, UWorld* World)
+{
+	if (Level && IsOurWorld(World) && !bSuppressCapture)
+		CaptureCell(Level, World, false);
+}
+
+void UWorldStateSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+	if (!IsOurWorld(World))
+		return;
+
+	if (!bSuppressCapture)
+	{
+		for (ULevel* Level : World->GetLevels())
+		{
+			if (Level && Level != World->PersistentLevel)
+				CaptureCell(Level, World, false);
+		}
+
+		// Whatever is left over belongs to the persistent level.
+		CaptureCell(World->PersistentLevel, World, true);
+	}
+
+	LoadedCellBounds.Reset();
+	DynamicPickups.Reset();
+	VolatileActors.Reset();
+}
+
+void UWorldStateSubsystem::ApplyCell(ULevel* Level, UWorld* World)
+{
+	FCellState& Cell = GetLiveCell(World, GetCellName(Level));
+
+	TArray<TPair<IPersistentInterface*, const FActorStateRecord*>> PendingApplies;
+	FBox CellBounds(ForceInit);
+
+	for (AActor* Actor : Level->Actors)
+	{
+		if (Actor == nullptr)
+			continue;
+
+		CellBounds += Actor->GetActorLocation();
+
+		if (Cell.Actors.Num() == 0)
+			continue;
+
+		if (IPersistentInterface* Persistent = Cast<IPersistentInterface>(Actor))
+		{
+			if (const FActorStateRecord* Record = Cell.Actors.Find(Persistent->GetPersistentGuid()))
+				PendingApplies.Emplace(Persistent, Record);
+		}
+	}
+
+	if (Level != World->PersistentLevel)
+		LoadedCellBounds.Add(Level, CellBounds);
+
+	// Applying may destroy actors, so it runs after the level's actor list has been walked.
+	for (const TPair<IPersistentInterface*, const FActorStateRecord*>& Pending : PendingApplies)
+		Pending.Key->ApplyPersistentState(*Pending.Value);
+
+	if (Cell.Pickups.Num() > 0)
+	{
+		RespawnPickups(World, Cell.Pickups);
+		Cell.Pickups.Reset();
+
+		GetWorldData(World).CapturedLiveCells.Remove(GetCellName(Level));
+	}
+}
+
+void UWorldStateSubsystem::CaptureCell(ULevel* Level, UWorld* World, bool bCaptureAllPickups)
+{
+	const FName CellName = GetCellName(Level);
+	FCellState& Cell = GetLiveCell(World, CellName);
+
+	WriteActorStates(Level, Cell);
+
+	const FBox* CellBounds = bCaptureAllPickups ? nullptr : LoadedCellBounds.Find(Level);
+	TArray<AItem*> CapturedPickups;
+
+	if (bCaptureAllPickups || CellBounds)
+		WritePickups(CellBounds, Cell, CapturedPickups);
+
+	for (AItem* Pickup : CapturedPickups)
+	{
+		DynamicPickups.RemoveSwap(Pickup);
+
+		if (!bCaptureAllPickups)
+			Pickup->Destroy();
+	}
+
+	LoadedCellBounds.Remove(Level);
+
+	PackCell(GetWorldData(World), CellName);
+
+	++Revision;
+}
+
+void UWorldStateSubsystem::WriteActorStates(ULevel* Level, FCellState& Cell)
+{
+	for (AActor* Actor : Level->Actors)
+	{
+		IPersistentInterface* Persistent = Cast<IPersistentInterface>(Actor);
+
+		if (Persistent == nullptr || !IsValid(Actor))
+			continue;
+
+		FActorStateRecord Record;
+		Record.Guid = Persistent->GetPersistentGuid();
+
+		if (Persistent->WritePersistentState(Record))
+			Cell.Actors.Add(Record.Guid, Record);
+		else
+			Cell.Actors.Remove(Record.Guid);
+	}
+}
+
+void UWorldStateSubsystem::WritePickups(const FBox* CellBounds, FCellState& Cell, TArray<AItem*>& InOutCaptured)
+{
+	DynamicPickups.RemoveAllSwap([](const TWeakObjectPtr<AItem>& Pickup) { return !Pickup.IsValid(); });
+
+	for (const TWeakObjectPtr<AItem>& WeakPickup : DynamicPickups)
+	{
+		AItem* Pickup = WeakPickup.Get();
+		const FVector Location = Pickup->GetActorLocation();
+
+		if (InOutCaptured.Contains(Pickup) || (CellBounds && !CellBounds->IsInsideXY(Location)))
+			continue;
+
+		FDynamicPickupRecord& Record = Cell.Pickups.AddDefaulted_GetRef();
+		Record.Guid = Pickup->GetPersistentGuid();
+		Record.PickupClass = FSoftClassPath(Pickup->GetClass());
+		Record.Location = FVector3f(Location);
+		Record.Amount = Pickup->GetPersistentAmount();
+
+		InOutCaptured.Add(Pickup);
+	}
+}
+
+void UWorldStateSubsystem::PackCell(FWorldStateData& WorldData, FName CellName)
+{
+	FCellState* LiveCell = WorldData.LiveCells.Find(CellName);
+
+	if (LiveCell == nullptr)
+		return;
+
+	// Always freshly allocated: a save in flight may still be reading the previous bytes.
+	if (!LiveCell->IsEmpty())
+	{
+		FPackedCellBytes Bytes = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>();
+		PackCellState(*LiveCell, *Bytes);
+		WorldData.PackedCells.Add(CellName, Bytes);
+	}
+
+	WorldData.LiveCells.Remove(CellName);
+	WorldData.CapturedLiveCells.Remove(CellName);
+}
+
+void UWorldStateSubsystem::PackCellState(FCellState& Cell, TArray<uint8>& OutBytes)
+{
+	OutBytes.Reset();
+
+	FMemoryWriter Writer(OutBytes);
+	Cell.Serialize(Writer);
+}
+
+void UWorldStateSubsystem::RespawnPickups(UWorld* World, const TArray<FDynamicPickupRecord>& Pickups)
+{
+	for (const FDynamicPickupRecord& Record : Pickups)
+	{
+		UClass* PickupClass = Record.PickupClass.TryLoadClass<AItem>();
+
+		if (PickupClass == nullptr)
+		{
+			UE_LOG(LogSoulHunter, Warning, TEXT("World state: could not resolve pickup class %s"), *Record.PickupClass.ToString());
+			continue;
+		}
+
+		const FTransform SpawnTransform(FVector(Record.Location));
+		AItem* Pickup = World->SpawnActorDeferred<AItem>(PickupClass, SpawnTransform);
+
+		if (Pickup)
+		{
+			Pickup->SetPersistentGuid(Record.Guid);
+			Pickup->SetPersistentAmount(Record.Amount);
+			Pickup->FinishSpawning(SpawnTransform);
+		}
+	}
+}
+
+#pragma endregion
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Scalability/GameplayScalability.h"
+#include "Scalability/GameplayScalabilitySubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "HAL/IConsoleManager.h"
+
+namespace GameplayScalability
+{
+	// Gameplay settings, read where the AI runs. They are not part of any quality level, so a host's graphics settings
+	// never change how enemies behave.
+
+	TAutoConsoleVariable<float> CVarAITickIntervalScale(
+		TEXT("sh.AI.TickIntervalScale"),
+		1.f,
+		TEXT("Scales the time between an enemy's patrol and combat decisions, as configured on the enemy."));
+
+	TAutoConsoleVariable<float> CVarAISensingIntervalScale(
+		TEXT("sh.AI.SensingIntervalScale"),
+		1.f,
+		TEXT("Scales the time between an enemy's sight checks, as configured on its pawn sensing."));
+
+	TAutoConsoleVariable<int32> CVarAISightTracesPerFrame(
+		TEXT("sh.AI.SightTracesPerFrame"),
+		16,
+		TEXT("Most line of sight traces patrol crowds may run in one frame."));
+
+	constexpr float MinCorpseLifeSpanScale = .1f;
+
+	TAutoConsoleVariable<float> CVarCorpseLifeSpanScale(
+		TEXT("sh.AI.CorpseLifeSpanScale"),
+		1.f,
+		TEXT("Scales how long dead enemies stay in the world. At least 0.1, since a life span of 0 would keep them forever."));
+
+	TAutoConsoleVariable<float> CVarRagdollImpulse(
+		TEXT("sh.Scalability.RagdollImpulse"),
+		1500.f,
+		TEXT("Impulse applied away from the killing blow when a character goes ragdoll."));
+
+	TAutoConsoleVariable<int32> CVarMaxRagdolls(
+		TEXT("sh.Scalability.MaxRagdolls"),
+		16,
+		TEXT("Most ragdolls left simulating at once. Past this, the oldest are put to sleep."),
+		ECVF_Scalability);
+
+	TAutoConsoleVariable<int32> CVarMaxHitEffectsPerFrame(
+		TEXT("sh.Scalability.MaxHitEffectsPerFrame"),
+		16,
+		TEXT("Most hit particle effects spawned in one frame."),
+		ECVF_Scalability);
+}
+
+float FGameplayScalability::GetAITickInterval(float BaseInterval)
+{
+	return BaseInterval * FMath::Max(GameplayScalability::CVarAITickIntervalScale.GetValueOnGameThread(), 0.f);
+}
+
+float FGameplayScalability::GetAISensingInterval(float BaseInterval)
+{
+	return FMath::Max(BaseInterval * GameplayScalability::CVarAISensingIntervalScale.GetValueOnGameThread(), .05f);
+}
+
+int32 FGameplayScalability::GetAISightTracesPerFrame()
+{
+	return FMath::Max(GameplayScalability::CVarAISightTracesPerFrame.GetValueOnGameThread(), 1);
+}
+
+float FGameplayScalability::GetCorpseLifeSpan(float BaseLifeSpan)
+{
+	return BaseLifeSpan * FMath::Max(GameplayScalability::CVarCorpseLifeSpanScale.GetValueOnGameThread(), GameplayScalability::MinCorpseLifeSpanScale);
+}
+
+float FGameplayScalability::GetRagdollImpulse()
+{
+	return GameplayScalability::CVarRagdollImpulse.GetValueOnGameThread();
+}
+
+bool FGameplayScalability::ClaimHitEffect(const UObject* WorldContextObject)
+{
+	UGameplayScalabilitySubsystem* Subsystem = UGameplayScalabilitySubsystem::Get(WorldContextObject);
+
+	return Subsystem == nullptr || Subsystem->ClaimHitEffect(GameplayScalability::CVarMaxHitEffectsPerFrame.GetValueOnGameThread());
+}
+
+void FGameplayScalability::RegisterRagdoll(USkeletalMeshComponent* Mesh)
+{
+	if (UGameplayScalabilitySubsystem* Subsystem = UGameplayScalabilitySubsystem::Get(Mesh))
+		Subsystem->RegisterRagdoll(Mesh, FMath::Max(GameplayScalability::CVarMaxRagdolls.GetValueOnGameThread(), 1));
+}
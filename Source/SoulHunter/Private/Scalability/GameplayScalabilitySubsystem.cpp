@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Scalability/GameplayScalabilitySubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/Engine.h"
+
+#pragma region Main
+
+UGameplayScalabilitySubsystem* UGameplayScalabilitySubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+
+	return World ? World->GetSubsystem<UGameplayScalabilitySubsystem>() : nullptr;
+}
+
+bool UGameplayScalabilitySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UGameplayScalabilitySubsystem::ClaimHitEffect(int32 MaxHitEffectsPerFrame)
+{
+	if (HitEffectFrame != GFrameCounter)
+	{
+		HitEffectFrame = GFrameCounter;
+		NumHitEffectsThisFrame = 0;
+	}
+
+	return NumHitEffectsThisFrame++ < MaxHitEffectsPerFrame;
+}
+
+void UGameplayScalabilitySubsystem::RegisterRagdoll(USkeletalMeshComponent* Mesh, int32 MaxRagdolls)
+{
+	Ragdolls.RemoveAll([](const TWeakObjectPtr<USkeletalMeshComponent>& Ragdoll) { return !Ragdoll.IsValid(); });
+	Ragdolls.Add(Mesh);
+
+	// Sleeping bodies keep their pose and cost nothing until something touches them.
+	while (Ragdolls.Num() > MaxRagdolls)
+	{
+		if (USkeletalMeshComponent* Oldest = Ragdolls[0].Get())
+			Oldest->PutAllRigidBodiesToSleep();
+
+		Ragdolls.RemoveAt(0, 1, false);
+	}
+}
+
+#pragma endregion
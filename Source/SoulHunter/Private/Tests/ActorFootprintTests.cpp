@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Diagnostics/ActorFootprint.h"
+#include "Tests/TestWorld.h"
+#include "GameFramework/RotatingMovementComponent.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FActorFootprintMeasureTest, "SoulHunter.Diagnostics.ActorFootprint.Measure",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FActorFootprintMeasureTest::RunTest(const FString& Parameters)
+{
+	FTestWorldScope TestWorld;
+
+	// An actor built up by hand: a root that cannot tick, a component that ticks and one that can tick but starts disabled.
+	AActor* Actor = TestWorld.World->SpawnActor<AActor>();
+	Actor->PrimaryActorTick.bCanEverTick = true;
+
+	USceneComponent* Root = NewObject<USceneComponent>(Actor, TEXT("Root"));
+	Actor->SetRootComponent(Root);
+	Root->RegisterComponent();
+
+	URotatingMovementComponent* Ticking = NewObject<URotatingMovementComponent>(Actor, TEXT("Ticking"));
+	Ticking->RegisterComponent();
+
+	URotatingMovementComponent* Disabled = NewObject<URotatingMovementComponent>(Actor, TEXT("Disabled"));
+	Disabled->PrimaryComponentTick.bStartWithTickEnabled = false;
+	Disabled->RegisterComponent();
+
+	FActorFootprint Footprint;
+	FActorFootprint::MeasureActor(Actor, Footprint);
+
+	TestEqual(TEXT("Class name"), Footprint.ClassName, AActor::StaticClass()->GetName());
+	TestEqual(TEXT("Objects: the actor and its three components"), Footprint.NumObjects, 4);
+	TestEqual(TEXT("Components"), Footprint.NumComponents, 3);
+	TestEqual(TEXT("Registered, enabled tick functions: the actor and one component"), Footprint.NumTickFunctions, 2);
+	TestEqual(TEXT("One entry per object"), Footprint.Objects.Num(), Footprint.NumObjects);
+
+	const int64 ExpectedInstanceBytes = AActor::StaticClass()->GetStructureSize()
+		+ USceneComponent::StaticClass()->GetStructureSize()
+		+ 2 * URotatingMovementComponent::StaticClass()->GetStructureSize();
+
+	TestEqual(TEXT("Instance bytes are the class sizes"), Footprint.InstanceBytes, ExpectedInstanceBytes);
+	TestTrue(TEXT("Allocated bytes are not negative"), Footprint.AllocatedBytes >= 0);
+
+	int64 ObjectBytes = 0;
+
+	for (const FObjectFootprint& Object : Footprint.Objects)
+	{
+		ObjectBytes += Object.Bytes;
+
+		if (Object.Name == TEXT("Disabled"))
+			TestFalse(TEXT("A tick function that starts disabled is not counted"), Object.bTicks);
+		else if (Object.Name == TEXT("Ticking"))
+			TestTrue(TEXT("An enabled component tick is counted"), Object.bTicks);
+		else if (Object.Name == TEXT("Root"))
+			TestFalse(TEXT("A component that can never tick is not counted"), Object.bTicks);
+	}
+
+	TestEqual(TEXT("Per-object bytes add up to the total"), ObjectBytes, Footprint.GetTotalBytes());
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FActorFootprintClassesTest, "SoulHunter.Diagnostics.ActorFootprint.DefaultClasses",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FActorFootprintClassesTest::RunTest(const FString& Parameters)
+{
+	const TArray<UClass*> ActorClasses = FActorFootprint::GetDefaultClasses();
+	const TArray<FActorFootprint> Footprints = FActorFootprint::MeasureClasses(ActorClasses);
+
+	TestEqual(TEXT("Every default class was measured"), Footprints.Num(), ActorClasses.Num());
+
+	for (const FActorFootprint& Footprint : Footprints)
+	{
+		TestTrue(*FString::Printf(TEXT("%s has components"), *Footprint.ClassName), Footprint.NumComponents > 0);
+		TestTrue(*FString::Printf(TEXT("%s counts itself and its components"), *Footprint.ClassName), Footprint.NumObjects > Footprint.NumComponents);
+		TestTrue(*FString::Printf(TEXT("%s is at least its own instance size"), *Footprint.ClassName), Footprint.InstanceBytes >= AActor::StaticClass()->GetStructureSize());
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,176 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Combat/CombatStatTables.h"
+#include "Components/AttributeComponent.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace CombatStatTableTests
+{
+	template<typename StatsType>
+	bool StatsEqual(const StatsType& A, const StatsType& B)
+	{
+		return StatsType::StaticStruct()->CompareScriptStruct(&A, &B, PPF_None);
+	}
+
+	FEnemyStats MakeEnemyStats()
+	{
+		FEnemyStats Stats;
+		Stats.PawnSightRadius = 1500.f;
+		Stats.PawnPeripheralVisionAngle = 60.f;
+		Stats.PatrollingSpeed = 90.f;
+		Stats.PatrolRadius = 250.f;
+		Stats.AcceptanceRadius = 35.f;
+		Stats.PatrolWaitingTimeMin = 2.f;
+		Stats.PatrolWaitingTimeMax = 6.f;
+		Stats.ChasingSpeed = 420.f;
+		Stats.CombatRadius = 800.f;
+		Stats.AttackRadius = 160.f;
+		Stats.AttackWaitingTimeMin = .25f;
+		Stats.AttackWaitingTimeMax = .75f;
+		Stats.DeathLifeSpan = 12.f;
+
+		return Stats;
+	}
+
+	FWeaponStats MakeWeaponStats()
+	{
+		FWeaponStats Stats;
+		Stats.Damage = 35.f;
+		Stats.BoxTraceExtent = FVector(10.f, 12.f, 40.f);
+		Stats.MaxReportedHitDistance = 350.f;
+		Stats.MaxSwingDuration = 2.f;
+
+		return Stats;
+	}
+
+	FStaminaStats MakeStaminaStats()
+	{
+		FStaminaStats Stats;
+		Stats.DodgeCost = 20.f;
+		Stats.SprintCost = 6.f;
+		Stats.StaminaRegenRate = 12.f;
+
+		return Stats;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCombatStatTableRowsTest, "SoulHunter.Combat.StatTables.RowsMatchArchetypes",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCombatStatTableRowsTest::RunTest(const FString& Parameters)
+{
+	using namespace CombatStatTableTests;
+
+	FCombatStatTables& Tables = FCombatStatTables::Get();
+
+	TestTrue(TEXT("Enemies without an archetype use the C++ defaults"), StatsEqual(Tables.GetEnemyRow(Tables.FindOrCompile(static_cast<const UEnemyArchetype*>(nullptr))).Stats, FEnemyStats()));
+	TestTrue(TEXT("Weapons without an archetype use the C++ defaults"), StatsEqual(Tables.GetWeaponRow(Tables.FindOrCompile(static_cast<const UWeaponArchetype*>(nullptr))), FWeaponStats()));
+	TestTrue(TEXT("Stamina without an archetype uses the C++ defaults"), StatsEqual(Tables.GetStaminaRow(Tables.FindOrCompile(static_cast<const UStaminaArchetype*>(nullptr))), FStaminaStats()));
+
+	// Enemy rows also carry the squares and the cosine the AI compares against.
+	UEnemyArchetype* EnemyArchetype = NewObject<UEnemyArchetype>();
+	EnemyArchetype->Stats = MakeEnemyStats();
+
+	const int32 EnemyIndex = Tables.FindOrCompile(EnemyArchetype);
+	const FEnemyStatRow& EnemyRow = Tables.GetEnemyRow(EnemyIndex);
+
+	TestNotEqual(TEXT("Enemy archetype gets its own row"), EnemyIndex, 0);
+	TestEqual(TEXT("Enemy archetype compiles once"), Tables.FindOrCompile(EnemyArchetype), EnemyIndex);
+	TestTrue(TEXT("Enemy row holds the archetype's values"), StatsEqual(EnemyRow.Stats, EnemyArchetype->Stats));
+	TestEqual(TEXT("Patrol radius squared"), EnemyRow.PatrolRadiusSquared, 250.f * 250.f);
+	TestEqual(TEXT("Combat radius squared"), EnemyRow.CombatRadiusSquared, 800.f * 800.f);
+	TestEqual(TEXT("Attack radius squared"), EnemyRow.AttackRadiusSquared, 160.f * 160.f);
+	TestEqual(TEXT("Sight radius squared"), EnemyRow.SightRadiusSquared, 1500.f * 1500.f);
+	TestNearlyEqual(TEXT("Peripheral vision cosine"), EnemyRow.CosPeripheralVision, .5f, 1e-5f);
+
+	// Editing an archetype recompiles its row in place, so actors holding the index see the new values.
+	EnemyArchetype->Stats.AttackRadius = 200.f;
+	Tables.Recompile(EnemyArchetype);
+
+	TestEqual(TEXT("Recompiled enemy row keeps its index"), Tables.FindOrCompile(EnemyArchetype), EnemyIndex);
+	TestEqual(TEXT("Recompiled attack radius"), Tables.GetEnemyRow(EnemyIndex).Stats.AttackRadius, 200.f);
+	TestEqual(TEXT("Recompiled attack radius squared"), Tables.GetEnemyRow(EnemyIndex).AttackRadiusSquared, 200.f * 200.f);
+
+	UWeaponArchetype* WeaponArchetype = NewObject<UWeaponArchetype>();
+	WeaponArchetype->Stats = MakeWeaponStats();
+
+	const int32 WeaponIndex = Tables.FindOrCompile(WeaponArchetype);
+
+	TestNotEqual(TEXT("Weapon archetype gets its own row"), WeaponIndex, 0);
+	TestTrue(TEXT("Weapon row holds the archetype's values"), StatsEqual(Tables.GetWeaponRow(WeaponIndex), WeaponArchetype->Stats));
+
+	WeaponArchetype->Stats.Damage = 50.f;
+	Tables.Recompile(WeaponArchetype);
+
+	TestEqual(TEXT("Recompiled weapon damage"), Tables.GetWeaponRow(WeaponIndex).Damage, 50.f);
+
+	UStaminaArchetype* StaminaArchetype = NewObject<UStaminaArchetype>();
+	StaminaArchetype->Stats = MakeStaminaStats();
+
+	const int32 StaminaIndex = Tables.FindOrCompile(StaminaArchetype);
+
+	TestNotEqual(TEXT("Stamina archetype gets its own row"), StaminaIndex, 0);
+	TestTrue(TEXT("Stamina row holds the archetype's values"), StatsEqual(Tables.GetStaminaRow(StaminaIndex), StaminaArchetype->Stats));
+
+	return true;
+}
+
+#if WITH_EDITORONLY_DATA
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCombatArchetypeMigrationTest, "SoulHunter.Combat.StatTables.DeprecatedPropertyMigration",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FCombatArchetypeMigrationTest::RunTest(const FString& Parameters)
+{
+	using namespace CombatStatTableTests;
+
+	UObject* Owner = NewObject<UEnemyArchetype>();
+
+	TestNull(TEXT("Values matching the template keep the template's archetype"), FCombatArchetypeMigration::Migrate(Owner, FEnemyStats(), FEnemyStats()));
+	TestNull(TEXT("Weapon values matching the template are left alone"), FCombatArchetypeMigration::Migrate(Owner, FWeaponStats(), FWeaponStats()));
+	TestNull(TEXT("Stamina values matching the template are left alone"), FCombatArchetypeMigration::Migrate(Owner, FStaminaStats(), FStaminaStats()));
+
+	// Overrides carry over exactly, including values the template had overridden itself.
+	const UEnemyArchetype* Enemy = FCombatArchetypeMigration::Migrate(Owner, MakeEnemyStats(), FEnemyStats());
+	const UWeaponArchetype* Weapon = FCombatArchetypeMigration::Migrate(Owner, MakeWeaponStats(), FWeaponStats());
+	const UStaminaArchetype* Stamina = FCombatArchetypeMigration::Migrate(Owner, MakeStaminaStats(), FStaminaStats());
+
+	if (!TestNotNull(TEXT("Enemy overrides migrate"), Enemy) ||
+		!TestNotNull(TEXT("Weapon overrides migrate"), Weapon) ||
+		!TestNotNull(TEXT("Stamina overrides migrate"), Stamina))
+		return false;
+
+	TestTrue(TEXT("Migrated archetype is saved with its owner"), Enemy->GetOuter() == Owner);
+	TestTrue(TEXT("Migrated enemy values"), StatsEqual(Enemy->Stats, MakeEnemyStats()));
+	TestTrue(TEXT("Migrated weapon values"), StatsEqual(Weapon->Stats, MakeWeaponStats()));
+	TestTrue(TEXT("Migrated stamina values"), StatsEqual(Stamina->Stats, MakeStaminaStats()));
+
+	FCombatStatTables& Tables = FCombatStatTables::Get();
+
+	TestTrue(TEXT("Migrated enemy archetype compiles to its values"), StatsEqual(Tables.GetEnemyRow(Tables.FindOrCompile(Enemy)).Stats, MakeEnemyStats()));
+	TestTrue(TEXT("Migrated weapon archetype compiles to its values"), StatsEqual(Tables.GetWeaponRow(Tables.FindOrCompile(Weapon)), MakeWeaponStats()));
+	TestTrue(TEXT("Migrated stamina archetype compiles to its values"), StatsEqual(Tables.GetStaminaRow(Tables.FindOrCompile(Stamina)), MakeStaminaStats()));
+
+	// The old sprint cost was spent every 0.05 s, the archetype's is per second.
+	const FFloatProperty* SprintCostProperty = FindFProperty<FFloatProperty>(UAttributeComponent::StaticClass(), TEXT("SprintCost_DEPRECATED"));
+
+	if (!TestNotNull(TEXT("Attribute component keeps the old sprint cost property"), SprintCostProperty))
+		return false;
+
+	TestEqual(TEXT("Old default sprint cost matches the per second default"), SprintCostProperty->GetPropertyValue_InContainer(GetDefault<UAttributeComponent>()) / .05f, FStaminaStats().SprintCost);
+
+	UAttributeComponent* Attributes = NewObject<UAttributeComponent>();
+
+	SprintCostProperty->SetPropertyValue_InContainer(Attributes, 1.f);
+	Attributes->PostLoad();
+
+	TestEqual(TEXT("Old sprint cost per tick migrates as cost per second"), Attributes->GetSprintCost(), 20.f);
+
+	return true;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Characters/HitDirection.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace HitDirectionTests
+{
+	struct FHitCase
+	{
+		const TCHAR* Name;
+		FVector Forward;
+		FVector Location;
+		FVector HitterLocation;
+		EHitReactDirection Expected;
+
+		/** Exactly on a band edge, where the Acos reference is at the mercy of rounding and the bands themselves decide. */
+		bool bOnEdge = false;
+	};
+
+	const TCHAR* DirectionName(EHitReactDirection Direction)
+	{
+		switch (Direction)
+		{
+		case EHitReactDirection::EHRD_Front: return TEXT("Front");
+		case EHitReactDirection::EHRD_Back: return TEXT("Back");
+		case EHitReactDirection::EHRD_Left: return TEXT("Left");
+		case EHitReactDirection::EHRD_Right: return TEXT("Right");
+		default: return TEXT("Unknown");
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHitDirectionFixedCasesTest, "SoulHunter.Combat.HitDirection.FixedCases",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHitDirectionFixedCasesTest::RunTest(const FString& Parameters)
+{
+	using HitDirectionTests::FHitCase;
+
+	const FVector Origin(100.f, -50.f, 90.f);
+	const FVector Forward = FVector::ForwardVector;
+
+	const TArray<FHitCase> Cases =
+	{
+		{ TEXT("Ahead"), Forward, Origin, Origin + FVector(150.f, 0.f, 0.f), EHitReactDirection::EHRD_Front },
+		{ TEXT("Behind"), Forward, Origin, Origin + FVector(-150.f, 0.f, 0.f), EHitReactDirection::EHRD_Back },
+		{ TEXT("Left"), Forward, Origin, Origin + FVector(0.f, -150.f, 0.f), EHitReactDirection::EHRD_Left },
+		{ TEXT("Right"), Forward, Origin, Origin + FVector(0.f, 150.f, 0.f), EHitReactDirection::EHRD_Right },
+		{ TEXT("Ahead and above"), Forward, Origin, Origin + FVector(150.f, 10.f, 400.f), EHitReactDirection::EHRD_Front },
+		{ TEXT("Behind and below"), Forward, Origin, Origin + FVector(-150.f, -10.f, -400.f), EHitReactDirection::EHRD_Back },
+		{ TEXT("Facing +Y, hit from +X"), FVector::RightVector, Origin, Origin + FVector(150.f, 0.f, 0.f), EHitReactDirection::EHRD_Left },
+
+		// The bands are [-45, 45) front, [-135, -45) left, [45, 135) right and the rest back, with negative angles on the left.
+		{ TEXT("Front-right edge"), Forward, Origin, Origin + FVector(100.f, 100.f, 0.f), EHitReactDirection::EHRD_Right, true },
+		{ TEXT("Front-left edge"), Forward, Origin, Origin + FVector(100.f, -100.f, 0.f), EHitReactDirection::EHRD_Front, true },
+		{ TEXT("Back-right edge"), Forward, Origin, Origin + FVector(-100.f, 100.f, 0.f), EHitReactDirection::EHRD_Back, true },
+		{ TEXT("Back-left edge"), Forward, Origin, Origin + FVector(-100.f, -100.f, 0.f), EHitReactDirection::EHRD_Left, true },
+
+		// Degenerate inputs land on the right, where the zero vector from GetSafeNormal put them.
+		{ TEXT("Hitter on the character"), Forward, Origin, Origin, EHitReactDirection::EHRD_Right },
+		{ TEXT("Hitter straight above"), Forward, Origin, Origin + FVector(0.f, 0.f, 200.f), EHitReactDirection::EHRD_Right },
+		{ TEXT("Hitter straight below"), Forward, Origin, Origin - FVector(0.f, 0.f, 200.f), EHitReactDirection::EHRD_Right },
+		{ TEXT("Zero forward"), FVector::ZeroVector, Origin, Origin + FVector(150.f, 0.f, 0.f), EHitReactDirection::EHRD_Right },
+		{ TEXT("Vertical forward"), FVector::UpVector, Origin, Origin + FVector(150.f, 0.f, 0.f), EHitReactDirection::EHRD_Right },
+		{ TEXT("Vertical forward, hitter above"), FVector::UpVector, Origin, Origin + FVector(0.f, 0.f, 150.f), EHitReactDirection::EHRD_Right },
+	};
+
+	TArray<FVector> Forwards;
+	TArray<FVector> Locations;
+	TArray<FVector> HitterLocations;
+
+	for (const FHitCase& Case : Cases)
+	{
+		Forwards.Add(Case.Forward);
+		Locations.Add(Case.Location);
+		HitterLocations.Add(Case.HitterLocation);
+	}
+
+	TArray<EHitReactDirection> Batched;
+	Batched.SetNumUninitialized(Cases.Num());
+	FHitDirectionClassifier::ClassifyBatch(Forwards, Locations, HitterLocations, Batched);
+
+	for (int32 Index = 0; Index < Cases.Num(); ++Index)
+	{
+		const FHitCase& Case = Cases[Index];
+		const EHitReactDirection Scalar = FHitDirectionClassifier::Classify(Case.Forward, Case.Location, Case.HitterLocation);
+
+		if (Scalar != Case.Expected)
+			AddError(FString::Printf(TEXT("%s: scalar gave %s, expected %s"), Case.Name, HitDirectionTests::DirectionName(Scalar), HitDirectionTests::DirectionName(Case.Expected)));
+
+		if (Batched[Index] != Case.Expected)
+			AddError(FString::Printf(TEXT("%s: batch gave %s, expected %s"), Case.Name, HitDirectionTests::DirectionName(Batched[Index]), HitDirectionTests::DirectionName(Case.Expected)));
+
+		if (Case.bOnEdge)
+			continue;
+
+		const EHitReactDirection Reference = FHitDirectionClassifier::ClassifyReference(Case.Forward, Case.Location, Case.HitterLocation);
+
+		if (Reference != Case.Expected)
+			AddError(FString::Printf(TEXT("%s: reference gave %s, expected %s"), Case.Name, HitDirectionTests::DirectionName(Reference), HitDirectionTests::DirectionName(Case.Expected)));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHitDirectionSweepTest, "SoulHunter.Combat.HitDirection.MatchesReference",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FHitDirectionSweepTest::RunTest(const FString& Parameters)
+{
+	TArray<FVector> Forwards;
+	TArray<FVector> Locations;
+	TArray<FVector> HitterLocations;
+
+	// Every half degree around the character, off the band edges, at a range of facings and heights.
+	for (int32 Facing = 0; Facing < 360; Facing += 15)
+	{
+		const FVector Forward = FRotator(0.f, Facing, 0.f).Vector();
+
+		for (int32 Degrees = -180; Degrees < 180; ++Degrees)
+		{
+			Forwards.Add(Forward);
+			Locations.Add(FVector(100.f, -50.f, 90.f));
+			HitterLocations.Add(Locations.Last() + FRotator(0.f, Facing + Degrees + .5f, 0.f).Vector() * 150.f + FVector(0.f, 0.f, Degrees));
+		}
+	}
+
+	// One more than a multiple of four, so the batch finishes on its scalar tail.
+	Forwards.Add(FVector::ForwardVector);
+	Locations.Add(FVector::ZeroVector);
+	HitterLocations.Add(FVector(0.f, 0.f, 100.f));
+
+	check(Forwards.Num() % 4 != 0);
+
+	TArray<EHitReactDirection> Batched;
+	Batched.SetNumUninitialized(Forwards.Num());
+	FHitDirectionClassifier::ClassifyBatch(Forwards, Locations, HitterLocations, Batched);
+
+	int32 ReferenceMismatches = 0;
+	int32 BatchMismatches = 0;
+
+	for (int32 Index = 0; Index < Forwards.Num(); ++Index)
+	{
+		const EHitReactDirection Reference = FHitDirectionClassifier::ClassifyReference(Forwards[Index], Locations[Index], HitterLocations[Index]);
+		const EHitReactDirection Scalar = FHitDirectionClassifier::Classify(Forwards[Index], Locations[Index], HitterLocations[Index]);
+
+		if (Scalar != Reference && ReferenceMismatches++ < 10)
+			AddError(FString::Printf(TEXT("Sample %d: scalar gave %s, reference %s"), Index, HitDirectionTests::DirectionName(Scalar), HitDirectionTests::DirectionName(Reference)));
+
+		if (Batched[Index] != Scalar && BatchMismatches++ < 10)
+			AddError(FString::Printf(TEXT("Sample %d: batch gave %s, scalar %s"), Index, HitDirectionTests::DirectionName(Batched[Index]), HitDirectionTests::DirectionName(Scalar)));
+	}
+
+	TestEqual(TEXT("Scalar mismatches against the reference"), ReferenceMismatches, 0);
+	TestEqual(TEXT("Batch mismatches against the scalar classifier"), BatchMismatches, 0);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Network/LagCompensationSubsystem.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRewindHistorySampleTest, "SoulHunter.Network.LagCompensation.RewindHistory",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FRewindHistorySampleTest::RunTest(const FString& Parameters)
+{
+	FRewindHistory History;
+	History.Init(8);
+
+	FVector Location;
+	TestFalse(TEXT("An empty history has nothing to sample"), History.Sample(0.0, Location));
+
+	// One unit per 0.1 s along X, twice as many frames as fit so the ring has wrapped.
+	for (int32 Frame = 0; Frame < 16; ++Frame)
+		History.Record(Frame * .1, FVector(Frame, 0.f, 0.f));
+
+	TestTrue(TEXT("A recorded history samples"), History.Sample(1.25, Location));
+	TestEqual(TEXT("Sampling between frames interpolates"), Location.X, 12.5, 1e-3);
+
+	History.Sample(1.1, Location);
+	TestEqual(TEXT("Sampling on a frame returns it"), Location.X, 11.0, 1e-3);
+
+	History.Sample(5.0, Location);
+	TestEqual(TEXT("Sampling after the newest frame clamps to it"), Location.X, 15.0, 1e-3);
+
+	History.Sample(0.3, Location);
+	TestEqual(TEXT("Sampling before the oldest kept frame clamps to it"), Location.X, 8.0, 1e-3);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRewindHistoryCapacityTest, "SoulHunter.Network.LagCompensation.HistoryCapacity",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FRewindHistoryCapacityTest::RunTest(const FString& Parameters)
+{
+	const double MaxRewind = .4;
+	const double SampleInterval = 1.0 / 60.0;
+
+	FRewindHistory History;
+	History.Init(FRewindHistory::GetCapacityFor(MaxRewind, SampleInterval));
+
+	TestTrue(TEXT("The capacity spans the rewind window"), (History.GetCapacity() - 1) * SampleInterval >= MaxRewind);
+
+	// Record a second of samples, then check the full window back from the newest one is still held, not clamped.
+	double Time = 0.0;
+
+	for (; Time <= 1.0; Time += SampleInterval)
+		History.Record(Time, FVector(Time * 100.0, 0.0, 0.0));
+
+	const double Newest = Time - SampleInterval;
+
+	FVector Location;
+	History.Sample(Newest - MaxRewind, Location);
+	TestEqual(TEXT("The oldest rewind time is still interpolated"), Location.X, (Newest - MaxRewind) * 100.0, 1e-2);
+
+	TestEqual(TEXT("A rewind window of zero still keeps two frames"), FRewindHistory::GetCapacityFor(0.0, SampleInterval), 2);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,221 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Items/LootTable.h"
+#include "Items/LootSubsystem.h"
+#include "Items/Soul.h"
+#include "Items/Treasure.h"
+#include "Tests/TestWorld.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace LootTableTests
+{
+	ULootTable* MakeTable(const TArray<float>& Weights)
+	{
+		ULootTable* Table = NewObject<ULootTable>();
+
+		for (const float Weight : Weights)
+		{
+			FLootEntry& Entry = Table->Entries.AddDefaulted_GetRef();
+			Entry.ItemClass = ASoul::StaticClass();
+			Entry.Weight = Weight;
+		}
+
+		return Table;
+	}
+
+	FLootEntry& AddGuaranteed(ULootTable* Table)
+	{
+		FLootEntry& Entry = Table->Entries.AddDefaulted_GetRef();
+		Entry.ItemClass = ATreasure::StaticClass();
+		Entry.MinAmount = 5;
+		Entry.MaxAmount = 10;
+		Entry.bGuaranteed = true;
+
+		return Entry;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLootTableFrequencyTest, "SoulHunter.Loot.Table.PickFrequencies",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FLootTableFrequencyTest::RunTest(const FString& Parameters)
+{
+	// Uneven weights, a zero weight and a guaranteed entry, so the alias table has slots to pair up and entries to skip.
+	const TArray<float> Weights = { 50.f, 25.f, 12.5f, 0.f, 7.5f, 5.f };
+
+	ULootTable* Table = LootTableTests::MakeTable(Weights);
+	LootTableTests::AddGuaranteed(Table);
+	Table->CompileAliasTable();
+
+	constexpr int32 NumPicks = 200000;
+
+	TArray<int32> Counts;
+	Counts.SetNumZeroed(Table->Entries.Num());
+
+	FRandomStream Stream(1234);
+
+	for (int32 Pick = 0; Pick < NumPicks; ++Pick)
+	{
+		const int32 EntryIndex = Table->PickEntry(Stream);
+
+		if (TestTrue(TEXT("Every pick lands on an entry"), Table->Entries.IsValidIndex(EntryIndex)))
+			++Counts[EntryIndex];
+		else
+			break;
+	}
+
+	float TotalWeight = 0.f;
+
+	for (const float Weight : Weights)
+		TotalWeight += Weight;
+
+	for (int32 EntryIndex = 0; EntryIndex < Weights.Num(); ++EntryIndex)
+	{
+		// Half a percentage point is more than five standard deviations at this many picks for every weight above.
+		const float Expected = Weights[EntryIndex] / TotalWeight;
+		const float Rolled = static_cast<float>(Counts[EntryIndex]) / NumPicks;
+
+		TestNearlyEqual(*FString::Printf(TEXT("Frequency of entry %d"), EntryIndex), Rolled, Expected, .005f);
+	}
+
+	TestEqual(TEXT("Zero-weight entries are never picked"), Counts[3], 0);
+	TestEqual(TEXT("Guaranteed entries are not picked by weight"), Counts.Last(), 0);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLootTableGuaranteedTest, "SoulHunter.Loot.Table.GuaranteedDrops",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FLootTableGuaranteedTest::RunTest(const FString& Parameters)
+{
+	ULootTable* Table = LootTableTests::MakeTable({ 1.f, 3.f });
+	Table->NumPicks = 2;
+
+	const FLootEntry& Guaranteed = LootTableTests::AddGuaranteed(Table);
+	Table->CompileAliasTable();
+
+	FRandomStream Stream(42);
+	TArray<FLootDrop> Drops;
+
+	for (int32 Roll = 0; Roll < 1000; ++Roll)
+	{
+		Drops.Reset();
+		Table->Roll(Stream, Drops, nullptr);
+
+		int32 NumGuaranteed = 0;
+
+		for (const FLootDrop& Drop : Drops)
+		{
+			if (Drop.ItemClass == ATreasure::StaticClass())
+			{
+				++NumGuaranteed;
+
+				if (Drop.Amount < Guaranteed.MinAmount || Drop.Amount > Guaranteed.MaxAmount)
+					AddError(FString::Printf(TEXT("Roll %d: guaranteed amount %d is outside its range"), Roll, Drop.Amount));
+			}
+		}
+
+		if (NumGuaranteed != 1 || Drops.Num() != 1 + Table->NumPicks)
+		{
+			AddError(FString::Printf(TEXT("Roll %d: %d guaranteed drops out of %d, expected 1 out of %d"),
+				Roll, NumGuaranteed, Drops.Num(), 1 + Table->NumPicks));
+			break;
+		}
+	}
+
+	// A table of only guaranteed entries still drops them, with nothing weighted to pick from.
+	ULootTable* GuaranteedOnly = LootTableTests::MakeTable({});
+	LootTableTests::AddGuaranteed(GuaranteedOnly);
+	GuaranteedOnly->CompileAliasTable();
+
+	Drops.Reset();
+	GuaranteedOnly->Roll(Stream, Drops, nullptr);
+
+	TestEqual(TEXT("Guaranteed-only table drops its entry"), Drops.Num(), 1);
+	TestEqual(TEXT("Nothing weighted to pick"), GuaranteedOnly->PickEntry(Stream), static_cast<int32>(INDEX_NONE));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLootStreamDeterminismTest, "SoulHunter.Loot.Subsystem.SeededStreams",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FLootStreamDeterminismTest::RunTest(const FString& Parameters)
+{
+	IConsoleVariable* SeedVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("sh.Loot.Seed"));
+
+	if (!TestNotNull(TEXT("sh.Loot.Seed exists"), SeedVariable))
+		return false;
+
+	const int32 PreviousSeed = SeedVariable->GetInt();
+	SeedVariable->Set(20240611, ECVF_SetByCode);
+
+	ULootTable* Table = LootTableTests::MakeTable({ 1.f, 1.f, 1.f, 1.f });
+	Table->NumPicks = 3;
+
+	for (int32 EntryIndex = 0; EntryIndex < Table->Entries.Num(); ++EntryIndex)
+	{
+		Table->Entries[EntryIndex].MinAmount = EntryIndex * 10;
+		Table->Entries[EntryIndex].MaxAmount = EntryIndex * 10 + 9;
+	}
+
+	Table->CompileAliasTable();
+
+	// Rolls a fresh world's first few drops for one source. The seed is read when the world starts.
+	auto RollWorld = [Table](TArray<int32>& OutAmounts)
+	{
+		FTestWorldScope TestWorld;
+		ULootSubsystem* LootSubsystem = ULootSubsystem::Get(TestWorld.World);
+
+		if (LootSubsystem == nullptr)
+			return false;
+
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.Name = TEXT("LootSource");
+
+		const AActor* Source = TestWorld.World->SpawnActor<AActor>(SpawnParameters);
+
+		for (int32 Roll = 0; Roll < 4; ++Roll)
+		{
+			FRandomStream Stream = LootSubsystem->MakeStream(Source);
+
+			TArray<FLootDrop> Drops;
+			Table->Roll(Stream, Drops, nullptr);
+
+			for (const FLootDrop& Drop : Drops)
+				OutAmounts.Add(Drop.Amount);
+		}
+
+		return true;
+	};
+
+	TArray<int32> FirstAmounts;
+	TArray<int32> SecondAmounts;
+
+	const bool bRolled = TestTrue(TEXT("First world has a loot subsystem"), RollWorld(FirstAmounts))
+		&& TestTrue(TEXT("Second world has a loot subsystem"), RollWorld(SecondAmounts));
+
+	SeedVariable->Set(PreviousSeed, ECVF_SetByCode);
+
+	if (!bRolled)
+		return false;
+
+	TestEqual(TEXT("Same seed and source give the same drops"), SecondAmounts, FirstAmounts);
+
+	// Each roll from the same source gets its own stream, so a source dropping twice does not repeat itself.
+	const TArray<int32> FirstRoll(FirstAmounts.GetData(), Table->NumPicks);
+	bool bAnyRollDiffers = false;
+
+	for (int32 Roll = 1; Roll < FirstAmounts.Num() / Table->NumPicks; ++Roll)
+		bAnyRollDiffers |= TArray<int32>(FirstAmounts.GetData() + Roll * Table->NumPicks, Table->NumPicks) != FirstRoll;
+
+	TestTrue(TEXT("Repeated rolls from one source differ"), bAnyRollDiffers);
+
+	return true;
+}
+
+#endif
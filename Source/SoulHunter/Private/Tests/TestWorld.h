@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/** A bare game world for automation tests: a physics scene and actors, but no game mode and no BeginPlay. */
+struct FTestWorldScope
+{
+	FTestWorldScope()
+	{
+		World = UWorld::CreateWorld(EWorldType::Game, false);
+		World->AddToRoot();
+
+		GEngine->CreateNewWorldContext(EWorldType::Game).SetCurrentWorld(World);
+	}
+
+	~FTestWorldScope()
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		World->RemoveFromRoot();
+	}
+
+	UWorld* World = nullptr;
+};
+
+#endif
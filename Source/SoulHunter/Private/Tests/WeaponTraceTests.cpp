@@ -0,0 +1,236 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Items/Weapons/Weapon.h"
+#include "Characters/CharacterNames.h"
+#include "Tests/TestWorld.h"
+#include "Components/BoxComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "HAL/MemoryBase.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace WeaponTraceTests
+{
+	/** Where the allocations of the current thread are counted, or null when it is not counting. */
+	thread_local int32* ThreadAllocationCount = nullptr;
+
+	/**
+	 * Forwards to the allocator it wraps and counts allocations on threads that are inside a FScopedAllocationCount.
+	 * Other threads may be in it at any time, so it is installed once and never removed or freed.
+	 */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FCountingMalloc(FMalloc* InInner) : Inner(InInner) {}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+				CountAllocation();
+
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+				CountAllocation();
+
+			return Inner->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("CountingMalloc"); }
+
+		/** Wraps GMalloc the first time it is called. Game thread only. */
+		static void Install()
+		{
+			check(IsInGameThread());
+
+			static FCountingMalloc* Installed = nullptr;
+
+			if (Installed == nullptr)
+			{
+				Installed = new FCountingMalloc(GMalloc);
+				GMalloc = Installed;
+			}
+		}
+
+	private:
+
+		FORCEINLINE static void CountAllocation()
+		{
+			if (int32* Count = ThreadAllocationCount)
+				++*Count;
+		}
+
+		FMalloc* Inner;
+	};
+
+	/** Counts the allocations the current thread makes while it is in scope, into OutCount. */
+	struct FScopedAllocationCount
+	{
+		explicit FScopedAllocationCount(int32& OutCount)
+			: Previous(ThreadAllocationCount)
+		{
+			FCountingMalloc::Install();
+
+			OutCount = 0;
+			ThreadAllocationCount = &OutCount;
+		}
+
+		~FScopedAllocationCount()
+		{
+			ThreadAllocationCount = Previous;
+		}
+
+		int32* Previous;
+	};
+
+	USceneComponent* FindComponentByName(AActor* Actor, FName Name)
+	{
+		TInlineComponentArray<USceneComponent*> Components(Actor);
+
+		for (USceneComponent* Component : Components)
+		{
+			if (Component->GetFName() == Name)
+				return Component;
+		}
+
+		return nullptr;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWeaponTraceAllocationTest, "SoulHunter.Combat.WeaponTrace.SteadyStateAllocations",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FWeaponTraceAllocationTest::RunTest(const FString& Parameters)
+{
+	using namespace WeaponTraceTests;
+
+	FTestWorldScope TestWorld;
+	UWorld* World = TestWorld.World;
+
+	// Owner and targets share the enemy tag, so the weapon traces and ignores what it hits but deals no damage. What is
+	// measured is the sweep and its bookkeeping, not the hit reactions.
+	AActor* WeaponOwner = World->SpawnActor<AActor>();
+	WeaponOwner->Tags.Add(CharacterNames::EnemyTag);
+
+	AWeapon* Weapon = World->SpawnActor<AWeapon>();
+	Weapon->SetOwner(WeaponOwner);
+
+	const FVector End(1000.f, 0.f, 0.f);
+	USceneComponent* TraceEnd = FindComponentByName(Weapon, TEXT("Box Trace End"));
+
+	if (!TestNotNull(TEXT("Weapon has a trace end"), TraceEnd))
+		return false;
+
+	TraceEnd->SetRelativeLocation(End);
+
+	// A row of blocking boxes along the sweep. Each trace hits the nearest one not yet ignored, like a swing cutting
+	// through a crowd, so the ignore set grows to its full size every swing.
+	constexpr int32 NumTargets = 5;
+
+	for (int32 Index = 0; Index < NumTargets; ++Index)
+	{
+		AActor* Target = World->SpawnActor<AActor>();
+		Target->Tags.Add(CharacterNames::EnemyTag);
+
+		UBoxComponent* Box = NewObject<UBoxComponent>(Target);
+		Box->SetBoxExtent(FVector(20.f));
+		Box->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		Box->SetWorldLocation(FVector(200.f + Index * 100.f, 0.f, 0.f));
+
+		Target->SetRootComponent(Box);
+		Box->RegisterComponent();
+	}
+
+	const FVector Start = FVector::ZeroVector;
+	const FCollisionShape Shape = FCollisionShape::MakeBox(Weapon->GetStats().BoxTraceExtent);
+
+	auto Swing = [Weapon]()
+	{
+		Weapon->ResetHitIgnoreActors();
+
+		for (int32 Trace = 0; Trace <= NumTargets; ++Trace)
+			Weapon->TraceHitWindow(FTransform::Identity);
+	};
+
+	// The same sweeps with the same ignore lists, made straight on the world, so whatever the physics scene allocates
+	// per query is not blamed on the weapon.
+	FCollisionQueryParams BareParams(SCENE_QUERY_STAT(WeaponTraceAllocationTest), false);
+	int32 NumBareHits = 0;
+
+	auto BareSwing = [&]()
+	{
+		BareParams.ClearIgnoredActors();
+		BareParams.AddIgnoredActor(Weapon);
+		BareParams.AddIgnoredActor(WeaponOwner);
+
+		for (int32 Trace = 0; Trace <= NumTargets; ++Trace)
+		{
+			FHitResult Hit;
+			World->SweepSingleByChannel(Hit, Start, End, FQuat::Identity, ECC_Visibility, Shape, BareParams);
+
+			if (AActor* HitActor = Hit.GetActor())
+			{
+				BareParams.AddIgnoredActor(HitActor);
+				++NumBareHits;
+			}
+		}
+	};
+
+	// The first swings compile the stat row and size the inline storage.
+	for (int32 Warmup = 0; Warmup < 4; ++Warmup)
+	{
+		Swing();
+		BareSwing();
+	}
+
+	TestEqual(TEXT("Every target is hit once per swing"), NumBareHits, 4 * NumTargets);
+
+	constexpr int32 NumSwings = 100;
+	int32 BareAllocations = 0;
+	int32 SwingAllocations = 0;
+
+	{
+		FScopedAllocationCount Count(BareAllocations);
+
+		for (int32 SwingIndex = 0; SwingIndex < NumSwings; ++SwingIndex)
+			BareSwing();
+	}
+
+	{
+		FScopedAllocationCount Count(SwingAllocations);
+
+		for (int32 SwingIndex = 0; SwingIndex < NumSwings; ++SwingIndex)
+			Swing();
+	}
+
+	AddInfo(FString::Printf(TEXT("%d swings: %d allocations, %d for the same bare sweeps"), NumSwings, SwingAllocations, BareAllocations));
+
+	TestEqual(TEXT("Steady-state swings allocate nothing outside the sweeps"), FMath::Max(SwingAllocations - BareAllocations, 0), 0);
+
+	return true;
+}
+
+#endif
@@ -5,25 +5,59 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Interfaces/HitInterface.h"
+#include "Interfaces/PersistentInterface.h"
 
 #include "BreakableActor.generated.h"
 
 class UGeometryCollectionComponent;
+class UGeometryCollection;
 class UCapsuleComponent;
+class UStaticMesh;
+class UStaticMeshComponent;
 
 UCLASS()
-class SOULHUNTER_API ABreakableActor : public AActor, public IHitInterface
+class SOULHUNTER_API ABreakableActor : public AActor, public IHitInterface, public IPersistentInterface
 {
 	GENERATED_BODY()
 	
 public:	
 	ABreakableActor();
-	virtual void Tick(float DeltaTime) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	virtual void GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter) override;
 
+	virtual FGuid GetPersistentGuid() const override;
+	virtual bool WritePersistentState(FActorStateRecord& OutRecord) const override;
+	virtual void ApplyPersistentState(const FActorStateRecord& Record) override;
+
+#pragma region Proxy
+
+	/** Replaces the static proxy with the geometry collection. Called before anything can break it; safe to call repeatedly. */
+	void SwapInGeometryCollection();
+
+	FORCEINLINE bool IsProxy() const { return bProxy; }
+
+#pragma endregion
+
+#pragma region Destruction Budget
+
+	/** Caps how deep the geometry collection breaks. Rebuilds its physics state, so only call it while intact. */
+	void SetCoarseFracture(bool bCoarse, int32 CoarseClusterLevel);
+
+	/** How many rigid pieces breaking at the current fracture level leaves simulating. */
+	int32 CountDebrisPieces() const;
+
+	void FreezeDebris();
+	void RemoveDebris();
+
+	FORCEINLINE bool IsBroken() const { return bBroken; }
+	FORCEINLINE bool IsCoarseFracture() const { return bCoarseFracture; }
+
+#pragma endregion
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	UPROPERTY(VisibleAnywhere)
 	UGeometryCollectionComponent* GeometryCollection;
@@ -31,8 +65,39 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 	UCapsuleComponent* CapsuleCollider;
 
+	/**
+	 * Stands in for the breakable until it is hit, placed at the actor's root. Used when both this and FracturedCollection
+	 * are set, in which case the geometry collection component should be left without a rest collection: it is only filled
+	 * in on the first hit. Its component is created at runtime, so breakables that do not use it carry nothing extra.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Breakable Properties")
+	UStaticMesh* ProxyStaticMesh;
+
+	UPROPERTY(EditAnywhere, Category = "Breakable Properties")
+	TSoftObjectPtr<UGeometryCollection> FracturedCollection;
+
+	UPROPERTY(Transient, BlueprintReadOnly)
+	UStaticMeshComponent* ProxyMesh;
+
 	UPROPERTY(EditAnywhere, Category = "Breakable Properties")
 	TArray<TSubclassOf<class ATreasure>>  TreasureClasses;
 
+	/** Rolled when broken. Takes over from TreasureClasses, which is only used when this is unset. */
+	UPROPERTY(EditAnywhere, Category = "Breakable Properties")
+	class ULootTable* LootTable;
+
+	UFUNCTION()
+	void OnRep_Broken();
+
+	UPROPERTY(ReplicatedUsing = OnRep_Broken)
 	bool bBroken = false;
+
+private:
+	mutable FGuid PersistentGuid;
+
+	void EnterProxyMode();
+
+	int32 FullClusterLevel = 0;
+	bool bCoarseFracture = false;
+	bool bProxy = false;
 };
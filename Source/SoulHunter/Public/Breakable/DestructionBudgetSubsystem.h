@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "DestructionBudgetSubsystem.generated.h"
+
+class ABreakableActor;
+
+/**
+ * Bounds what breaking a room full of pots costs. Breakables far from the local view (or all of them while the piece
+ * budget is under pressure) are switched to a coarse fracture level before they are hit, so they break into fewer
+ * pieces. Broken debris is frozen once it has settled, is far away, or when the number of simulated pieces goes over
+ * sh.Destruction.MaxActivePieces (oldest first), and is removed after sh.Destruction.DebrisLifetime.
+ */
+UCLASS()
+class SOULHUNTER_API UDestructionBudgetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+#pragma region Main
+
+	static UDestructionBudgetSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void Register(ABreakableActor* Breakable);
+	void Unregister(ABreakableActor* Breakable);
+	void NotifyBroken(ABreakableActor* Breakable);
+
+	void LogReport() const;
+
+#pragma endregion
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+#pragma region Fracture Level
+
+	void UpdateFractureLevels();
+	bool GetViewLocation(FVector& OutLocation) const;
+
+	TArray<TWeakObjectPtr<ABreakableActor>> IntactBreakables;
+	float FractureLevelTimer = 0.f;
+
+#pragma endregion
+
+#pragma region Debris
+
+	struct FDebris
+	{
+		TWeakObjectPtr<ABreakableActor> Breakable;
+		double BreakTime = 0.0;
+		int32 NumPieces = 0;
+		bool bFrozen = false;
+	};
+
+	void UpdateDebris();
+	void FreezeDebris(FDebris& Debris);
+
+	/** Oldest first. */
+	TArray<FDebris> Debris;
+	int32 ActivePieces = 0;
+
+#pragma endregion
+
+#pragma region Stats
+
+	int32 PeakActivePieces = 0;
+	int32 NumBroken = 0;
+	int32 NumCoarseBreaks = 0;
+	int32 NumSettledFreezes = 0;
+	int32 NumDistanceFreezes = 0;
+	int32 NumBudgetFreezes = 0;
+	int32 NumRemoved = 0;
+
+#pragma endregion
+
+};
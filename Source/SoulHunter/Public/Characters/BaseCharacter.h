@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Interfaces/HitInterface.h"
+#include "Characters/CharacterType.h"
 #include "GameFramework/Character.h"
 #include "Engine/SkeletalMesh.h"
 
@@ -26,13 +27,16 @@ public:
 
 #pragma region Main
 
-	ABaseCharacter();
-	virtual void Tick(float DeltaTime) override;
+	ABaseCharacter(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	// IHitInterface
 	virtual void GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter) override;
 
+	/** Soft assets that should be resident before this class is spawned. Called on the class default object. */
+	virtual void GatherPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const;
+
 #pragma endregion
 
 #pragma region Combat
@@ -40,6 +44,18 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void SetWeaponCollisionEnabled(ECollisionEnabled::Type CollisionEnabled);
 
+	/** Owning client only. Plays the hit reaction, sound and particles for a hit the server has not confirmed yet. */
+	void PlayPredictedHitEffects(const FVector& ImpactPoint, const AActor* Hitter);
+
+	/** Undoes a predicted hit reaction after the server rejected Hitter's hit. */
+	void CancelPredictedHitEffects(const AActor* Hitter);
+
+	/** Plays the hit reaction on every living character of a crowd hit, classifying their directions in one batch. */
+	static void PlayCrowdHitReactions(TConstArrayView<ABaseCharacter*> HitCharacters, const FVector& HitterLocation);
+
+	/** While set, GetHit leaves the hit reaction to PlayCrowdHitReactions. Set by weapons around hits they batch. */
+	FORCEINLINE void SetHitReactDeferred(bool bDeferred) { bHitReactDeferred = bDeferred; }
+
 #pragma endregion
 
 protected:
@@ -47,12 +63,14 @@ protected:
 #pragma region Main
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void OnPreloadAssetsLoaded() {}
 	virtual void Death(const FVector& ImpactPoint);
 	void StartRagdoll(const FVector& ImpactPoint, const float& ImpulseStrenght);
 	bool IsAlive();
 
 	UPROPERTY(EditDefaultsOnly, Category = "Montages")
-	UAnimMontage* DeathMontage;
+	TSoftObjectPtr<UAnimMontage> DeathMontage;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Combat")
 	FName RagdollBaseBone = FName("pelvis");
@@ -64,9 +82,11 @@ protected:
 	UPROPERTY(VisibleAnywhere)
 	UAttributeComponent* Attributes;
 
-	UPROPERTY(VisibleAnywhere, Category = Weapon)
+	UPROPERTY(VisibleAnywhere, Replicated, Category = Weapon)
 	AWeapon* EquippedWeapon;
 
+	void SetEquippedWeapon(AWeapon* Weapon);
+
 	UPROPERTY(EditAnywhere, Category = Weapon, meta = (GetOptions = "GetSocketNames"))
 	FName WeaponSocket;
 
@@ -88,10 +108,33 @@ protected:
 	virtual bool CanAttack() PURE_VIRTUAL(ABaseCharacter::Attack, return false;);
 
 	void DirectionalHitReact(const FVector& ImpactPoint);
-	void PlayHitReactMontage(const FName& SectionName);
+	EHitReactDirection GetHitReactDirection(const FVector& ImpactPoint) const;
+	void PlayHitReactMontage(EHitReactDirection Direction);
 	void PlayHitSound(const FVector& ImpactPoint);
 	void SpawnHitParticles(const FVector& ImpactPoint);
 
+	/** Replays the hit reaction, sound and particles the server played in GetHit on every client. */
+	UFUNCTION(NetMulticast, Unreliable)
+	void Multicast_HitEffects(FVector_NetQuantize ImpactPoint, FVector_NetQuantize HitterLocation, AActor* Hitter, bool bHitReact);
+
+	/** Where the last hit came from, on every machine. Used to push the ragdoll away from the killer. */
+	FVector LastHitterLocation = FVector::ZeroVector;
+
+	/** A hit this machine predicted on this character. Each one swallows the server's confirmation of the same attacker's hit. */
+	struct FPredictedHit
+	{
+		TWeakObjectPtr<const AActor> Hitter;
+		double Time = 0.0;
+	};
+
+	bool ConsumePredictedHit(const AActor* Hitter);
+
+	TArray<FPredictedHit, TInlineAllocator<2>> PredictedHits;
+
+	bool bHitReactDeferred = false;
+
+	static constexpr double PredictedHitConfirmWindow = 1.0;
+
 	void StopAttackMontage();
 
 	UFUNCTION(BlueprintCallable)
@@ -109,10 +152,10 @@ protected:
 	int32 LastSelectedAttackMontageSection = -1;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Combat")
-	UAnimMontage* AttackMontage;
+	TSoftObjectPtr<UAnimMontage> AttackMontage;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Combat")
-	UAnimMontage* HitReactionMontage;
+	TSoftObjectPtr<UAnimMontage> HitReactionMontage;
 
 #pragma endregion
 
@@ -120,6 +163,11 @@ protected:
 
 	int32 PlayMontageRandomSection(UAnimMontage* AnimationMontage);
 	int32 PlayMontageRandomSection(UAnimMontage* AnimationMontage, int32& LastSelectedIndex);
+	void PlayMontageSection(UAnimMontage* AnimationMontage, const FName& SectionName);
+
+	/** Plays a montage the server or owning client already started on everyone else. */
+	UFUNCTION(NetMulticast, Unreliable)
+	void Multicast_PlayMontageSection(UAnimMontage* AnimationMontage, FName SectionName);
 
 #pragma endregion
 
@@ -134,5 +182,10 @@ private:
 	UParticleSystem* HitParticles;
 
 #pragma endregion
+
+public:
+
+	FORCEINLINE UAttributeComponent* GetAttributes() const { return Attributes; }
+	FORCEINLINE AWeapon* GetEquippedWeapon() const { return EquippedWeapon; }
 	
 };
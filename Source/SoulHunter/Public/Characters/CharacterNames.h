@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Characters/CharacterType.h"
+
+/** Names used on the combat paths, hashed once at startup instead of on every attack, hit and equip. */
+namespace CharacterNames
+{
+	inline const FName RightHandSocket(TEXT("RightHandSocket"));
+	inline const FName SpineSocket(TEXT("SpineSocket"));
+	inline const FName TargetWidgetSocket(TEXT("TargetWidgetSocket"));
+
+	inline const FName ArmSection(TEXT("Arm"));
+	inline const FName DisarmSection(TEXT("Disarm"));
+
+	inline const FName DeadTag(TEXT("Dead"));
+	inline const FName EnemyTag(TEXT("Enemy"));
+	inline const FName EngageableTargetTag(TEXT("EngageableTarget"));
+
+	inline const FName HitReactSections[static_cast<int32>(EHitReactDirection::Count)] =
+	{
+		FName(TEXT("ReactFromFront")),
+		FName(TEXT("ReactFromBack")),
+		FName(TEXT("ReactFromLeft")),
+		FName(TEXT("ReactFromRight"))
+	};
+
+	FORCEINLINE const FName& GetHitReactSection(EHitReactDirection Direction)
+	{
+		return HitReactSections[static_cast<int32>(Direction)];
+	}
+}
@@ -37,4 +37,15 @@ enum class EEnemyState : uint8
 	EES_Chasing UMETA(DisplayName = "Chasing"),
 	EES_Attacking UMETA(DisplayName = "Attacking"),
 	EES_Engaged UMETA(DisplayName = "Engaged")
-};
\ No newline at end of file
+};
+
+UENUM(BlueprintType)
+enum class EHitReactDirection : uint8
+{
+	EHRD_Front UMETA(DisplayName = "Front"),
+	EHRD_Back UMETA(DisplayName = "Back"),
+	EHRD_Left UMETA(DisplayName = "Left"),
+	EHRD_Right UMETA(DisplayName = "Right"),
+
+	Count UMETA(Hidden)
+};
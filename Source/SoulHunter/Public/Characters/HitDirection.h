@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Characters/CharacterType.h"
+
+/**
+ * Picks the hit reaction section from where a hit came from, using the same bands as before (front and back within 45
+ * degrees of the facing, left and right in between) but without trigonometry: the bands are compared as squared dot
+ * products against the squared planar distance, and the cross product only decides the side. Crowd hits can classify
+ * any number of characters at once, four per SIMD register.
+ */
+struct SOULHUNTER_API FHitDirectionClassifier
+{
+	static EHitReactDirection Classify(const FVector& Forward, const FVector& Location, const FVector& HitterLocation);
+
+	/** Classifies Forwards[i] / Locations[i] against HitterLocations[i]. All four views must have the same length. */
+	static void ClassifyBatch(
+		TConstArrayView<FVector> Forwards,
+		TConstArrayView<FVector> Locations,
+		TConstArrayView<FVector> HitterLocations,
+		TArrayView<EHitReactDirection> OutDirections);
+
+	/** The original Acos classification, kept to check and time the fast paths against. */
+	static EHitReactDirection ClassifyReference(const FVector& Forward, const FVector& Location, const FVector& HitterLocation);
+};
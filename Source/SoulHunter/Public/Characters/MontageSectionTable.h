@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UAnimMontage;
+
+/**
+ * Section names of a montage, read once per asset and shared by every character playing it, so picking and jumping to
+ * a section costs an array lookup.
+ */
+struct SOULHUNTER_API FMontageSectionTable
+{
+	static const FMontageSectionTable& Get(const UAnimMontage* Montage);
+
+	/** Uniform pick in constant time. With more than one section, never returns ExcludedIndex. */
+	int32 PickRandomSection(int32 ExcludedIndex = INDEX_NONE) const;
+
+	FORCEINLINE int32 Num() const { return SectionNames.Num(); }
+	FORCEINLINE bool IsValidIndex(int32 Index) const { return SectionNames.IsValidIndex(Index); }
+	FORCEINLINE FName GetSectionName(int32 Index) const { return IsValidIndex(Index) ? SectionNames[Index] : NAME_None; }
+
+private:
+
+	TArray<FName> SectionNames;
+};
@@ -22,6 +22,8 @@ class UAnimMontage;
 class ASoul;
 class ATreasure;
 class ULockOnTargetComponent;
+class UTargetComponent;
+class USoulHunterMovementComponent;
 
 #pragma endregion
 
@@ -34,10 +36,12 @@ public:
 
 #pragma region Main
 
-	APlayerCharacter();
-	virtual void Tick(float DeltaTime) override;
-	float TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
+	APlayerCharacter(const FObjectInitializer& ObjectInitializer);
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
+	virtual void PawnClientRestart() override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void PostLoad() override;
+	virtual void PossessedBy(AController* NewController) override;
 	virtual void Jump() override;
 
 	virtual void GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter) override;
@@ -47,15 +51,44 @@ public:
 
 #pragma endregion
 
+#pragma region Network
+
+	/**
+	 * Hits are detected by the owning client and validated by the server before any damage is dealt. ViewTime is the
+	 * server time the client was seeing when it detected the hit, used to rewind the target.
+	 */
+	UFUNCTION(Server, Reliable)
+	void Server_ReportWeaponHit(AWeapon* Weapon, AActor* HitActor, FVector_NetQuantize ImpactPoint, double ViewTime);
+
+	/** Tells the owning client a hit it predicted was rejected, so the predicted reaction can be undone. */
+	UFUNCTION(Client, Reliable)
+	void Client_RejectWeaponHit(AActor* HitActor);
+
+#pragma endregion
+
+#pragma region Movement
+
+	/** Checked by the movement component before it commits to a dodge, on the owning client and again on the server. */
+	bool CanDodge();
+
+	/** Plays the dodge once the movement component has turned the character and spent the stamina. */
+	void PerformDodge();
+
+#pragma endregion
+
 protected:
 
 #pragma region Main
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Death(const FVector& ImpactPoint) override;
 	void DropWeapon();
 	UFUNCTION(BlueprintCallable) void BackToUnoccupiedState();
 
+	/** ActionState is push-replicated, so every write goes through here to mark it dirty. */
+	UFUNCTION(BlueprintCallable) void SetActionState(EActionState NewState);
+
 #pragma endregion
 
 #pragma region Input
@@ -63,6 +96,7 @@ protected:
 	void Move(const FInputActionValue& Value);
 	void Look(const FInputActionValue& Value);
 	void InteractKeyPressed();
+	void Interact();
 
 	void EquipWeapon(AWeapon* OverlappingWeapon);
 
@@ -115,9 +149,6 @@ protected:
 	void EndSprinting();
 	bool HasEnoughStamina(float StaminaToUse);
 
-	UFUNCTION()
-	void DepleteStaminaFromSprinting(float StaminaToDeplete);
-
 	void ToggleLockOnTarget();
 	void LockOnRight();
 	void LockOnLeft();
@@ -128,28 +159,41 @@ protected:
 	UFUNCTION()
 	void OnTargetUnlocked(class UTargetComponent* Target, FName Socket);
 
-	FTimerDelegate SprintingTimerDelegate;
-	FTimerHandle SprintingTimer;
+	UFUNCTION(Server, Reliable)
+	void Server_Attack(int32 SectionIndex);
+
+	UFUNCTION(Server, Reliable)
+	void Server_Interact();
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = TargetLock)
 	ULockOnTargetComponent* LockOnTarget;
 
+	TWeakObjectPtr<UTargetComponent> LockedTarget;
+
 #pragma endregion
 
 private:
 
 #pragma region Main
 
+	void SetCharacterState(ECharacterState NewState);
+
+	UFUNCTION()
+	void OnRep_ActionState();
+
+	UPROPERTY(Replicated)
 	ECharacterState CharacterState = ECharacterState::ECS_Unequipped;
 
-	UPROPERTY(BlueprintReadWrite, meta = (AllowPrivateAccess = "true"))
+	UPROPERTY(BlueprintReadOnly, ReplicatedUsing = OnRep_ActionState, meta = (AllowPrivateAccess = "true"))
 	EActionState ActionState = EActionState::EAS_Unoccupied;
 
 #pragma endregion
 
 #pragma region Main Components
 
+	void InitializeLocalPlayer();
 	void InitializePlayerOverlay(APlayerController* PlayerController);
+	void RefreshPlayerOverlay();
 
 	UPROPERTY(VisibleAnywhere)
 	USpringArmComponent* SpringArm;
@@ -157,6 +201,12 @@ private:
 	UPROPERTY(VisibleAnywhere)
 	UCameraComponent* ViewCamera;
 
+	UPROPERTY(VisibleAnywhere)
+	USoulHunterMovementComponent* SoulHunterMovement;
+
+	UPROPERTY(VisibleAnywhere)
+	class UPickupCollectorComponent* PickupCollector;
+
 	UPROPERTY(VisibleInstanceOnly)
 	AItem* OverlappingItem;
 
@@ -165,17 +215,6 @@ private:
 
 #pragma endregion
 
-#pragma region Movement
-
-	UPROPERTY(EditAnywhere, Category = Movement)
-	float RunningSpeed = 500.f;
-
-	UPROPERTY(EditAnywhere, Category = Movement)
-	float SprintingSpeed = 800.f;
-
-#pragma endregion
-
-
 #pragma region Montages
 
 	UPROPERTY(EditDefaultsOnly, Category = "Montages")
@@ -186,6 +225,22 @@ private:
 
 #pragma endregion
 
+	/** Server. The key this player's attributes are saved under, kept from possession so EndPlay can still capture them. */
+	FString PlayerSaveKey;
+
+#if WITH_EDITORONLY_DATA
+
+	// Replaced by the movement component's MaxWalkSpeed and MaxSprintSpeed. Loaded from old assets and levels and moved
+	// onto the movement component in PostLoad.
+
+	UPROPERTY()
+	float RunningSpeed_DEPRECATED = 500.f;
+
+	UPROPERTY()
+	float SprintingSpeed_DEPRECATED = 800.f;
+
+#endif
+
 public:
 
 #pragma region Getters/Setters
@@ -193,6 +248,7 @@ public:
 	UFUNCTION(BlueprintCallable) FORCEINLINE ECharacterState GetCharacterState() const { return CharacterState; }
 
 	FORCEINLINE bool IsUnoccupied() const { return ActionState == EActionState::EAS_Unoccupied; }
+	FORCEINLINE UTargetComponent* GetLockedTarget() const { return LockedTarget.Get(); }
 
 #pragma endregion
 	
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimNotifies/AnimNotifyState.h"
+
+#include "AnimNotifyState_WeaponHitWindow.generated.h"
+
+class AWeapon;
+
+/**
+ * The part of an attack montage in which the equipped weapon hits. When the montage is saved or cooked, the trajectory of
+ * the socket the weapon is held by is sampled from the animation, so during the window the weapon sweeps along cached
+ * transforms, several per frame when the swing is fast, instead of reading bones or waiting for its box to overlap. The
+ * bake records the animations it sampled, and loading it in the editor re-bakes when any of them has changed since.
+ * Replaces toggling weapon collision from Blueprint notifies.
+ */
+UCLASS(meta = (DisplayName = "Weapon Hit Window"))
+class SOULHUNTER_API UAnimNotifyState_WeaponHitWindow : public UAnimNotifyState
+{
+	GENERATED_BODY()
+
+public:
+	UAnimNotifyState_WeaponHitWindow();
+
+	virtual void NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration, const FAnimNotifyEventReference& EventReference) override;
+	virtual void NotifyTick(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float FrameDeltaTime, const FAnimNotifyEventReference& EventReference) override;
+
+	virtual FString GetNotifyName_Implementation() const override;
+
+#if WITH_EDITOR
+	virtual void PostLoad() override;
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+#endif
+
+private:
+	/** The weapon socket in component space at Time, a montage position inside the window. False if nothing was baked. */
+	bool SampleTrajectory(float Time, FTransform& OutSocketTransform) const;
+
+	static AWeapon* GetDetectingWeapon(const USkeletalMeshComponent* MeshComp);
+
+#if WITH_EDITOR
+	void BakeTrajectory();
+
+	/** Raw data GUIDs of the sequences the window covers, in montage order. Empty if the notify is not on a montage. */
+	void GetTrajectorySourceGuids(TArray<FGuid>& OutGuids) const;
+#endif
+
+	/** Socket the weapon is held by during the attack. */
+	UPROPERTY(EditAnywhere, Category = "Hit Window")
+	FName WeaponSocket;
+
+	/** Sweeps a single frame may be split into, so fast swings do not skip past what they should hit. */
+	UPROPERTY(EditAnywhere, Category = "Hit Window", meta = (ClampMin = "1", ClampMax = "8"))
+	int32 MaxSweepsPerFrame = 4;
+
+	UPROPERTY()
+	TArray<FTransform> Trajectory;
+
+	UPROPERTY()
+	float TrajectoryStartTime = 0.f;
+
+#if WITH_EDITORONLY_DATA
+	/** GetTrajectorySourceGuids as of the last bake. */
+	UPROPERTY()
+	TArray<FGuid> TrajectorySourceGuids;
+#endif
+
+	static constexpr float SampleInterval = 1.f / 60.f;
+};
@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+
+#include "CombatArchetypes.generated.h"
+
+USTRUCT(BlueprintType)
+struct FEnemyStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Sensing")
+	float PawnSightRadius = 2000.f;
+
+	UPROPERTY(EditAnywhere, Category = "Sensing")
+	float PawnPeripheralVisionAngle = 45.f;
+
+	UPROPERTY(EditAnywhere, Category = "Patrol")
+	float PatrollingSpeed = 125.f;
+
+	UPROPERTY(EditAnywhere, Category = "Patrol")
+	float PatrolRadius = 200.f;
+
+	UPROPERTY(EditAnywhere, Category = "Patrol")
+	float AcceptanceRadius = 40.f;
+
+	UPROPERTY(EditAnywhere, Category = "Patrol")
+	float PatrolWaitingTimeMin = 4.f;
+
+	UPROPERTY(EditAnywhere, Category = "Patrol")
+	float PatrolWaitingTimeMax = 10.f;
+
+	UPROPERTY(EditAnywhere, Category = "Combat")
+	float ChasingSpeed = 350.f;
+
+	UPROPERTY(EditAnywhere, Category = "Combat")
+	float CombatRadius = 500.f;
+
+	UPROPERTY(EditAnywhere, Category = "Combat")
+	float AttackRadius = 135.f;
+
+	UPROPERTY(EditAnywhere, Category = "Combat")
+	float AttackWaitingTimeMin = .5f;
+
+	UPROPERTY(EditAnywhere, Category = "Combat")
+	float AttackWaitingTimeMax = 1.f;
+
+	UPROPERTY(EditAnywhere, Category = "Combat")
+	float DeathLifeSpan = 30.f;
+};
+
+USTRUCT(BlueprintType)
+struct FWeaponStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Weapon")
+	float Damage = 20.f;
+
+	UPROPERTY(EditAnywhere, Category = "Weapon")
+	FVector BoxTraceExtent = FVector(15.f);
+
+	/** How far from its owner a client may claim to have hit something, on top of the target's own radius. */
+	UPROPERTY(EditAnywhere, Category = "Network")
+	float MaxReportedHitDistance = 300.f;
+
+	UPROPERTY(EditAnywhere, Category = "Network")
+	float MaxSwingDuration = 1.5f;
+};
+
+USTRUCT(BlueprintType)
+struct FStaminaStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Stamina")
+	float DodgeCost = 15.f;
+
+	/** Stamina per second spent while sprinting. */
+	UPROPERTY(EditAnywhere, Category = "Stamina")
+	float SprintCost = 10.f;
+
+	UPROPERTY(EditAnywhere, Category = "Stamina")
+	float StaminaRegenRate = 8.f;
+};
+
+/**
+ * Tuning shared by every enemy of one kind. Compiled into FCombatStatTables the first time an enemy uses it, and again
+ * whenever it is edited, so balancing changes show up in a running PIE session.
+ */
+UCLASS(BlueprintType)
+class SOULHUNTER_API UEnemyArchetype : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(EditAnywhere, Category = "Enemy", meta = (ShowOnlyInnerProperties))
+	FEnemyStats Stats;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+};
+
+UCLASS(BlueprintType)
+class SOULHUNTER_API UWeaponArchetype : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(EditAnywhere, Category = "Weapon", meta = (ShowOnlyInnerProperties))
+	FWeaponStats Stats;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+};
+
+UCLASS(BlueprintType)
+class SOULHUNTER_API UStaminaArchetype : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(EditAnywhere, Category = "Stamina", meta = (ShowOnlyInnerProperties))
+	FStaminaStats Stats;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+};
+
+#if WITH_EDITORONLY_DATA
+
+/**
+ * Carries tuning that was set on the per-instance properties the archetypes replaced. Those properties are kept as
+ * _DEPRECATED so old assets and levels still load their values; PostLoad hands them here together with the values of the
+ * object's template. When they differ, the object gets its own archetype holding them, which is saved with the object
+ * on its next resave (the deprecated values are not). When they match, the template's archetype still applies.
+ */
+struct SOULHUNTER_API FCombatArchetypeMigration
+{
+	static UEnemyArchetype* Migrate(UObject* Owner, const FEnemyStats& Legacy, const FEnemyStats& TemplateLegacy);
+	static UWeaponArchetype* Migrate(UObject* Owner, const FWeaponStats& Legacy, const FWeaponStats& TemplateLegacy);
+	static UStaminaArchetype* Migrate(UObject* Owner, const FStaminaStats& Legacy, const FStaminaStats& TemplateLegacy);
+};
+
+#endif
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Combat/CombatArchetypes.h"
+#include "UObject/ObjectKey.h"
+
+/** An enemy archetype as the AI reads it: the tuned values plus the squares and cosines it compares against. */
+struct FEnemyStatRow
+{
+	FEnemyStats Stats;
+
+	float PatrolRadiusSquared = 0.f;
+	float CombatRadiusSquared = 0.f;
+	float AttackRadiusSquared = 0.f;
+	float SightRadiusSquared = 0.f;
+	float CosPeripheralVision = 1.f;
+};
+
+/**
+ * Flat, read-only rows compiled from the combat archetype assets, one per asset and shared by every actor using it.
+ * Actors keep a row index instead of their own copy of the tuning. Row 0 of each table holds the C++ defaults, used by
+ * actors without an archetype. Rows are recompiled in place when an asset is edited, so indices stay valid.
+ */
+struct SOULHUNTER_API FCombatStatTables
+{
+	static FCombatStatTables& Get();
+
+	int32 FindOrCompile(const UEnemyArchetype* Archetype);
+	int32 FindOrCompile(const UWeaponArchetype* Archetype);
+	int32 FindOrCompile(const UStaminaArchetype* Archetype);
+
+	void Recompile(const UEnemyArchetype* Archetype);
+	void Recompile(const UWeaponArchetype* Archetype);
+	void Recompile(const UStaminaArchetype* Archetype);
+
+	FORCEINLINE const FEnemyStatRow& GetEnemyRow(int32 Index) const { return EnemyRows[Index]; }
+	FORCEINLINE const FWeaponStats& GetWeaponRow(int32 Index) const { return WeaponRows[Index]; }
+	FORCEINLINE const FStaminaStats& GetStaminaRow(int32 Index) const { return StaminaRows[Index]; }
+
+	void LogReport() const;
+
+private:
+
+	FCombatStatTables();
+
+	static FEnemyStatRow CompileEnemyRow(const FEnemyStats& Stats);
+
+	TArray<FEnemyStatRow> EnemyRows;
+	TArray<FWeaponStats> WeaponRows;
+	TArray<FStaminaStats> StaminaRows;
+
+	TMap<TObjectKey<UEnemyArchetype>, int32> EnemyIndices;
+	TMap<TObjectKey<UWeaponArchetype>, int32> WeaponIndices;
+	TMap<TObjectKey<UStaminaArchetype>, int32> StaminaIndices;
+};
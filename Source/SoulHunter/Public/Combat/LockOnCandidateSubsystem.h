@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "LockOnCandidateSubsystem.generated.h"
+
+class AEnemy;
+class APlayerController;
+class UTargetComponent;
+
+/** A candidate as the target handler scores it, projected for one controller's view. */
+struct FLockOnCandidateView
+{
+	UTargetComponent* Target = nullptr;
+	FVector Location = FVector::ZeroVector;
+
+	/** Normalized screen position, (0, 0) top left and (1, 1) bottom right. */
+	FVector2D ScreenPosition = FVector2D::ZeroVector;
+	float DistanceSquared = 0.f;
+};
+
+/**
+ * The enemies that can currently be locked on to, bucketed in a 2D grid. Enemies add themselves when they become
+ * targetable and remove themselves when they die or go back to the pool, so the lock-on handler never has to scan or
+ * filter every target in the world. Queries are projected to the screen once per frame and controller, so switching
+ * targets repeatedly in the same frame reuses the projections.
+ */
+UCLASS()
+class SOULHUNTER_API ULockOnCandidateSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+#pragma region Main
+
+	static ULockOnCandidateSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void AddCandidate(AEnemy* Enemy);
+	void RemoveCandidate(AEnemy* Enemy);
+
+	/** Candidates within Radius of Origin that are on the controller's screen. Valid until the next call. */
+	TConstArrayView<FLockOnCandidateView> GetScreenCandidates(const APlayerController* PlayerController, const FVector& Origin, float Radius);
+
+	void RecordQuery(double Seconds) const;
+	void LogReport() const;
+
+#pragma endregion
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+#pragma region Grid
+
+	static constexpr float CellSize = 1000.f;
+
+	struct FCandidate
+	{
+		TWeakObjectPtr<AEnemy> Enemy;
+		UTargetComponent* Target = nullptr;
+		FIntPoint Cell;
+	};
+
+	FORCEINLINE static FIntPoint GetCell(const FVector& Location)
+	{
+		return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+	}
+
+	void RemoveFromCell(int32 CandidateIndex, const FIntPoint& Cell);
+
+	TSparseArray<FCandidate> Candidates;
+	TMap<TObjectKey<AEnemy>, int32> CandidateIndices;
+	TMap<FIntPoint, TArray<int32>> Cells;
+
+#pragma endregion
+
+#pragma region Projection Cache
+
+	TArray<FLockOnCandidateView> CachedViews;
+	TWeakObjectPtr<const APlayerController> CachedController;
+	uint64 CachedFrame = 0;
+	FVector CachedOrigin = FVector::ZeroVector;
+	float CachedRadius = 0.f;
+	bool bCacheValid = false;
+
+	mutable int64 NumQueries = 0;
+	mutable double QuerySeconds = 0.0;
+	mutable double MaxQuerySeconds = 0.0;
+
+#pragma endregion
+
+};
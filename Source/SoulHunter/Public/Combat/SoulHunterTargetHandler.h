@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TargetHandlers/WeightedTargetHandler.h"
+
+#include "SoulHunterTargetHandler.generated.h"
+
+/**
+ * Picks lock-on targets from ULockOnCandidateSubsystem instead of rescanning every target component in the world.
+ * Without a direction it takes the on-screen candidate closest to the screen centre, weighted by distance; with one
+ * (switching left or right) it takes the nearest on-screen candidate in that direction from the current target.
+ * Falls back to the plugin's weighted search when no candidate set is available.
+ */
+UCLASS()
+class SOULHUNTER_API USoulHunterTargetHandler : public UWeightedTargetHandler
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual FTargetInfo FindTarget_Implementation(FVector2D PlayerInput) override;
+
+private:
+
+	UPROPERTY(EditAnywhere, Category = "Lock On")
+	float CaptureRadius = 2000.f;
+
+	UPROPERTY(EditAnywhere, Category = "Lock On")
+	float ScreenCenterWeight = 1.f;
+
+	UPROPERTY(EditAnywhere, Category = "Lock On")
+	float DistanceWeight = .5f;
+
+	/** How far off the input direction a candidate may be when switching, as the cosine of the angle. */
+	UPROPERTY(EditAnywhere, Category = "Lock On")
+	float MinSwitchAlignment = .5f;
+};
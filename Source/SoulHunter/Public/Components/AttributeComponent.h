@@ -4,9 +4,25 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Combat/CombatStatTables.h"
 
 #include "AttributeComponent.generated.h"
 
+DECLARE_MULTICAST_DELEGATE(FOnAttributesChanged);
+
+/** Plain copy of the mutable attribute values, used to carry them across level loads and into save files. */
+struct FAttributeSnapshot
+{
+	float Health = 0.f;
+	float Stamina = 0.f;
+	int32 Gold = 0;
+	int32 Souls = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FAttributeSnapshot& Snapshot)
+	{
+		return Ar << Snapshot.Health << Snapshot.Stamina << Snapshot.Gold << Snapshot.Souls;
+	}
+};
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class SOULHUNTER_API UAttributeComponent : public UActorComponent
@@ -15,39 +31,70 @@ class SOULHUNTER_API UAttributeComponent : public UActorComponent
 
 public:	
 	UAttributeComponent();
+	virtual void PostLoad() override;
 
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Fires whenever a value changes, on the server as it is written and on clients as it replicates in. */
+	FOnAttributesChanged OnAttributesChanged;
 
 protected:
 	virtual void BeginPlay() override;
 
 private:
-	UPROPERTY(EditAnywhere, Category = "Actor Attributes")
+	UFUNCTION()
+	void OnRep_Attributes();
+
+	UPROPERTY(EditAnywhere, ReplicatedUsing = OnRep_Attributes, Category = "Actor Attributes")
 	float CurrentHealth;
 
-	UPROPERTY(EditAnywhere, Category = "Actor Attributes")
+	UPROPERTY(EditAnywhere, ReplicatedUsing = OnRep_Attributes, Category = "Actor Attributes")
 	float MaxHealth;
 
+	/** Not replicated: the owning client predicts it through its movement component and the server corrects it there. */
 	UPROPERTY(EditAnywhere, Category = "Actor Attributes")
 	float CurrentStamina;
 
-	UPROPERTY(EditAnywhere, Category = "Actor Attributes")
+	UPROPERTY(EditAnywhere, ReplicatedUsing = OnRep_Attributes, Category = "Actor Attributes")
 	float MaxStamina;
 
-	UPROPERTY(EditAnywhere, Category = "Actor Attributes")
+	UPROPERTY(EditAnywhere, ReplicatedUsing = OnRep_Attributes, Category = "Actor Attributes")
 	int32 Gold;
 
-	UPROPERTY(EditAnywhere, Category = "Actor Attributes")
+	UPROPERTY(EditAnywhere, ReplicatedUsing = OnRep_Attributes, Category = "Actor Attributes")
 	int32 Souls;
 
+	/** Dodge cost, sprint drain and regen rate, shared with every character of the same archetype. Unset uses the C++ defaults. */
 	UPROPERTY(EditAnywhere, Category = "Actor Attributes")
-	float DodgeCost = 15.f;
+	UStaminaArchetype* StaminaArchetype;
 
-	UPROPERTY(EditAnywhere, Category = "Actor Attributes")
-	float SprintCost = 0.5f;
+	mutable int32 StaminaStatsIndex = INDEX_NONE;
 
-	UPROPERTY(EditAnywhere, Category = "Actor Attributes")
-	float StaminaRegenRate = 8.f;
+#if WITH_EDITORONLY_DATA
+
+	// Replaced by StaminaArchetype. Loaded from old assets and levels and moved into an archetype in PostLoad.
+
+	UPROPERTY()
+	float DodgeCost_DEPRECATED = 15.f;
+
+	/** Stamina per 0.05 s tick of the old sprint timer, where SprintCost is now stamina per second. */
+	UPROPERTY()
+	float SprintCost_DEPRECATED = .5f;
+
+	UPROPERTY()
+	float StaminaRegenRate_DEPRECATED = 8.f;
+
+	FStaminaStats GetDeprecatedStats() const;
+
+#endif
+
+	FORCEINLINE const FStaminaStats& GetStaminaStats() const
+	{
+		if (StaminaStatsIndex == INDEX_NONE)
+			StaminaStatsIndex = FCombatStatTables::Get().FindOrCompile(StaminaArchetype);
+
+		return FCombatStatTables::Get().GetStaminaRow(StaminaStatsIndex);
+	}
 
 public:
 	void ReceiveDamage(float Damage);
@@ -58,11 +105,16 @@ public:
 
 	void AddSouls(int32 SoulsAmount);
 	void AddGold(int32 GoldAmount);
-	void RegenStamina(float DeltaTime);
+	void SetStamina(float NewStamina);
+	void ResetVitals();
+
+	FAttributeSnapshot WriteSnapshot() const;
+	void ApplySnapshot(const FAttributeSnapshot& Snapshot);
 
 	FORCEINLINE int32 GetGold() const { return Gold; }
 	FORCEINLINE int32 GetSouls() const { return Souls; }
-	FORCEINLINE float GetDodgeCost() const { return DodgeCost; }
-	FORCEINLINE float GetSprintCost() const { return SprintCost; }
+	FORCEINLINE float GetDodgeCost() const { return GetStaminaStats().DodgeCost; }
+	FORCEINLINE float GetSprintCost() const { return GetStaminaStats().SprintCost; }
+	FORCEINLINE float GetStaminaRegenRate() const { return GetStaminaStats().StaminaRegenRate; }
 	FORCEINLINE float GetStamina() const { return CurrentStamina; }
 };
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+
+#include "PickupCollectorComponent.generated.h"
+
+class AItem;
+
+/**
+ * Collects auto-collected pickups around its owner with one pickup index query per frame. Pickups within MagnetRadius
+ * are pulled towards the owner and collected once within CollectRadius. Runs on the server, which hands out the souls
+ * or gold, and on the owner's own client, which plays the effects without waiting. Other clients leave the pickup to
+ * the server's destroy.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class SOULHUNTER_API UPickupCollectorComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UPickupCollectorComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+	UPROPERTY(EditAnywhere, Category = "Pickup Collection")
+	float CollectRadius = 100.f;
+
+	UPROPERTY(EditAnywhere, Category = "Pickup Collection")
+	float MagnetRadius = 400.f;
+
+	UPROPERTY(EditAnywhere, Category = "Pickup Collection")
+	float MagnetSpeed = 1200.f;
+
+	TArray<AItem*> NearbyPickups;
+};
@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+#include "SoulHunterMovementComponent.generated.h"
+
+class APlayerCharacter;
+class UAttributeComponent;
+
+#pragma region Network Data
+
+/** Client move data, extended with the stamina the client ended the move with so the server can check its prediction. */
+struct FSoulHunterNetworkMoveData : public FCharacterNetworkMoveData
+{
+	float Stamina = 0.f;
+
+	virtual void ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType) override;
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) override;
+};
+
+struct FSoulHunterNetworkMoveDataContainer : public FCharacterNetworkMoveDataContainer
+{
+	FSoulHunterNetworkMoveDataContainer();
+
+	FSoulHunterNetworkMoveData MoveData[3];
+};
+
+/** Server move response. Corrections carry the server's stamina along with the position. */
+struct FSoulHunterMoveResponseDataContainer : public FCharacterMoveResponseDataContainer
+{
+	float Stamina = 0.f;
+
+	virtual void ServerFillResponseData(const UCharacterMovementComponent& CharacterMovement, const FClientAdjustment& PendingAdjustment) override;
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap) override;
+};
+
+#pragma endregion
+
+/**
+ * Player movement with sprint and dodge predicted through saved moves. Both travel as compressed flags and stamina is
+ * part of the predicted state: it is spent and regenerated per move on both ends, sent with every move and corrected by
+ * the server like position, so the owning client never waits on an RPC to sprint or dodge.
+ */
+UCLASS()
+class SOULHUNTER_API USoulHunterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+
+#pragma region Main
+
+	USoulHunterMovementComponent();
+
+	virtual float GetMaxSpeed() const override;
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+	void SetWantsToSprint(bool bNewWantsToSprint) { bWantsToSprint = bNewWantsToSprint; }
+	void SetMaxSprintSpeed(float NewMaxSprintSpeed) { MaxSprintSpeed = NewMaxSprintSpeed; }
+	void RequestDodge() { bWantsToDodge = true; }
+
+	float GetStamina() const;
+	void SetStamina(float NewStamina);
+
+#pragma endregion
+
+protected:
+
+#pragma region Movement
+
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+	virtual void UpdateCharacterStateAfterMovement(float DeltaSeconds) override;
+
+	virtual void SendClientAdjustment() override;
+	virtual bool ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientLoc, const FVector& RelativeClientLoc, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+	virtual void ClientHandleMoveResponse(const FCharacterMoveResponseDataContainer& MoveResponse) override;
+
+	bool CanSprint() const;
+	void PerformDodge();
+
+	UPROPERTY(EditAnywhere, Category = "Character Movement: Sprint")
+	float MaxSprintSpeed = 800.f;
+
+	/** How far the client's predicted stamina may drift from the server's before the move is corrected. */
+	UPROPERTY(EditAnywhere, Category = "Character Movement: Stamina")
+	float StaminaErrorTolerance = 1.f;
+
+#pragma endregion
+
+private:
+
+	APlayerCharacter* GetPlayerOwner() const;
+	UAttributeComponent* GetAttributes() const;
+
+	uint8 bWantsToSprint : 1;
+	uint8 bWantsToDodge : 1;
+	uint8 bIsSprinting : 1;
+
+	/** Server. Whether the correction waiting to be sent includes a position error, or only stamina drifted. */
+	uint8 bPendingPositionCorrection : 1;
+
+	FSoulHunterNetworkMoveDataContainer MoveDataContainer;
+	FSoulHunterMoveResponseDataContainer MoveResponseDataContainer;
+
+	friend class FSavedMove_SoulHunter;
+
+public:
+
+	FORCEINLINE bool IsSprinting() const { return bIsSprinting; }
+};
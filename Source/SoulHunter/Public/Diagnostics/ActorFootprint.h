@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+class UWorld;
+
+/** One object owned by a measured actor: the actor itself, a component or any other subobject. */
+struct FObjectFootprint
+{
+	FString Name;
+	FString ClassName;
+	int64 Bytes = 0;
+	bool bComponent = false;
+	bool bTicks = false;
+};
+
+/**
+ * What one spawned instance of a gameplay actor class costs: how many UObjects it brings along (components and other
+ * subobjects), their instance sizes plus the heap memory they report through CountBytes, and how many of the actor's
+ * and components' primary tick functions end up registered and enabled. Classes are spawned into a throwaway world that
+ * never begins play, so the numbers cover what construction creates and not what BeginPlay spawns later (an enemy's
+ * weapon, for example, is measured on its own). Tick functions are registered the way BeginPlay would register them.
+ */
+struct SOULHUNTER_API FActorFootprint
+{
+	FString ClassName;
+	int32 NumObjects = 0;
+	int32 NumComponents = 0;
+	int32 NumTickFunctions = 0;
+	int64 InstanceBytes = 0;
+	int64 AllocatedBytes = 0;
+
+	TArray<FObjectFootprint> Objects;
+
+	FORCEINLINE int64 GetTotalBytes() const { return InstanceBytes + AllocatedBytes; }
+
+	/** AEnemy, AWeapon, ASoul, ATreasure and ABreakableActor. */
+	static TArray<UClass*> GetDefaultClasses();
+
+	static TArray<FActorFootprint> MeasureClasses(TConstArrayView<UClass*> ActorClasses);
+
+	/** Measures an actor that is already spawned, registering its tick functions first if they are not yet. */
+	static void MeasureActor(AActor* Actor, FActorFootprint& OutFootprint);
+
+	static void LogTable(TConstArrayView<FActorFootprint> Footprints, bool bVerbose);
+	static FString ToCsv(TConstArrayView<FActorFootprint> Footprints);
+
+private:
+
+	static bool SpawnAndMeasure(UWorld* World, UClass* ActorClass, FActorFootprint& OutFootprint);
+};
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+enum class ECombatTelemetryEvent : uint8
+{
+	Hit,
+	Damage,
+	Death,
+	Pickup,
+	Drop,
+	StateTransition,
+	Trace,
+
+	Count
+};
+
+/**
+ * One event as it is stored on disk, after a FCombatTelemetryHeader. Ids are handed out per session, from 1, the first
+ * time an object is recorded, and are never reused within the session even after the object is garbage collected.
+ * 0 means no object.
+ */
+struct FCombatTelemetryRecord
+{
+	/** Seconds since recording started. */
+	float Time = 0.f;
+	ECombatTelemetryEvent Type = ECombatTelemetryEvent::Hit;
+
+	/** Per event: the new state of a transition, the number of merged drops of a drop. */
+	uint8 Detail = 0;
+	uint16 Reserved = 0;
+	uint32 SourceId = 0;
+	uint32 TargetId = 0;
+
+	/** Per event: damage dealt, or the amount picked up or dropped. */
+	float Value = 0.f;
+};
+
+static_assert(sizeof(FCombatTelemetryRecord) == 20, "Combat telemetry records are written to disk as they are");
+
+struct FCombatTelemetryHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x54434853; // "SHCT"
+	static constexpr uint32 CurrentVersion = 1;
+
+	uint32 Magic = ExpectedMagic;
+	uint32 Version = CurrentVersion;
+	uint32 RecordSize = sizeof(FCombatTelemetryRecord);
+	uint32 Reserved = 0;
+
+	/** UTC ticks at which recording started. */
+	int64 StartTicks = 0;
+};
+
+/**
+ * Records combat events to a compact binary log for tuning and performance work. Every thread writes into its own
+ * lock-free ring, and a background thread drains the rings to disk twice a second, so recording an event costs a
+ * thread-local lookup and a 28 byte copy. Objects are stored as raw keys and turned into ids by the writer thread.
+ * When a ring fills faster than it is drained, events are dropped and counted.
+ *
+ * Start with -CombatTelemetry on the command line or sh.Telemetry.Start [Path]; convert with -run=CombatTelemetry.
+ */
+class SOULHUNTER_API FCombatTelemetry
+{
+public:
+
+	/** Starts writing to Path, or to Saved/Telemetry/Combat-<time>.bin when it is empty. */
+	static bool Start(const FString& Path = FString());
+	static void Stop();
+
+	FORCEINLINE static bool IsRecording() { return bRecording.load(std::memory_order_relaxed); }
+
+	static void Record(ECombatTelemetryEvent Type, const UObject* Source, const UObject* Target, float Value = 0.f, uint8 Detail = 0);
+
+	/** Reads a whole log back, for the offline tools. */
+	static bool ReadFile(const FString& Path, FCombatTelemetryHeader& OutHeader, TArray<FCombatTelemetryRecord>& OutRecords);
+
+	static const TCHAR* GetEventName(ECombatTelemetryEvent Type);
+
+private:
+
+	static std::atomic<bool> bRecording;
+};
+
+#define SH_COMBAT_TELEMETRY(Type, Source, Target, ...) \
+	do { if (FCombatTelemetry::IsRecording()) FCombatTelemetry::Record(ECombatTelemetryEvent::Type, Source, Target, ##__VA_ARGS__); } while (0)
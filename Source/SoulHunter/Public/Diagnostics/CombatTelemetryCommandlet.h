@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "CombatTelemetryCommandlet.generated.h"
+
+/**
+ * Converts a combat telemetry log (see FCombatTelemetry) to CSV, one row per event in time order, and logs how many of
+ * each event happened per minute of the session.
+ *
+ * UnrealEditor-Cmd SoulHunter.uproject -run=CombatTelemetry -Input=Path.bin [-Output=Path.csv]
+ */
+UCLASS()
+class UCombatTelemetryCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UCombatTelemetryCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
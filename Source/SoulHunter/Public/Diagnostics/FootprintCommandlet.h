@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "FootprintCommandlet.generated.h"
+
+/** The most one instance of an actor class may cost before the footprint commandlet fails. Zero means unchecked. */
+USTRUCT()
+struct FFootprintBudget
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Config)
+	TSoftClassPtr<AActor> ActorClass;
+
+	UPROPERTY(Config)
+	int32 MaxObjects = 0;
+
+	UPROPERTY(Config)
+	int64 MaxBytes = 0;
+
+	UPROPERTY(Config)
+	int32 MaxTickFunctions = 0;
+};
+
+/**
+ * Measures the default gameplay classes plus every class that has a budget (see FActorFootprint), logs the table,
+ * writes it as CSV and returns 1 if any class is over budget, so CI can track archetype sizes and stop them growing.
+ *
+ * UnrealEditor-Cmd SoulHunter.uproject -run=Footprint [-Output=Path.csv] [-Classes=/Game/A.A_C+/Game/B.B_C] [-Verbose]
+ */
+UCLASS(Config = Game)
+class UFootprintCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UFootprintCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+
+	UPROPERTY(Config)
+	TArray<FFootprintBudget> Budgets;
+};
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+
+/**
+ * sh.Tick.Audit [Seconds] lists every tick function registered in the world, grouped by class, with its tick group,
+ * interval and how many are enabled. Gameplay Tick overrides open a SH_TICK_AUDIT_SCOPE, so their measured cost per
+ * frame is reported too, and an actor that ticks without any native or Blueprint tick work is flagged as empty.
+ */
+struct SOULHUNTER_API FTickAudit
+{
+	static void Start(UWorld* World, float Seconds);
+
+	FORCEINLINE static bool IsRecording() { return bRecording; }
+	static void Record(const UClass* Class, double Seconds);
+
+private:
+
+	static void LogReport(UWorld* World);
+
+	static bool bRecording;
+	static int32 NumFrames;
+	static TMap<const UClass*, double> ClassSeconds;
+};
+
+/** Times the outermost gameplay Tick on the stack, so Super::Tick calls are counted once under the most derived class. */
+struct FTickAuditScope
+{
+	FORCEINLINE explicit FTickAuditScope(const UClass* InClass)
+	{
+		if (!FTickAudit::IsRecording() || !IsInGameThread())
+			return;
+
+		bCounted = true;
+
+		if (Depth++ > 0)
+			return;
+
+		Class = InClass;
+		StartTime = FPlatformTime::Seconds();
+	}
+
+	FORCEINLINE ~FTickAuditScope()
+	{
+		if (!bCounted)
+			return;
+
+		--Depth;
+
+		if (Class)
+			FTickAudit::Record(Class, FPlatformTime::Seconds() - StartTime);
+	}
+
+private:
+
+	const UClass* Class = nullptr;
+	double StartTime = 0.0;
+	bool bCounted = false;
+
+	static int32 Depth;
+};
+
+#define SH_TICK_AUDIT_SCOPE() FTickAuditScope TickAuditScope(GetClass())
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+
+#include "EncounterDataAsset.generated.h"
+
+class AEnemy;
+
+USTRUCT(BlueprintType)
+struct FEncounterSpawnEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere)
+	TSubclassOf<AEnemy> EnemyClass;
+
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1"))
+	int32 Count = 1;
+};
+
+USTRUCT(BlueprintType)
+struct FEncounterWave
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere)
+	TArray<FEncounterSpawnEntry> Spawns;
+
+	/** Seconds to wait once the wave is allowed to start. */
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0"))
+	float StartDelay = 0.f;
+
+	/** When set, the wave waits until every enemy of the previous wave is dead. */
+	UPROPERTY(EditAnywhere)
+	bool bWaitForPreviousWave = true;
+};
+
+/**
+ * A sequence of enemy waves spawned by an AEncounterSpawner.
+ */
+UCLASS(BlueprintType)
+class SOULHUNTER_API UEncounterDataAsset : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(EditAnywhere, Category = "Encounter")
+	TArray<FEncounterWave> Waves;
+
+	/** Enemies of each class built ahead of time while the encounter is idle, so waves mostly activate pooled actors. */
+	UPROPERTY(EditAnywhere, Category = "Encounter", meta = (ClampMin = "0"))
+	int32 PoolPrewarmPerClass = 8;
+
+	void GetEnemyClasses(TArray<TSubclassOf<AEnemy>>& OutClasses) const
+	{
+		for (const FEncounterWave& Wave : Waves)
+		{
+			for (const FEncounterSpawnEntry& Entry : Wave.Spawns)
+			{
+				if (Entry.EnemyClass)
+					OutClasses.AddUnique(Entry.EnemyClass);
+			}
+		}
+	}
+};
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+
+#include "EncounterSpawner.generated.h"
+
+class UBoxComponent;
+class UEncounterDataAsset;
+
+/**
+ * Runs an encounter's waves once a player walks into its trigger. Spawning is handled by UEncounterSubsystem.
+ */
+UCLASS()
+class SOULHUNTER_API AEncounterSpawner : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	AEncounterSpawner();
+
+	FTransform GetSpawnTransform(int32 SpawnIndex) const;
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	UFUNCTION()
+	void OnTriggerOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+
+	UPROPERTY(VisibleAnywhere)
+	UBoxComponent* Trigger;
+
+	UPROPERTY(EditAnywhere, Category = "Encounter")
+	UEncounterDataAsset* Encounter;
+
+	/** Enemies are spread over these points in order. Without any, they are scattered around the spawner. */
+	UPROPERTY(EditInstanceOnly, Category = "Encounter")
+	TArray<AActor*> SpawnPoints;
+
+	UPROPERTY(EditAnywhere, Category = "Encounter")
+	float ScatterRadius = 600.f;
+
+	UPROPERTY(EditInstanceOnly, Category = "AI Navigation")
+	TArray<AActor*> PatrolTargets;
+
+private:
+
+	bool bTriggered = false;
+
+public:
+
+	FORCEINLINE UEncounterDataAsset* GetEncounter() const { return Encounter; }
+	FORCEINLINE const TArray<AActor*>& GetPatrolTargets() const { return PatrolTargets; }
+};
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "EncounterSubsystem.generated.h"
+
+class AEnemy;
+class AEncounterSpawner;
+
+/**
+ * Schedules encounter waves and builds their enemies in stages (construction, weapon, controller, health bar widget),
+ * running as many stages per frame as fit in sh.Encounter.SpawnBudgetMs. Enemies are kept in per-class pools that are
+ * prewarmed in idle frames, and dead enemies return to the pool when their corpse expires.
+ */
+UCLASS()
+class SOULHUNTER_API UEncounterSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+#pragma region Main
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void PrewarmEncounter(AEncounterSpawner* Spawner);
+	void StartEncounter(AEncounterSpawner* Spawner, APawn* Instigator);
+
+	/** Takes back a pooled enemy once its corpse has expired. Returns false if the enemy does not belong to a pool. */
+	bool ReleaseEnemy(AEnemy* Enemy);
+
+	void LogSpawnStats() const;
+
+#pragma endregion
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+#pragma region Spawn Jobs
+
+	enum class ESpawnStage : uint8
+	{
+		Construct,
+		Weapon,
+		Possess,
+		Widget,
+		Activate,
+
+		Count
+	};
+
+	struct FSpawnJob
+	{
+		TSubclassOf<AEnemy> EnemyClass;
+		FTransform SpawnTransform;
+		TWeakObjectPtr<AEncounterSpawner> Spawner;
+		TWeakObjectPtr<APawn> Target;
+		int32 EncounterIndex = INDEX_NONE;
+
+		TWeakObjectPtr<AEnemy> Enemy;
+		ESpawnStage Stage = ESpawnStage::Construct;
+		double StageMilliseconds[static_cast<int32>(ESpawnStage::Count)] = {};
+	};
+
+	/** Runs the job's current stage. Returns true once the job is finished (or had to be dropped). */
+	bool RunStage(FSpawnJob& Job, bool bPrewarm);
+	void RecordSpawnCost(const FSpawnJob& Job);
+
+	/** Consumed front to back through NextWaveJob and reset once drained, so taking a job never shifts the queue. */
+	TArray<FSpawnJob> WaveJobs;
+	int32 NextWaveJob = 0;
+
+	TArray<FSpawnJob> PrewarmJobs;
+
+	FORCEINLINE int32 GetNumQueuedWaveJobs() const { return WaveJobs.Num() - NextWaveJob; }
+
+#pragma endregion
+
+#pragma region Encounters
+
+	struct FActiveEncounter
+	{
+		TWeakObjectPtr<AEncounterSpawner> Spawner;
+		TWeakObjectPtr<APawn> Target;
+		int32 NextWave = 0;
+		int32 NextSpawnIndex = 0;
+		float WaveDelayRemaining = -1.f;
+		int32 PendingSpawns = 0;
+		TArray<TWeakObjectPtr<AEnemy>> AliveEnemies;
+	};
+
+	void UpdateEncounter(int32 EncounterIndex, float DeltaTime);
+	void QueueWave(int32 EncounterIndex);
+
+	TArray<FActiveEncounter> Encounters;
+
+#pragma endregion
+
+#pragma region Pooling
+
+	TMap<UClass*, TArray<TWeakObjectPtr<AEnemy>>> Pools;
+	TSet<TWeakObjectPtr<AEnemy>> PooledEnemies;
+
+#pragma endregion
+
+#pragma region Stats
+
+	static constexpr int32 MaxCostSamples = 1024;
+
+	TArray<float> TotalCostSamples;
+	TArray<float> StageCostSamples[static_cast<int32>(ESpawnStage::Count)];
+	TArray<float> FrameCostSamples;
+	int32 NextSampleIndex = 0;
+	int32 NextFrameSampleIndex = 0;
+
+#pragma endregion
+
+};
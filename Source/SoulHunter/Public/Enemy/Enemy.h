@@ -4,6 +4,9 @@
 
 #include "Characters/BaseCharacter.h"
 #include "Characters/CharacterType.h"
+#include "Combat/CombatStatTables.h"
+#include "Enemy/PatrolCrowdTypes.h"
+#include "Interfaces/PersistentInterface.h"
 
 #include "Enemy.generated.h"
 
@@ -18,7 +21,7 @@ class UTargetComponent;
 #pragma endregion
 
 UCLASS()
-class SOULHUNTER_API AEnemy : public ABaseCharacter
+class SOULHUNTER_API AEnemy : public ABaseCharacter, public IPersistentInterface
 {
 	GENERATED_BODY()
 
@@ -31,10 +34,50 @@ public:
 	virtual void Tick(float DeltaTime) override;
 	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser) override;
 	virtual void Destroyed() override;
+	virtual void PossessedBy(AController* NewController) override;
+	virtual void PostInitializeComponents() override;
+	virtual void PostLoad() override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	// IHitInterface
 	virtual void GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter) override;
 
+	virtual void GatherPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const override;
+
+#pragma endregion
+
+#pragma region Persistence
+
+	virtual FGuid GetPersistentGuid() const override;
+	virtual bool WritePersistentState(FActorStateRecord& OutRecord) const override;
+	virtual void ApplyPersistentState(const FActorStateRecord& Record) override;
+
+#pragma endregion
+
+#pragma region Crowd
+
+	void InitializeCrowdAgent(const FPatrolCrowdHandle& Handle, const TArray<AActor*>& InPatrolTargets, AActor* InPatrolTarget);
+	void EngageTarget(APawn* Target);
+
+	FORCEINLINE void ClearCrowdHandle() { CrowdHandle.Reset(); }
+	FORCEINLINE const FPatrolCrowdHandle& GetCrowdHandle() const { return CrowdHandle; }
+
+#pragma endregion
+
+#pragma region Encounter Spawning
+
+	/** Call before FinishSpawning. Weapon, controller and health bar are then left to the encounter spawner's own steps. */
+	void PrepareStagedSpawn(const TArray<AActor*>& InPatrolTargets);
+	void SpawnDefaultWeapon();
+	void CreateHealthBarWidget();
+	void ActivateSpawned(APawn* Target);
+
+	/** Pools are shared by every spawner of a class, so anything a spawner sets is cleared here and passed in again on reuse. */
+	void DeactivateForPool();
+	void ReactivateFromPool(const FTransform& SpawnTransform, const TArray<AActor*>& InPatrolTargets);
+
+	FORCEINLINE void SetReturnToPool(bool bReturn) { bReturnToPool = bReturn; }
+
 #pragma endregion
 
 protected:
@@ -42,16 +85,23 @@ protected:
 #pragma region Main
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void OnPreloadAssetsLoaded() override;
 
 	virtual void Death(const FVector& ImpactPoint) override;
+	virtual void LifeSpanExpired() override;
 
 	void SpawnSoul();
 
-	UPROPERTY(BlueprintReadOnly)
-	EEnemyDeathPose DeathPose;
+	/** The part of Death every machine plays: pose or ragdoll, collision and health bar. */
+	void PlayDeathEffects(const FVector& ImpactPoint);
+	void ResetDeathEffects();
 
-	UPROPERTY(EditAnywhere)
-	float DeathLifeSpan = 30.f;
+	/** Lets the player lock on to this enemy or not, keeping the lock-on candidate set in step. */
+	void SetTargetable(bool bTargetable);
+
+	UPROPERTY(BlueprintReadOnly, Replicated)
+	EEnemyDeathPose DeathPose;
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = TargetLock)
 	UTargetComponent* TargetComponent;
@@ -61,10 +111,15 @@ protected:
 #pragma region AI Behavior - Main
 
 	void MoveToTarget(AActor* PatrolTarget);
-	bool InTargetRange(AActor* Target, double Radius);
+	bool InTargetRange(AActor* Target, float RadiusSquared);
 	UFUNCTION() void PawnSeen(APawn* SeenPawn);
 
-	UPROPERTY(BlueprintReadOnly)
+	void SetEnemyState(EEnemyState NewState);
+
+	UFUNCTION()
+	void OnRep_EnemyState();
+
+	UPROPERTY(BlueprintReadOnly, ReplicatedUsing = OnRep_EnemyState)
 	EEnemyState EnemyState = EEnemyState::EES_Patrolling;
 
 #pragma endregion
@@ -81,25 +136,27 @@ private:
 
 #pragma region Main Components
 
-	void SpawnDefaultWeapon();
-
 	UPROPERTY()
 	class AAIController* EnemyController;
 
 	UPROPERTY(EditAnywhere, Category = Combat)
-	TSubclassOf<class AWeapon> WeaponClass;
+	TSoftClassPtr<class AWeapon> WeaponClass;
 
 	UPROPERTY(VisibleAnywhere, Category = AI)
 	UPawnSensingComponent* PawnSensing;
 
-	UPROPERTY(EditAnywhere, Category = AI)
-	float PawnSightRadius = 2000.f;
+	/** Sensing, patrol and combat tuning, shared with every enemy of the same archetype. Unset uses the C++ defaults. */
+	UPROPERTY(EditAnywhere, Category = Combat)
+	UEnemyArchetype* Archetype;
+
+	mutable int32 StatsIndex = INDEX_NONE;
 
-	UPROPERTY (EditAnywhere, Category = AI)
-	float PawnPeripheralVisionAngle = 45.f;
+	UPROPERTY(EditAnywhere, Category = Combat)
+	TSoftClassPtr<class ASoul> SoulClass;
 
+	/** Rolled on death on top of the soul. */
 	UPROPERTY(EditAnywhere, Category = Combat)
-	TSubclassOf<class ASoul> SoulClass;
+	class ULootTable* LootTable;
 
 #pragma endregion
 
@@ -111,29 +168,14 @@ private:
 	void PatrolTimerFinished();
 	void ClearPatrolTimer();
 
-	UPROPERTY(EditAnywhere, Category = Combat) 
-	float PatrollingSpeed = 125.f;
-
 	UPROPERTY(EditInstanceOnly, Category = "AI Navigation")
 	AActor* PatrolTarget;
 
 	UPROPERTY(EditInstanceOnly, Category = "AI Navigation")
 	TArray<AActor*> PatrolTargets;
 
-	UPROPERTY(EditAnywhere, Category = "AI Navigation")
-	double PatrolRadius = 200.f;
-
-	UPROPERTY(EditAnywhere, Category = "AI Navigation")
-	double AcceptanceRadius = 40.f;
-
 	FTimerHandle PatrolTimer;
 
-	UPROPERTY(EditAnywhere, Category = "AI Navigation")
-	float PatrolWaitinTimeMin = 4.f;
-
-	UPROPERTY(EditAnywhere, Category = "AI Navigation")
-	float PatrolWaitingTimeMax = 10.f;
-
 #pragma endregion
 
 #pragma region AI Behavior - Chase
@@ -141,9 +183,6 @@ private:
 	void LoseInterest();
 	void StartChasing();
 
-	UPROPERTY(EditAnywhere, Category = Combat)
-	float ChasingSpeed = 350.f;
-
 #pragma endregion
 
 #pragma region AI Behavior - Combat
@@ -155,20 +194,8 @@ private:
 	bool IsOutsideAttackRadius();
 	bool IsInsideAttackRadius();
 
-	UPROPERTY(EditAnywhere, Category = Combat)
-	float CombatRadius = 500.f;
-
-	UPROPERTY(EditAnywhere, Category = Combat)
-	float AttackRadius = 135.f;
-
 	FTimerHandle AttackTimer;
 
-	UPROPERTY(EditAnywhere, Category = Combat)
-	float AttackWaitingTimeMin = .5f;
-
-	UPROPERTY(EditAnywhere, Category = Combat)
-	float AttackWaitingTimeMax = 1.f;
-
 #pragma endregion
 
 #pragma region AI Behavior - State Booleans
@@ -182,10 +209,98 @@ private:
 
 	void UpdateHealthPercent();
 	void ShowHealthBar(bool Show);
+	void OnAttributesReplicated();
 
 	UPROPERTY(VisibleAnywhere) 
 	UHealthBarComponent* HealthBarWidget;
 
+#pragma endregion
+
+	FPatrolCrowdHandle CrowdHandle;
+
+	void ResetAfterDeath();
+
+	bool bStagedSpawn = false;
+	bool bReturnToPool = false;
+	bool bDeathEffectsPlayed = false;
+
+#pragma region Persistence
+
+	mutable FGuid PersistentGuid;
+	FVector HomeLocation;
+	bool bPlacedInLevel = false;
+
+	UPROPERTY(EditAnywhere, Category = Persistence)
+	float MovedPersistenceThreshold = 50.f;
+
+#pragma endregion
+
+#pragma region Deprecated
+
+#if WITH_EDITORONLY_DATA
+
+	// Replaced by Archetype. Loaded from old assets and levels and moved into an archetype in PostLoad.
+
+	UPROPERTY()
+	float PawnSightRadius_DEPRECATED = 2000.f;
+
+	UPROPERTY()
+	float PawnPeripheralVisionAngle_DEPRECATED = 45.f;
+
+	UPROPERTY()
+	float PatrollingSpeed_DEPRECATED = 125.f;
+
+	UPROPERTY()
+	double PatrolRadius_DEPRECATED = 200.f;
+
+	UPROPERTY()
+	double AcceptanceRadius_DEPRECATED = 40.f;
+
+	UPROPERTY()
+	float PatrolWaitinTimeMin_DEPRECATED = 4.f;
+
+	UPROPERTY()
+	float PatrolWaitingTimeMax_DEPRECATED = 10.f;
+
+	UPROPERTY()
+	float ChasingSpeed_DEPRECATED = 350.f;
+
+	UPROPERTY()
+	float CombatRadius_DEPRECATED = 500.f;
+
+	UPROPERTY()
+	float AttackRadius_DEPRECATED = 135.f;
+
+	UPROPERTY()
+	float AttackWaitingTimeMin_DEPRECATED = .5f;
+
+	UPROPERTY()
+	float AttackWaitingTimeMax_DEPRECATED = 1.f;
+
+	UPROPERTY()
+	float DeathLifeSpan_DEPRECATED = 30.f;
+
+	FEnemyStats GetDeprecatedStats() const;
+
+#endif
+
+#pragma endregion
+
+public:
+
+#pragma region Getters/Setters
+
+	FORCEINLINE EEnemyState GetEnemyState() const { return EnemyState; }
+	FORCEINLINE UTargetComponent* GetTargetComponent() const { return TargetComponent; }
+
+	FORCEINLINE const FEnemyStatRow& GetStats() const
+	{
+		if (StatsIndex == INDEX_NONE)
+			StatsIndex = FCombatStatTables::Get().FindOrCompile(Archetype);
+
+		return FCombatStatTables::Get().GetEnemyRow(StatsIndex);
+	}
+
 #pragma endregion
 
 };
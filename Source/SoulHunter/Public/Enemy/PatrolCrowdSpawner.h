@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+
+#include "PatrolCrowdSpawner.generated.h"
+
+class AEnemy;
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+
+/** Where a demoted agent picked up its patrol on the server, so clients can resume it from the same point. */
+USTRUCT()
+struct FPatrolCrowdAgentSync
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 AgentIndex = INDEX_NONE;
+
+	/** Bumped on every sync of the same agent, so clients apply each one once. */
+	UPROPERTY()
+	uint16 Revision = 0;
+
+	UPROPERTY()
+	int32 TargetIndex = 0;
+
+	UPROPERTY()
+	int32 PatrolStep = 0;
+
+	UPROPERTY()
+	FVector_NetQuantize Location;
+
+	UPROPERTY()
+	float Yaw = 0.f;
+
+	UPROPERTY()
+	double ServerTime = 0.0;
+};
+
+/**
+ * Places a crowd of lightweight patrolling agents that share one instanced mesh.
+ * Agents are simulated by UPatrolCrowdSubsystem and only become full AEnemy actors when they engage a player. Clients
+ * run the same patrol from the replicated seed for the visuals only; the server replicates which agents are hidden
+ * (promoted or dead) and where demoted agents resumed.
+ */
+UCLASS()
+class SOULHUNTER_API APatrolCrowdSpawner : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	APatrolCrowdSpawner();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Skips unset targets; OutSourceIndices holds the index into GetPatrolTargets() of each location. */
+	void GetPatrolTargetLocations(TArray<FVector>& OutLocations, TArray<int32>& OutSourceIndices) const;
+
+	/** Server only. */
+	void SetAgentHidden(int32 AgentIndex, bool bHidden);
+	void SyncAgent(const FPatrolCrowdAgentSync& Sync);
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UFUNCTION()
+	void OnRep_CrowdSeed();
+
+	UFUNCTION()
+	void OnRep_CrowdState();
+
+	UPROPERTY(VisibleAnywhere)
+	UInstancedStaticMeshComponent* CrowdInstances;
+
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	TSubclassOf<AEnemy> EnemyClass;
+
+	UPROPERTY(EditAnywhere, Category = "Crowd", meta = (ClampMin = "1"))
+	int32 AgentCount = 100;
+
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	float SpawnRadius = 1500.f;
+
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	UStaticMesh* CrowdMesh;
+
+	UPROPERTY(EditInstanceOnly, Category = "AI Navigation")
+	TArray<AActor*> PatrolTargets;
+
+private:
+
+	/** Registers once play has begun and, on clients, the seed has arrived, whichever comes last. */
+	void RegisterWithCrowd();
+
+	UPROPERTY(ReplicatedUsing = OnRep_CrowdSeed)
+	int32 CrowdSeed = 0;
+
+	/** Server time the crowd was placed, which late joining clients fast forward from. */
+	UPROPERTY(Replicated)
+	double CrowdStartTime = 0.0;
+
+	UPROPERTY(ReplicatedUsing = OnRep_CrowdState)
+	TArray<int32> HiddenAgents;
+
+	UPROPERTY(ReplicatedUsing = OnRep_CrowdState)
+	TArray<FPatrolCrowdAgentSync> AgentSyncs;
+
+	bool bRegisteredWithCrowd = false;
+
+public:
+
+	FORCEINLINE UInstancedStaticMeshComponent* GetCrowdInstances() const { return CrowdInstances; }
+	FORCEINLINE TSubclassOf<AEnemy> GetEnemyClass() const { return EnemyClass; }
+	FORCEINLINE int32 GetAgentCount() const { return AgentCount; }
+	FORCEINLINE float GetSpawnRadius() const { return SpawnRadius; }
+	FORCEINLINE const TArray<AActor*>& GetPatrolTargets() const { return PatrolTargets; }
+	FORCEINLINE int32 GetCrowdSeed() const { return CrowdSeed; }
+	FORCEINLINE double GetCrowdStartTime() const { return CrowdStartTime; }
+	FORCEINLINE const TArray<int32>& GetHiddenAgents() const { return HiddenAgents; }
+	FORCEINLINE const TArray<FPatrolCrowdAgentSync>& GetAgentSyncs() const { return AgentSyncs; }
+};
@@ -0,0 +1,165 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Enemy/PatrolCrowdTypes.h"
+
+#include "PatrolCrowdSubsystem.generated.h"
+
+class AEnemy;
+class APatrolCrowdSpawner;
+
+/**
+ * Simulates ambient patrolling enemies as packed agent data instead of actors.
+ * Agent fragments are stored contiguously per spawner so each spawner's instanced mesh is updated in one batch.
+ * An agent is promoted to a full AEnemy when a player enters its CombatRadius or its sight cone, and is
+ * demoted back once that enemy loses interest and returns to patrolling. Every patrol choice is drawn from the
+ * spawner's seed, the agent and its patrol step, so clients replay the same patrol for the visuals without sight checks
+ * or promotions of their own.
+ */
+UCLASS()
+class SOULHUNTER_API UPatrolCrowdSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+#pragma region Main
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterSpawner(APatrolCrowdSpawner* Spawner);
+	void UnregisterSpawner(APatrolCrowdSpawner* Spawner);
+
+	void RequestDemotion(AEnemy* Enemy);
+
+	/** Clients. Applies the spawner's replicated hidden agents and demotions to its agents. */
+	void ApplyReplicatedState(APatrolCrowdSpawner* Spawner);
+
+	/** Server world time, which crowd start and demotion times are measured in on every machine. */
+	double GetCrowdTime() const;
+
+	FORCEINLINE int32 GetNumAgents() const { return Locations.Num(); }
+	FORCEINLINE int32 GetNumPromotedAgents() const { return NumPromotedAgents; }
+
+#pragma endregion
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+#pragma region Chunks
+
+	/** Patrol parameters shared by every agent of one spawner, read once from the enemy class defaults. */
+	struct FCrowdArchetype
+	{
+		TSubclassOf<AEnemy> EnemyClass;
+		int32 Seed = 0;
+		float PatrolRadius = 200.f;
+		float PatrolWaitingTimeMin = 4.f;
+		float PatrolWaitingTimeMax = 10.f;
+		float PatrollingSpeed = 125.f;
+		float CombatRadiusSquared = 0.f;
+		float SightRadiusSquared = 0.f;
+		float CosPeripheralVision = 1.f;
+		float HalfHeight = 0.f;
+	};
+
+	struct FCrowdChunk
+	{
+		TWeakObjectPtr<APatrolCrowdSpawner> Spawner;
+		uint32 SpawnerId = 0;
+		int32 FirstAgent = 0;
+		int32 NumAgents = 0;
+		FCrowdArchetype Archetype;
+		TArray<FVector> TargetLocations;
+		TArray<int32> TargetSourceIndices;
+		TMap<int32, TWeakObjectPtr<AEnemy>> PromotedEnemies;
+
+		/** False on clients, whose agents only patrol and take promotions and demotions from the server. */
+		bool bAuthority = true;
+		TMap<int32, uint16> AppliedSyncRevisions;
+
+		/** Instances whose agent moved, or was hidden or shown, since the last upload to the instanced mesh. */
+		TBitArray<> DirtyInstances;
+		int32 NumDirtyInstances = 0;
+		double LastInstanceUpload = 0.0;
+	};
+
+	FCrowdChunk* FindChunk(uint32 SpawnerId);
+	void SimulateChunk(FCrowdChunk& Chunk, float DeltaTime);
+
+	/** Walks an agent's patrol forward by Seconds in whole legs, for clients catching up with the server. */
+	void AdvanceAgent(FCrowdChunk& Chunk, int32 Agent, float Seconds);
+	void UpdateInstances(FCrowdChunk& Chunk);
+	FTransform GetInstanceTransform(int32 Agent) const;
+
+	FORCEINLINE void MarkInstanceDirty(FCrowdChunk& Chunk, int32 LocalIndex)
+	{
+		if (!Chunk.DirtyInstances[LocalIndex])
+		{
+			Chunk.DirtyInstances[LocalIndex] = true;
+			++Chunk.NumDirtyInstances;
+		}
+	}
+	void RefreshPromotedAgents(FCrowdChunk& Chunk);
+	bool CanSeePlayer(const FCrowdChunk& Chunk, int32 AgentIndex, APawn*& OutPlayer);
+	void PromoteAgent(FCrowdChunk& Chunk, int32 LocalIndex, APawn* Target);
+	void ProcessDemotions();
+
+	static FRandomStream GetAgentStream(const FCrowdChunk& Chunk, int32 LocalIndex, int32 PatrolStep);
+	static int32 ChooseNextTarget(int32 CurrentTarget, int32 NumTargets, FRandomStream& Stream);
+
+	/** Picks the agent's next target and wait from its current patrol step. */
+	void ChooseNextLeg(const FCrowdChunk& Chunk, int32 Agent);
+
+	TArray<FCrowdChunk> Chunks;
+
+#pragma endregion
+
+#pragma region Agent Fragments
+
+	enum EAgentFlags : uint8
+	{
+		AF_None = 0,
+		AF_Promoted = 1 << 0,
+		AF_Dead = 1 << 1
+	};
+
+	TArray<FVector> Locations;
+	TArray<float> Yaws;
+	TArray<float> WaitTimes;
+	TArray<int32> TargetIndices;
+	TArray<int32> PatrolSteps;
+	TArray<uint8> Flags;
+
+#pragma endregion
+
+#pragma region Frame State
+
+	struct FPlayerView
+	{
+		APawn* Pawn;
+		FVector Location;
+	};
+
+	void GatherPlayers();
+
+	TArray<FPlayerView, TInlineAllocator<4>> Players;
+	TArray<TWeakObjectPtr<AEnemy>> PendingDemotions;
+	TArray<FTransform> InstanceTransformScratch;
+
+	uint32 NextSpawnerId = 1;
+	int32 NumPromotedAgents = 0;
+	int32 SightTracesThisFrame = 0;
+	int32 MaxSightTracesPerFrame = 16;
+
+#pragma endregion
+
+};
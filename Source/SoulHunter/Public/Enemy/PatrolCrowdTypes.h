@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Identifies the crowd agent an AEnemy was promoted from. */
+struct FPatrolCrowdHandle
+{
+	uint32 SpawnerId = 0;
+	int32 AgentIndex = INDEX_NONE;
+
+	FORCEINLINE bool IsValid() const { return SpawnerId != 0 && AgentIndex != INDEX_NONE; }
+	FORCEINLINE void Reset() { SpawnerId = 0; AgentIndex = INDEX_NONE; }
+};
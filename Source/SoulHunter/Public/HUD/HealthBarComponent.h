@@ -15,9 +15,17 @@ class SOULHUNTER_API UHealthBarComponent : public UWidgetComponent
 	GENERATED_BODY()
 	
 public:
+	virtual void InitWidget() override;
+
 	void SetHealthPercent(float Percent);
 
+	/** Skips creating the widget on BeginPlay; it is created by CreateDeferredWidget or the first time it is shown. */
+	FORCEINLINE void SetDeferWidgetCreation(bool bDefer) { bDeferWidgetCreation = bDefer; }
+	void CreateDeferredWidget();
+
 private:
 	UPROPERTY()
 	class UHealthBar* HealthBarWidget;
+
+	bool bDeferWidgetCreation = false;
 };
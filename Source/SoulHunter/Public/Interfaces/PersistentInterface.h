@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "PersistentInterface.generated.h"
+
+struct FActorStateRecord;
+
+// This class does not need to be modified.
+UINTERFACE(MinimalAPI)
+class UPersistentInterface : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Implemented by actors whose state survives level streaming through UWorldStateSubsystem.
+ */
+class SOULHUNTER_API IPersistentInterface
+{
+	GENERATED_BODY()
+
+	// Add interface functions to this class. This is the class that will be inherited to implement this interface.
+public:
+	virtual FGuid GetPersistentGuid() const PURE_VIRTUAL(IPersistentInterface::GetPersistentGuid, return FGuid(););
+
+	/** Fills in the delta from the actor's placed state. Returns false when there is nothing worth storing. */
+	virtual bool WritePersistentState(FActorStateRecord& OutRecord) const PURE_VIRTUAL(IPersistentInterface::WritePersistentState, return false;);
+
+	virtual void ApplyPersistentState(const FActorStateRecord& Record) PURE_VIRTUAL(IPersistentInterface::ApplyPersistentState);
+};
@@ -4,9 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Interfaces/PersistentInterface.h"
 #include "Item.generated.h"
 
 class USphereComponent;
+class IPickupInterface;
 
 enum class EItemState : uint8
 {
@@ -18,7 +20,7 @@ enum class EItemState : uint8
  *
 */
 UCLASS()
-class SOULHUNTER_API AItem : public AActor
+class SOULHUNTER_API AItem : public AActor, public IPersistentInterface
 {
 	GENERATED_BODY()
 	
@@ -27,8 +29,54 @@ public:
 
 	virtual void Tick(float DeltaTime) override;
 
+#pragma region Persistence
+
+	virtual FGuid GetPersistentGuid() const override;
+	virtual bool WritePersistentState(FActorStateRecord& OutRecord) const override;
+	virtual void ApplyPersistentState(const FActorStateRecord& Record) override;
+
+	virtual int32 GetPersistentAmount() const { return 0; }
+	virtual void SetPersistentAmount(int32 Amount) {}
+
+	FORCEINLINE void SetPersistentGuid(const FGuid& Guid) { PersistentGuid = Guid; }
+
+#pragma endregion
+
+#pragma region Collection
+
+	/**
+	 * Called by a pickup collector once its owner reaches the pickup, on the server and on the collecting player's own
+	 * client. The client hides the pickup until the server's destroy arrives, and puts it back if that does not happen
+	 * within CollectConfirmTimeout.
+	 */
+	void Collect(AActor* Collector);
+
+	void MoveTowardsCollector(const FVector& CollectorLocation, float Step);
+
+#pragma endregion
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/**
+	 * Auto-collected pickups are indexed by the pickup subsystem and collected by pickup collectors instead of through
+	 * their sphere's overlaps, which they should have turned off in their constructor.
+	 */
+	virtual bool IsAutoCollected() const { return false; }
+
+	virtual void OnCollected(IPickupInterface* PickupInterface) {}
+
+	/** Pickups dropped at runtime (souls, treasure) are tracked so they can be restored when their cell streams back in. */
+	virtual bool ShouldPersistWhenSpawned() const { return false; }
+
+	/** Runtime pickups stop replicating once settled; their hover and drift are simulated locally on every machine. */
+	virtual bool IsSettled() const { return true; }
+
+	/** A runtime drop on the server still waiting to go dormant, which needs its tick to get there. */
+	FORCEINLINE bool IsAwaitingDormancy() const { return bSpawnedAtRuntime && HasAuthority() && NetDormancy == DORM_Initial; }
+
+	void NotifyLooted();
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 	UStaticMeshComponent* ItemMesh;
@@ -75,6 +123,26 @@ private:
 
 	UPROPERTY(EditAnywhere)
 	USoundBase* PickupSound;
+
+	/** Time a runtime spawned pickup stays awake so its initial state reaches every client before it goes dormant. */
+	UPROPERTY(EditAnywhere, Category = Network)
+	float MinAwakeTime = 1.f;
+
+	/** How long a client waits for the server to destroy a pickup it collected before showing it again. */
+	UPROPERTY(EditAnywhere, Category = Network)
+	float CollectConfirmTimeout = 2.f;
+
+	FTimerHandle CollectConfirmTimer;
+
+	void RestoreUnconfirmedCollect();
+
+	mutable FGuid PersistentGuid;
+	bool bSpawnedAtRuntime = false;
+	bool bLooted = false;
+
+protected:
+	bool bCollected = false;
+	bool bMagnetized = false;
 };
 
 template<typename T>
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Items/LootTable.h"
+
+#include "LootSubsystem.generated.h"
+
+/**
+ * Rolls loot tables on the server and spawns what they drop. Every roll draws from a stream seeded by the world seed
+ * (sh.Loot.Seed) and the source's persistent id, so a given breakable or placed enemy drops the same loot on every run
+ * with the same seed. Drops are gathered into clusters for sh.Loot.ClusterWindow seconds: drops of the same pickup
+ * class within sh.Loot.ClusterRadius are merged into one pickup carrying their combined amount.
+ */
+UCLASS()
+class SOULHUNTER_API ULootSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+#pragma region Main
+
+	static ULootSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** A stream only this source draws from, the same on every run with the same world seed. */
+	FRandomStream MakeStream(const AActor* Source);
+
+	void RollTable(const ULootTable* Table, const AActor* Source, const FVector& Location);
+	void AddDrop(TSubclassOf<AItem> ItemClass, int32 Amount, const FVector& Location);
+
+	void LogReport() const;
+
+#pragma endregion
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+#pragma region Clusters
+
+	struct FLootCluster
+	{
+		TSubclassOf<AItem> ItemClass;
+		FVector Location = FVector::ZeroVector;
+		int32 Amount = 0;
+		int32 NumDrops = 0;
+		double FirstDropTime = 0.0;
+	};
+
+	void SpawnCluster(const FLootCluster& Cluster);
+
+	TArray<FLootCluster> PendingClusters;
+
+	/** How often each source has rolled, so a pooled enemy that dies twice does not drop the same thing twice. */
+	TMap<uint32, int32> SourceRollCounts;
+	int32 WorldSeed = 0;
+
+	int32 NumDrops = 0;
+	int32 NumSpawned = 0;
+
+#pragma endregion
+
+};
@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+
+#include "LootTable.generated.h"
+
+class AItem;
+
+USTRUCT(BlueprintType)
+struct FLootEntry
+{
+	GENERATED_BODY()
+
+	/** Left empty, the entry is a weighted chance of dropping nothing. */
+	UPROPERTY(EditAnywhere)
+	TSoftClassPtr<AItem> ItemClass;
+
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0"))
+	float Weight = 1.f;
+
+	/** Gold or souls the pickup carries. Zero keeps the amount set on the pickup class. */
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0"))
+	int32 MinAmount = 0;
+
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0"))
+	int32 MaxAmount = 0;
+
+	/** Dropped on every roll, on top of the weighted picks. */
+	UPROPERTY(EditAnywhere)
+	bool bGuaranteed = false;
+};
+
+struct FLootDrop
+{
+	TSubclassOf<AItem> ItemClass;
+	int32 Amount = 0;
+};
+
+/**
+ * Weighted drops for breakables and enemies. The weighted entries are compiled into an alias table on load and on
+ * edit, so every pick costs one random index and one random compare no matter how many entries there are.
+ */
+UCLASS(BlueprintType)
+class SOULHUNTER_API ULootTable : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/** Adds the guaranteed entries and NumPicks weighted picks to OutDrops. */
+	void Roll(FRandomStream& Stream, TArray<FLootDrop>& OutDrops, const UObject* Requester) const;
+
+	/** Index into Entries of one weighted pick, or INDEX_NONE when there is nothing weighted to pick from. */
+	int32 PickEntry(FRandomStream& Stream) const;
+
+	void GatherPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const;
+
+	/** Rebuilds the alias table from Entries. Loading and editing do this already; tables filled in code must call it. */
+	void CompileAliasTable();
+
+	UPROPERTY(EditAnywhere, Category = "Loot")
+	TArray<FLootEntry> Entries;
+
+	UPROPERTY(EditAnywhere, Category = "Loot", meta = (ClampMin = "0"))
+	int32 NumPicks = 1;
+
+private:
+
+	/** Per slot: the chance of keeping the slot's own entry, otherwise its alias is taken. */
+	TArray<float> Probabilities;
+	TArray<int32> SlotEntries;
+	TArray<int32> Aliases;
+};
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "PickupSubsystem.generated.h"
+
+class AItem;
+
+/**
+ * Auto-collected pickups (souls, treasure), bucketed in a 2D grid. Pickups add themselves on BeginPlay and leave on
+ * EndPlay, with no collision of their own; pickup collectors query the grid around their owner instead, so the cost of
+ * collecting scales with the pickups near a player rather than with every pickup in the level.
+ */
+UCLASS()
+class SOULHUNTER_API UPickupSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+#pragma region Main
+
+	static UPickupSubsystem* Get(const UObject* WorldContextObject);
+
+	void AddPickup(AItem* Item);
+	void RemovePickup(AItem* Item);
+
+	/** Moves the pickup to its new bucket if it crossed a cell since it was added or last updated. */
+	void UpdatePickup(AItem* Item);
+
+	/** Appends the pickups within Radius of Origin, in the XY plane, to OutPickups. */
+	void QueryPickups(const FVector& Origin, float Radius, TArray<AItem*>& OutPickups) const;
+
+	void LogReport() const;
+
+#pragma endregion
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+#pragma region Grid
+
+	static constexpr float CellSize = 500.f;
+
+	struct FPickup
+	{
+		AItem* Item = nullptr;
+		FIntPoint Cell;
+	};
+
+	FORCEINLINE static FIntPoint GetCell(const FVector& Location)
+	{
+		return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+	}
+
+	void RemoveFromCell(int32 PickupIndex, const FIntPoint& Cell);
+
+	TSparseArray<FPickup> Pickups;
+	TMap<TObjectKey<AItem>, int32> PickupIndices;
+	TMap<FIntPoint, TArray<int32>> Cells;
+
+	mutable int64 NumQueries = 0;
+	mutable int64 NumTested = 0;
+	mutable int64 NumFound = 0;
+
+#pragma endregion
+
+};
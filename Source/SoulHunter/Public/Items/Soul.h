@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Items/Item.h"
+#include "WorldCollision.h"
 #include "Soul.generated.h"
 
 class UNiagaraSystem;
@@ -14,26 +15,40 @@ class SOULHUNTER_API ASoul : public AItem
 	GENERATED_BODY()
 
 public:
+	ASoul();
+
 	virtual void Tick(float DeltaTime) override;
 
+	virtual int32 GetPersistentAmount() const override { return Souls; }
+	virtual void SetPersistentAmount(int32 Amount) override { Souls = Amount; }
+
 protected: 
 	virtual void BeginPlay() override;
-	virtual void OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult) override;
+	virtual bool ShouldPersistWhenSpawned() const override { return true; }
+	virtual bool IsSettled() const override { return bFinishedDrifting || bMagnetized; }
+	virtual bool IsAutoCollected() const override { return true; }
+	virtual void OnCollected(IPickupInterface* PickupInterface) override;
 	
 private:
 
 	UPROPERTY(EditAnywhere, Category = "Soul Properties")
 	int32 Souls;
 
+	void OnGroundTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	/** Seconds the soul takes to drift down to hover above the ground, easing out as it arrives. */
+	UPROPERTY(EditAnywhere, Category = "Soul Properties", meta = (ClampMin = "0.01"))
+	float DriftDuration = 2.f;
+
+	FTraceDelegate GroundTraceDelegate;
+
+	FVector StartLocation;
 	FVector DesiredLocation;
 
-	float ElapsedDriftingTime = 0.f;
-	float DriftingTime = 300.f;
+	/** World time the drift started, or negative while the ground trace is still in flight. */
+	double DriftStartTime = -1.0;
 	bool bFinishedDrifting = false;
 
-	UPROPERTY(EditAnywhere, Category = Debug)
-	bool bShowLineTraceDebug = false;
-
 public:
 
 	FORCEINLINE int32 GetSouls() const { return Souls; }
@@ -13,9 +13,17 @@ UCLASS()
 class SOULHUNTER_API ATreasure : public AItem
 {
 	GENERATED_BODY()
+
+public:
+	ATreasure();
+
+	virtual int32 GetPersistentAmount() const override { return Gold; }
+	virtual void SetPersistentAmount(int32 Amount) override { Gold = Amount; }
 	
 protected:
-	virtual void OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult) override;
+	virtual bool ShouldPersistWhenSpawned() const override { return true; }
+	virtual bool IsAutoCollected() const override { return true; }
+	virtual void OnCollected(IPickupInterface* PickupInterface) override;
 
 private:
 
@@ -25,4 +33,5 @@ private:
 public:
 
 	FORCEINLINE int32 GetGold() const { return Gold; }
+	FORCEINLINE void SetGold(int32 GoldAmount) { Gold = GoldAmount; }
 };
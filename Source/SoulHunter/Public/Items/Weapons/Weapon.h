@@ -4,11 +4,13 @@
 
 #include "CoreMinimal.h"
 #include "Items/Item.h"
+#include "Combat/CombatStatTables.h"
 #include "Weapon.generated.h"
 
 class USoundBase;
 class UBoxComponent;
 class USceneComponent;
+class ABaseCharacter;
 
 /**
  * 
@@ -20,11 +22,43 @@ class SOULHUNTER_API AWeapon : public AItem
 
 public:
 	AWeapon();
+	virtual void PostLoad() override;
 	virtual void Equip(USceneComponent* InParent, FName InSocketName, AActor* NewOwner, APawn* NewInstigator);
 	void AttackMeshToSocket(USceneComponent* InParent, const FName& InSocketName);
 	void ResetHitIgnoreActors();
 	void EnablePhysics();
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+#pragma region Hits
+
+	/** Whether this machine detects the weapon's hits: the server for AI, the owning client for players. */
+	bool DetectsHits() const;
+
+	/**
+	 * Sweeps the blade as it is held when the socket it is attached to is at SocketTransform, in world space. Used by hit
+	 * windows to trace along a precomputed trajectory instead of waiting for the collision box to overlap something.
+	 */
+	void TraceHitWindow(const FTransform& SocketTransform);
+
+	/** Characters hit until EndHitBatch play their hit reactions together, with the directions classified in one batch. */
+	void BeginHitBatch();
+	void EndHitBatch();
+
+	/** Server only. Opens the window in which hits reported by the owning client are accepted. */
+	void BeginSwing();
+
+	/**
+	 * Server only. Checks a client-reported hit against the swing window, the actors already hit and reach, measured
+	 * to where the target was at the client's view time rather than where it is now.
+	 */
+	bool ValidateReportedHit(AActor* HitActor, const FVector& ImpactPoint, double ViewTime) const;
+
+	/** Server only. Deals damage and sends the hit reaction, then has every machine spawn the fracture fields. */
+	void ApplyHit(AActor* HitActor, const FVector& ImpactPoint);
+
+#pragma endregion
+
 	
 protected:
 	virtual void BeginPlay() override;
@@ -37,22 +71,26 @@ protected:
 	UFUNCTION(BlueprintImplementableEvent)
 	void CreateFields(const FVector& FieldLocation);
 
+	UFUNCTION(NetMulticast, Unreliable)
+	void Multicast_CreateFields(FVector_NetQuantize FieldLocation, AActor* HitActor);
+
+	UFUNCTION()
+	void OnRep_Equipped();
+
 private: 
 
-	void BoxTrace(FHitResult& BoxHitResult);
+	void BoxTrace(const FVector& Start, const FVector& End, const FQuat& Rotation, FHitResult& BoxHitResult);
+	void HandleTraceHit(const FHitResult& BoxHitResult);
 
+	/** Damage, trace and hit validation tuning, shared with every weapon of the same archetype. Unset uses the C++ defaults. */
 	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
-	FVector BoxTraceExtent = FVector(15.f);
+	UWeaponArchetype* Archetype;
 
-	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
-	bool bShowBoxTraceDebug = false;
+	mutable int32 StatsIndex = INDEX_NONE;
 
 	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
 	USoundBase* EquipSound;
 
-	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
-	float Damage = 20.f;
-
 	UPROPERTY(VisibleAnywhere)
 	UBoxComponent* WeaponCollisionBox;
 
@@ -62,8 +100,42 @@ private:
 	UPROPERTY(VisibleAnywhere)
 	USceneComponent* BoxTraceEnd;
 
-	TArray<AActor*> HitIgnoreActors{};
+	/** Owner, self and whatever this swing already hit. Mirrored into TraceQueryParams, which is kept across swings. */
+	TSet<const AActor*, DefaultKeyFuncs<const AActor*>, TInlineSetAllocator<8>> HitIgnoreActors;
+
+	FCollisionQueryParams TraceQueryParams;
+
+	UPROPERTY(ReplicatedUsing = OnRep_Equipped)
+	bool bEquipped = false;
+
+	double SwingStartTime = -1.0;
+	TArray<TWeakObjectPtr<AActor>> SwingHitActors;
+
+	bool bBatchingHits = false;
+	TArray<ABaseCharacter*, TInlineAllocator<8>> BatchedHitCharacters;
+
+#if WITH_EDITORONLY_DATA
+
+	// Replaced by Archetype. Loaded from old assets and levels and moved into an archetype in PostLoad.
+
+	UPROPERTY()
+	FVector BoxTraceExtent_DEPRECATED = FVector(15.f);
+
+	UPROPERTY()
+	float Damage_DEPRECATED = 20.f;
+
+	FWeaponStats GetDeprecatedStats() const;
+
+#endif
 
 public:
 	FORCEINLINE UBoxComponent* GetWeaponCollisionBox() const { return WeaponCollisionBox; }
+
+	FORCEINLINE const FWeaponStats& GetStats() const
+	{
+		if (StatsIndex == INDEX_NONE)
+			StatsIndex = FCombatStatTables::Get().FindOrCompile(Archetype);
+
+		return FCombatStatTables::Get().GetWeaponRow(StatsIndex);
+	}
 };
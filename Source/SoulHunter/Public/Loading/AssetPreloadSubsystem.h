@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Engine/StreamableManager.h"
+
+#include "AssetPreloadSubsystem.generated.h"
+
+class ABaseCharacter;
+class ULevel;
+
+/**
+ * Async-loads the soft assets a character class needs (montages, weapon and soul classes) as one bundle per class,
+ * ahead of that class being spawned. A bundle stays resident while any level that requested it is loaded, and is
+ * released once the last of them is streamed out or its world is torn down. Anything that still has to be loaded synchronously
+ * during play is counted and can be listed with sh.Preload.Report.
+ */
+UCLASS()
+class SOULHUNTER_API UAssetPreloadSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+#pragma region Main
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static UAssetPreloadSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 * Loads every asset the class reports through GatherPreloadAssets, kept for as long as Requester's level is loaded.
+	 * OnLoaded runs on the game thread once they are resident.
+	 */
+	void PreloadCharacterAssets(TSubclassOf<ABaseCharacter> CharacterClass, const UObject* Requester, FStreamableDelegate OnLoaded = FStreamableDelegate());
+
+	void PreloadBundle(FName BundleName, TArray<FSoftObjectPath>&& Assets, const UObject* Requester, FStreamableDelegate OnLoaded = FStreamableDelegate());
+
+	/** Releases the bundle now, whichever levels still hold it. */
+	void ReleaseBundle(FName BundleName);
+	bool IsBundleLoaded(FName BundleName) const;
+
+	void LogReport() const;
+
+#pragma endregion
+
+#pragma region Resolving
+
+	/** Returns the asset if it is resident, otherwise loads it synchronously and reports the miss. */
+	template<typename T>
+	static T* Resolve(const TSoftObjectPtr<T>& Asset, const UObject* Requester)
+	{
+		if (T* LoadedAsset = Asset.Get())
+			return LoadedAsset;
+
+		if (Asset.IsNull())
+			return nullptr;
+
+		ReportResolveMiss(Asset.ToSoftObjectPath(), Requester);
+		return Asset.LoadSynchronous();
+	}
+
+	template<typename T>
+	static TSubclassOf<T> ResolveClass(const TSoftClassPtr<T>& Class, const UObject* Requester)
+	{
+		if (UClass* LoadedClass = Class.Get())
+			return LoadedClass;
+
+		if (Class.IsNull())
+			return nullptr;
+
+		ReportResolveMiss(Class.ToSoftObjectPath(), Requester);
+		return Class.LoadSynchronous();
+	}
+
+#pragma endregion
+
+private:
+
+#pragma region Bundles
+
+	struct FPreloadBundle
+	{
+		TSharedPtr<FStreamableHandle> Handle;
+		TArray<FStreamableDelegate> Waiters;
+		TArray<TWeakObjectPtr<ULevel>, TInlineAllocator<2>> Levels;
+		int32 NumAssets = 0;
+		double RequestTime = 0.0;
+		double LoadMilliseconds = -1.0;
+	};
+
+	void OnBundleLoaded(FName BundleName);
+
+	static ULevel* GetRequesterLevel(const UObject* Requester);
+
+	/** Drops the levels Predicate matches from every bundle, and releases the bundles no level holds anymore. */
+	void ReleaseLevels(TFunctionRef<bool(const ULevel*)> Predicate);
+
+	void OnLevelRemovedFromWorld(ULevel* Level, UWorld* World);
+	void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+
+	FStreamableManager StreamableManager;
+	TMap<FName, FPreloadBundle> Bundles;
+
+	FDelegateHandle LevelRemovedHandle;
+	FDelegateHandle WorldCleanupHandle;
+
+#pragma endregion
+
+#pragma region Sync Load Tracking
+
+	static void ReportResolveMiss(const FSoftObjectPath& AssetPath, const UObject* Requester);
+	void OnSyncLoadPackage(const FString& PackageName);
+
+	TMap<FString, int32> ResolveMisses;
+	TMap<FString, int32> SyncLoadedPackages;
+	FDelegateHandle SyncLoadHandle;
+
+#pragma endregion
+
+};
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "LagCompensationSubsystem.generated.h"
+
+class ABaseCharacter;
+
+/** Fixed-size ring of past capsule positions for one character. The capsule is upright, so its location is all a rewind needs. */
+struct SOULHUNTER_API FRewindHistory
+{
+	struct FFrame
+	{
+		double Time = 0.0;
+		FVector3f Location = FVector3f::ZeroVector;
+	};
+
+	/** Frames needed to span MaxRewindSeconds when frames are recorded no closer together than SampleInterval. */
+	static int32 GetCapacityFor(double MaxRewindSeconds, double SampleInterval);
+
+	void Init(int32 Capacity);
+	void Record(double Time, const FVector& Location);
+
+	/** Interpolated location at Time, clamped to the oldest and newest frames. Returns false while the history is empty. */
+	bool Sample(double Time, FVector& OutLocation) const;
+
+	FORCEINLINE SIZE_T GetAllocatedSize() const { return Frames.GetAllocatedSize(); }
+	FORCEINLINE int32 GetCapacity() const { return Frames.Num(); }
+
+private:
+
+	FORCEINLINE const FFrame& GetFrame(int32 Age) const { return Frames[(Head - 1 - Age + Frames.Num()) % Frames.Num()]; }
+
+	TArray<FFrame> Frames;
+	int32 Head = 0;
+	int32 NumFrames = 0;
+};
+
+/**
+ * Server-side rewind buffer for melee hit validation. Every character's capsule position is recorded each frame, so a
+ * hit a client reports can be checked against where the target was at the time the client saw it rather than where it
+ * is once the report arrives.
+ */
+UCLASS()
+class SOULHUNTER_API ULagCompensationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+#pragma region Main
+
+	static ULagCompensationSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void Register(ABaseCharacter* Character);
+	void Unregister(ABaseCharacter* Character);
+
+	/** Clamps a client's view time to the rewind window, so a client cannot claim a hit further in the past than that. */
+	double ClampRewindTime(double ViewTime) const;
+
+	/**
+	 * Client side. The server time at which the client rendered Actor where it is now: its estimate of server time, which
+	 * already trails the server by the one-way latency the replicated position took, less the proxy smoothing delay.
+	 */
+	static double GetClientViewTime(const AActor* Actor);
+
+	/** Where the actor was at Time. Characters are rewound, anything else is taken at its current location. */
+	FVector GetRewoundLocation(const AActor* Actor, double Time) const;
+
+	void LogReport() const;
+
+#pragma endregion
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+#pragma region Histories
+
+	struct FCharacterHistory
+	{
+		TWeakObjectPtr<ABaseCharacter> Character;
+		FRewindHistory History;
+	};
+
+	TArray<FCharacterHistory> Histories;
+	double LastSampleTime = -1.0;
+
+	mutable int64 NumQueries = 0;
+	mutable double QuerySeconds = 0.0;
+
+#pragma endregion
+
+};
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+
+/**
+ * Server-side network counters. sh.Net.Stats prints bandwidth, lag and loss for every client connection together with
+ * how many client-reported weapon hits were accepted or rejected and how many client moves had to be corrected;
+ * sh.Net.StatsInterval logs the same periodically, which is the only way to read them from a headless dedicated server.
+ */
+struct SOULHUNTER_API FNetworkStats
+{
+	static void RecordReportedHit(bool bAccepted);
+	/** Called as a correction is sent to a client, however many of its moves since the last one were off. */
+	static void RecordMoveCorrection(bool bStaminaOnly);
+	static void LogConnectionStats(UWorld* World);
+
+private:
+
+	static int32 AcceptedHits;
+	static int32 RejectedHits;
+	static int32 PositionCorrections;
+	static int32 StaminaCorrections;
+};
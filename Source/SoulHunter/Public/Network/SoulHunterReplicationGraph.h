@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+
+#include "SoulHunterReplicationGraph.generated.h"
+
+class UReplicationGraphNode_ActorList;
+class UReplicationGraphNode_GridSpatialization2D;
+
+enum class ESoulHunterRepNodeMapping : uint8
+{
+	/** Not routed to a global node. Owner-only actors (player controllers) are added per connection instead. */
+	NotRouted,
+	/** Replicated to every connection: game state, player states. */
+	RelevantAllConnections,
+	/** Placed in the grid once and never moved. */
+	Spatialize_Static,
+	/** Re-bucketed in the grid every frame: players and enemies. */
+	Spatialize_Dynamic,
+	/** Treated as static while dormant and dynamic while awake: breakables and dropped pickups. */
+	Spatialize_Dormancy,
+
+	Count
+};
+
+/**
+ * Replication graph for SoulHunter. Instead of testing every replicated actor against every connection, actors are
+ * bucketed in a 2D grid and each connection only gathers the cells around its viewers, so server cost grows with how
+ * crowded the players' surroundings are rather than with the total number of enemies and pickups.
+ */
+UCLASS(Transient, Config = Engine)
+class SOULHUNTER_API USoulHunterReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+
+#pragma region Main
+
+	virtual void ResetGameWorldState() override;
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+
+	void LogStats() const;
+	void ResetStats();
+
+#pragma endregion
+
+protected:
+
+#pragma region Settings
+
+	UPROPERTY(Config)
+	float GridCellSize = 10000.f;
+
+	/** Offset applied to actor locations so the whole playable area falls in positive grid coordinates. */
+	UPROPERTY(Config)
+	float SpatialBiasX = -150000.f;
+
+	UPROPERTY(Config)
+	float SpatialBiasY = -200000.f;
+
+	/** Growing the grid when an actor leaves it is expensive; actors outside it are clamped to the edge cells instead. */
+	UPROPERTY(Config)
+	bool bDisableSpatialRebuilding = true;
+
+#pragma endregion
+
+private:
+
+#pragma region Routing
+
+	ESoulHunterRepNodeMapping GetMappingPolicy(UClass* Class) const;
+	ESoulHunterRepNodeMapping GetDefaultMappingPolicy(UClass* Class) const;
+	void InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool bSpatialize) const;
+
+	TClassMap<ESoulHunterRepNodeMapping> ClassRepNodePolicies;
+
+	UPROPERTY()
+	UReplicationGraphNode_GridSpatialization2D* GridNode;
+
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* AlwaysRelevantNode;
+
+#pragma endregion
+
+#pragma region Stats
+
+	static constexpr int32 MaxFrameSamples = 1024;
+
+	TArray<float> FrameCostSamples;
+	int32 NextFrameSampleIndex = 0;
+	int32 NumRoutedActors[static_cast<int32>(ESoulHunterRepNodeMapping::Count)] = {};
+
+#pragma endregion
+
+};
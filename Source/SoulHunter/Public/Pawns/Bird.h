@@ -24,9 +24,6 @@ public:
 	// Sets default values for this pawn's properties
 	ABird();
 
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/Ticker.h"
+#include "Tasks/Task.h"
+
+#include "SaveGameSubsystem.generated.h"
+
+enum class ESaveSection : uint8
+{
+	Player,
+	World,
+
+	Count
+};
+
+/**
+ * Saves every player's attributes and recorded world state into one compressed, versioned file per section
+ * (Saved/SaveGames/<Slot>/<Section>.sav). Only the server or a standalone game saves; clients never write a slot. Only changed world cells are copied on the game thread; packing, compression and
+ * file IO run on a worker task. Autosaves only rewrite sections that changed since they were last written.
+ */
+UCLASS()
+class SOULHUNTER_API USaveGameSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+#pragma region Main
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static USaveGameSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 * Returns false if no section write was queued, always on a client. Sections still being written from a previous save
+	 * are skipped.
+	 */
+	bool SaveGame(const FString& SlotName, bool bOnlyChangedSections = false);
+
+	/** Restores the slot and reopens the saved map so every cell is applied from the loaded state. */
+	bool LoadGame(const FString& SlotName);
+
+	bool IsSaving() const;
+	void WaitForPendingSaves();
+
+	static FString GetSectionPath(const FString& SlotName, ESaveSection Section);
+
+	/** Compresses and writes one section. Safe to call from any thread. */
+	static bool WriteSectionFile(const FString& Path, ESaveSection Section, const TArray<uint8>& RawBytes);
+	static bool ReadSectionFile(const FString& Path, ESaveSection Section, TArray<uint8>& OutRawBytes, uint16* OutVersion = nullptr);
+
+#pragma endregion
+
+private:
+
+#pragma region Sections
+
+	struct FSectionState
+	{
+		FString LastSlot;
+		uint32 LastKey = 0;
+		bool bWritten = false;
+
+		FString PendingSlot;
+		uint32 PendingKey = 0;
+		UE::Tasks::TTask<bool> PendingTask;
+	};
+
+	bool IsDirty(const FSectionState& State, const FString& SlotName, uint32 Key) const;
+	bool IsSectionBusy(ESaveSection Section) const;
+
+	/** Returns false if the section is still being written and the save was skipped. */
+	bool LaunchSectionWrite(ESaveSection Section, const FString& SlotName, uint32 Key, TUniqueFunction<bool(TArray<uint8>&)>&& Serializer);
+	void CollectFinishedSaves();
+
+	FSectionState Sections[static_cast<int32>(ESaveSection::Count)];
+
+#pragma endregion
+
+#pragma region Autosave
+
+	bool TickAutosave(float DeltaTime);
+
+	FTSTicker::FDelegateHandle AutosaveHandle;
+	float TimeSinceAutosave = 0.f;
+
+#pragma endregion
+
+};
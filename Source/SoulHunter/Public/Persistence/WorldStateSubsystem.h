@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Engine/World.h"
+#include "Persistence/WorldStateTypes.h"
+#include "Components/AttributeComponent.h"
+
+#include "WorldStateSubsystem.generated.h"
+
+class AController;
+class AItem;
+class IPersistentInterface;
+class ULevel;
+
+/**
+ * Keeps per-actor deltas (broken, dead, looted, moved) keyed by stable GUIDs so streamed cells and revisited maps
+ * come back the way the player left them. Cells that are not loaded are held in their packed binary form.
+ */
+UCLASS()
+class SOULHUNTER_API UWorldStateSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+#pragma region Main
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static UWorldStateSubsystem* Get(const UObject* WorldContextObject);
+	static FGuid MakeActorGuid(const AActor* Actor);
+
+#pragma endregion
+
+#pragma region Recording
+
+	void RecordActorState(AActor* Actor);
+
+	void TrackDynamicPickup(AItem* Pickup);
+	void UntrackDynamicPickup(AItem* Pickup);
+
+	/** For persistent actors whose state changes without an event to record it from (a placed enemy walking off). */
+	void TrackVolatileActor(AActor* Actor);
+	void UntrackVolatileActor(AActor* Actor);
+
+	/** Records the volatile actors that changed since the last refresh. Call before reading the revision for a save. */
+	void RefreshVolatileActors();
+
+	/** Identifies a player across sessions: the unique net id where there is one, otherwise the player name. */
+	static FString GetPlayerKey(const AController* Controller);
+
+	void CapturePlayerState(const FString& PlayerKey, const UAttributeComponent* Attributes);
+
+	/** Applies the player's snapshot. A player with none claims the snapshot of a save written without player keys. */
+	bool RestorePlayerState(const FString& PlayerKey, UAttributeComponent* Attributes);
+
+	FORCEINLINE const TMap<FString, FAttributeSnapshot>& GetPlayerSnapshots() const { return PlayerSnapshots; }
+	void SetPlayerSnapshots(TMap<FString, FAttributeSnapshot>&& Snapshots);
+
+	/**
+	 * Captures every recorded world, including the pickups of the cells that are loaded right now, without touching the
+	 * running level. Only cells changed since the last capture are copied; the rest share their packed bytes.
+	 */
+	FWorldStateCapture CaptureForSave();
+
+	/** Replaces everything recorded so far. The running world is not captured on its way out, so the caller should reload the map. */
+	void LoadSnapshot(FWorldStateSnapshot&& Snapshot);
+
+	/** Bumped whenever recorded world state changes, so savers can skip writing it when nothing happened. */
+	FORCEINLINE uint32 GetRevision() const { return Revision; }
+
+#pragma endregion
+
+private:
+
+#pragma region Streaming
+
+	struct FWorldStateData
+	{
+		TMap<FName, FCellState> LiveCells;
+		TMap<FName, FPackedCellBytes> PackedCells;
+
+		/** Bytes of live cells as of the last capture. Dropped whenever the live cell changes. */
+		TMap<FName, FPackedCellBytes> CapturedLiveCells;
+	};
+
+	void OnWorldActorsInitialized(const UWorld::FActorsInitializedParams& Params);
+	void OnLevelAdded(ULevel* Level, UWorld* World);
+	void OnLevelRemoved(ULevel* Level, UWorld* World);
+	void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+
+	bool IsOurWorld(const UWorld* World) const;
+	FWorldStateData& GetWorldData(const UWorld* World);
+	FCellState& GetLiveCell(const UWorld* World, FName CellName);
+	void UpdateRecord(AActor* Actor, IPersistentInterface* Persistent, bool bOnlyIfChanged);
+
+	void ApplyCell(ULevel* Level, UWorld* World);
+	void CaptureCell(ULevel* Level, UWorld* World, bool bCaptureAllPickups);
+	void PackCell(FWorldStateData& WorldData, FName CellName);
+	void WritePickups(const FBox* CellBounds, FCellState& Cell, TArray<AItem*>& InOutCaptured);
+	void GatherLoadedPickups(UWorld* World, TMap<FName, TArray<FDynamicPickupRecord>>& OutPickups);
+
+	static void WriteActorStates(ULevel* Level, FCellState& Cell);
+	static void PackCellState(FCellState& Cell, TArray<uint8>& OutBytes);
+	void RespawnPickups(UWorld* World, const TArray<FDynamicPickupRecord>& Pickups);
+
+	static FName GetWorldName(const UWorld* World);
+	static FName GetCellName(const ULevel* Level);
+
+	TMap<FName, FWorldStateData> Worlds;
+	TMap<TWeakObjectPtr<ULevel>, FBox> LoadedCellBounds;
+	TArray<TWeakObjectPtr<AItem>> DynamicPickups;
+	TArray<TWeakObjectPtr<AActor>> VolatileActors;
+
+	TMap<FString, FAttributeSnapshot> PlayerSnapshots;
+
+	uint32 Revision = 0;
+	bool bSuppressCapture = false;
+
+	FDelegateHandle WorldActorsInitializedHandle;
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+	FDelegateHandle WorldCleanupHandle;
+
+#pragma endregion
+
+};
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/SoftObjectPath.h"
+
+enum class EActorStateFlags : uint8
+{
+	None = 0,
+	Broken = 1 << 0,
+	Dead = 1 << 1,
+	Looted = 1 << 2,
+	Moved = 1 << 3
+};
+ENUM_CLASS_FLAGS(EActorStateFlags);
+
+/** Per-actor delta from its placed state. The transform is only serialized for moved actors. */
+struct FActorStateRecord
+{
+	FGuid Guid;
+	EActorStateFlags Flags = EActorStateFlags::None;
+	FVector3f Location = FVector3f::ZeroVector;
+	float Yaw = 0.f;
+
+	FORCEINLINE bool HasAnyFlags(EActorStateFlags InFlags) const { return EnumHasAnyFlags(Flags, InFlags); }
+
+	FORCEINLINE bool operator==(const FActorStateRecord& Other) const
+	{
+		return Guid == Other.Guid && Flags == Other.Flags
+			&& (!HasAnyFlags(EActorStateFlags::Moved) || (Location == Other.Location && Yaw == Other.Yaw));
+	}
+
+	friend FArchive& operator<<(FArchive& Ar, FActorStateRecord& Record)
+	{
+		Ar << Record.Guid;
+		Ar << reinterpret_cast<uint8&>(Record.Flags);
+
+		if (Record.HasAnyFlags(EActorStateFlags::Moved))
+		{
+			Ar << Record.Location;
+			Ar << Record.Yaw;
+		}
+
+		return Ar;
+	}
+};
+
+/** A pickup that was spawned at runtime (dropped souls, treasure from breakables) and has no placed actor to restore into. */
+struct FDynamicPickupRecord
+{
+	FGuid Guid;
+	FSoftClassPath PickupClass;
+	FVector3f Location = FVector3f::ZeroVector;
+	int32 Amount = 0;
+};
+
+/** Everything recorded for one streaming cell (a world partition cell or the persistent level). */
+struct FCellState
+{
+	TMap<FGuid, FActorStateRecord> Actors;
+	TArray<FDynamicPickupRecord> Pickups;
+
+	FORCEINLINE bool IsEmpty() const { return Actors.Num() == 0 && Pickups.Num() == 0; }
+
+	void Serialize(FArchive& Ar);
+};
+
+/** Packed cells of every recorded world, as read back from a save. */
+struct FWorldStateSnapshot
+{
+	TMap<FName, TMap<FName, TArray<uint8>>> Worlds;
+
+	void Serialize(FArchive& Ar);
+};
+
+/** Packed bytes of one cell, shared between the subsystem and saves in flight. Never modified once another holder can see them. */
+using FPackedCellBytes = TSharedRef<TArray<uint8>, ESPMode::ThreadSafe>;
+
+/**
+ * What a save needs from world state, taken on the game thread without packing anything: unchanged cells share their
+ * packed bytes, changed cells are copied and only packed by Serialize on the save worker. Writes the FWorldStateSnapshot layout.
+ */
+struct FWorldStateCapture
+{
+	struct FChangedCell
+	{
+		FCellState State;
+		FPackedCellBytes Bytes = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>();
+	};
+
+	struct FWorldCells
+	{
+		TMap<FName, FPackedCellBytes> Packed;
+		TMap<FName, FChangedCell> Changed;
+	};
+
+	TMap<FName, FWorldCells> Worlds;
+
+	void Serialize(FArchive& Ar);
+};
@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USkeletalMeshComponent;
+
+/**
+ * Gameplay costs that can be traded for fidelity. Ragdoll and hit effect caps are cosmetic and follow EffectsQuality:
+ * they are sh.Scalability.* cvars whose low, medium, high and epic values live in Config/DefaultScalability.ini next to
+ * the engine's, and are counted per world in UGameplayScalabilitySubsystem. AI rates and corpse lifetime change what
+ * happens in the game, so they are plain sh.AI.* cvars set on the server and never follow a quality level. Enemy tick
+ * and sensing intervals scale what each enemy is configured with and are applied as it spawns; everything else takes
+ * effect immediately.
+ */
+struct SOULHUNTER_API FGameplayScalability
+{
+	static float GetAITickInterval(float BaseInterval);
+	static float GetAISensingInterval(float BaseInterval);
+	static int32 GetAISightTracesPerFrame();
+
+	static float GetCorpseLifeSpan(float BaseLifeSpan);
+	static float GetRagdollImpulse();
+
+	/** Whether another hit effect may spawn this frame. Claims one of the world's sh.Scalability.MaxHitEffectsPerFrame. */
+	static bool ClaimHitEffect(const UObject* WorldContextObject);
+
+	/** Tracks a mesh that just went ragdoll. Past sh.Scalability.MaxRagdolls, the world's oldest ragdolls are put to sleep. */
+	static void RegisterRagdoll(USkeletalMeshComponent* Mesh);
+};
@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "GameplayScalabilitySubsystem.generated.h"
+
+class USkeletalMeshComponent;
+
+/**
+ * The per world half of FGameplayScalability: the ragdolls left simulating and the hit effects spawned this frame. Kept
+ * per world so a listen server and its PIE clients, or two game worlds, each get the full budget rather than sharing one.
+ */
+UCLASS()
+class SOULHUNTER_API UGameplayScalabilitySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+#pragma region Main
+
+	static UGameplayScalabilitySubsystem* Get(const UObject* WorldContextObject);
+
+	bool ClaimHitEffect(int32 MaxHitEffectsPerFrame);
+
+	void RegisterRagdoll(USkeletalMeshComponent* Mesh, int32 MaxRagdolls);
+
+#pragma endregion
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	TArray<TWeakObjectPtr<USkeletalMeshComponent>> Ragdolls;
+
+	uint64 HitEffectFrame = 0;
+	int32 NumHitEffectsThisFrame = 0;
+
+};
@@ -3,4 +3,6 @@
 #include "SoulHunter.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_LOG_CATEGORY(LogSoulHunter);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, SoulHunter, "SoulHunter" );
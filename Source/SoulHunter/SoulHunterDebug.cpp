@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SoulHunterDebug.h"
+
+#if SH_DEBUG
+
+#include "HAL/IConsoleManager.h"
+
+namespace SoulHunterDebug
+{
+	bool bWeaponTraces = false;
+	bool bSoulTraces = false;
+	bool bDeaths = false;
+	bool bInteraction = false;
+	float DrawDuration = 5.f;
+
+	static FAutoConsoleVariableRef CVarWeaponTraces(
+		TEXT("sh.Debug.WeaponTraces"),
+		bWeaponTraces,
+		TEXT("Draws every weapon box trace and where it hit."));
+
+	static FAutoConsoleVariableRef CVarSoulTraces(
+		TEXT("sh.Debug.SoulTraces"),
+		bSoulTraces,
+		TEXT("Draws the ground trace of every soul that spawns."));
+
+	static FAutoConsoleVariableRef CVarDeaths(
+		TEXT("sh.Debug.Deaths"),
+		bDeaths,
+		TEXT("Logs every enemy death."));
+
+	static FAutoConsoleVariableRef CVarInteraction(
+		TEXT("sh.Debug.Interaction"),
+		bInteraction,
+		TEXT("Logs every interact key press and what it did."));
+
+	static FAutoConsoleVariableRef CVarDrawDuration(
+		TEXT("sh.Debug.DrawDuration"),
+		DrawDuration,
+		TEXT("Seconds debug shapes stay on screen."));
+}
+
+#endif
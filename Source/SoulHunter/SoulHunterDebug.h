@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SoulHunter.h"
+#include "DrawDebugHelpers.h"
+
+/**
+ * Gameplay debug output, toggled per category with sh.Debug.<Category> and compiled out entirely in Test and Shipping.
+ * A disabled category costs one read of a bool; its arguments are never evaluated.
+ *
+ *	SH_DEBUG_DRAW(WeaponTraces, DrawDebugBox(GetWorld(), Location, Extent, FColor::Red, false, SoulHunterDebug::DrawDuration));
+ *	SH_DEBUG_LOG(Deaths, TEXT("%s died"), *GetName());
+ */
+#define SH_DEBUG (!(UE_BUILD_SHIPPING || UE_BUILD_TEST))
+
+#if SH_DEBUG
+
+namespace SoulHunterDebug
+{
+	extern SOULHUNTER_API bool bWeaponTraces;
+	extern SOULHUNTER_API bool bSoulTraces;
+	extern SOULHUNTER_API bool bDeaths;
+	extern SOULHUNTER_API bool bInteraction;
+
+	/** Seconds debug shapes stay on screen. */
+	extern SOULHUNTER_API float DrawDuration;
+}
+
+#define SH_DEBUG_ENABLED(Category) (SoulHunterDebug::b##Category)
+#define SH_DEBUG_DRAW(Category, ...) do { if (SH_DEBUG_ENABLED(Category)) { __VA_ARGS__; } } while (0)
+#define SH_DEBUG_LOG(Category, Format, ...) do { if (SH_DEBUG_ENABLED(Category)) UE_LOG(LogSoulHunter, Display, Format, ##__VA_ARGS__); } while (0)
+
+#else
+
+#define SH_DEBUG_ENABLED(Category) false
+#define SH_DEBUG_DRAW(Category, ...) do { } while (0)
+#define SH_DEBUG_LOG(Category, Format, ...) do { } while (0)
+
+#endif